@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/command-line.h"
+#include "ns3/double.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/scheduler.h"
+#include "ns3/system-wall-clock-ms.h"
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup scheduler
+ * Benchmark of the event list schedulers.
+ *
+ * Each scheduler is first filled with \c pop pending events, then runs
+ * the classic "hold" model: \c hold times the earliest event is removed
+ * and a new one is inserted at a random offset after it, which keeps
+ * the number of pending events constant. Finally the scheduler is
+ * drained. The population is multiplied by 10 from \c minPop up to
+ * \c maxPop.
+ *
+ * The schedulers are driven directly, without a simulator, so the
+ * numbers only reflect the event list operations.
+ *
+ * \verbatim
+./waf --run "bench-scheduler --minPop=100000 --maxPop=100000000 --listMax=100000"
+   \endverbatim
+ *
+ * The ListScheduler inserts in linear time, so it is skipped above
+ * \c listMax pending events.
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Number of precomputed time stamp increments. */
+const uint32_t DELTA_COUNT = 1 << 16;
+
+/**
+ * Benchmark one scheduler at one population.
+ *
+ * \param [in] factory The scheduler factory.
+ * \param [in] pop The number of pending events.
+ * \param [in] holds The number of hold operations.
+ * \param [in] deltas The time stamp increments to cycle through.
+ */
+void
+Bench (ObjectFactory factory, uint64_t pop, uint64_t holds,
+       const std::vector<uint64_t> &deltas)
+{
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  // The schedulers never dereference the event implementation.
+  EventImpl *impl = reinterpret_cast<EventImpl *> (0x1);
+  uint32_t uid = 4;
+  uint32_t d = 0;
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint64_t i = 0; i < pop; i++)
+    {
+      Scheduler::Event ev;
+      ev.impl = impl;
+      ev.key.m_ts = deltas[d++ % DELTA_COUNT];
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+    }
+  int64_t fillMs = clock.End ();
+
+  clock.Start ();
+  for (uint64_t i = 0; i < holds; i++)
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      ev.key.m_ts += deltas[d++ % DELTA_COUNT];
+      ev.key.m_uid = uid++;
+      scheduler->Insert (ev);
+    }
+  int64_t holdMs = clock.End ();
+
+  clock.Start ();
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+    }
+  int64_t drainMs = clock.End ();
+
+  std::cout << std::left << std::setw (24) << factory.GetTypeId ().GetName ()
+            << std::right << std::setw (12) << pop
+            << std::fixed << std::setprecision (1)
+            << std::setw (14) << fillMs * 1e6 / pop
+            << std::setw (14) << (holds ? holdMs * 1e6 / holds : 0)
+            << std::setw (14) << drainMs * 1e6 / pop
+            << std::endl;
+}
+
+}  // unnamed namespace
+
+
+int main (int argc, char *argv[])
+{
+  uint64_t minPop = 100000;
+  uint64_t maxPop = 1000000;
+  uint64_t holds = 100000;
+  uint64_t listMax = 100000;
+  double mean = 100;
+  std::string schedulerType = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("minPop", "Smallest number of pending events", minPop);
+  cmd.AddValue ("maxPop", "Largest number of pending events", maxPop);
+  cmd.AddValue ("holds", "Number of hold operations per run", holds);
+  cmd.AddValue ("listMax", "Largest population run with the ListScheduler", listMax);
+  cmd.AddValue ("mean", "Mean time stamp increment, in time steps", mean);
+  cmd.AddValue ("scheduler", "Only run this scheduler TypeId", schedulerType);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> types;
+  if (schedulerType != "")
+    {
+      types.push_back (schedulerType);
+    }
+  else
+    {
+      types.push_back ("ns3::ListScheduler");
+      types.push_back ("ns3::MapScheduler");
+      types.push_back ("ns3::HeapScheduler");
+      types.push_back ("ns3::CalendarScheduler");
+      types.push_back ("ns3::DaryHeapScheduler");
+      types.push_back ("ns3::LadderScheduler");
+    }
+
+  // Draw the increments once, so that the random number generator
+  // does not show up in the measurements.
+  Ptr<ExponentialRandomVariable> rng = CreateObject<ExponentialRandomVariable> ();
+  rng->SetAttribute ("Mean", DoubleValue (mean));
+  std::vector<uint64_t> deltas (DELTA_COUNT);
+  for (uint32_t i = 0; i < DELTA_COUNT; i++)
+    {
+      deltas[i] = rng->GetInteger ();
+    }
+
+  std::cout << std::left << std::setw (24) << "scheduler"
+            << std::right << std::setw (12) << "pending"
+            << std::setw (14) << "insert ns/op"
+            << std::setw (14) << "hold ns/op"
+            << std::setw (14) << "remove ns/op"
+            << std::endl;
+
+  for (uint64_t pop = minPop; pop <= maxPop; pop *= 10)
+    {
+      for (std::vector<std::string>::const_iterator i = types.begin (); i != types.end (); ++i)
+        {
+          if (*i == "ns3::ListScheduler" && pop > listMax)
+            {
+              continue;
+            }
+          ObjectFactory factory;
+          factory.SetTypeId (*i);
+          Bench (factory, pop, holds, deltas);
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-runner.h"
+#include "ns3/command-line.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/system-path.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-helpers
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1),
+    m_jobs (0),
+    m_isReplication (false),
+    m_run (RngSeedManager::GetRun ()),
+    m_exitStatus (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::AddCommandLineValues (CommandLine &cmd)
+{
+  NS_LOG_FUNCTION (this);
+  cmd.AddValue ("Replications", "Number of replications, with consecutive RngRun", m_replications);
+  cmd.AddValue ("ReplicationJobs", "Maximum number of replications running at the same time, "
+                "0 for the number of processors", m_jobs);
+  cmd.AddValue ("ReplicationOutput", "Prefix of the files keeping the output of each replication",
+                m_outputPrefix);
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t replications)
+{
+  NS_LOG_FUNCTION (this << replications);
+  m_replications = replications;
+}
+
+void
+ReplicationRunner::SetJobs (uint32_t jobs)
+{
+  NS_LOG_FUNCTION (this << jobs);
+  m_jobs = jobs;
+}
+
+void
+ReplicationRunner::SetOutputPrefix (const std::string &prefix)
+{
+  NS_LOG_FUNCTION (this << prefix);
+  m_outputPrefix = prefix;
+}
+
+bool
+ReplicationRunner::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t firstRun = RngSeedManager::GetRun ();
+  m_run = firstRun;
+  if (m_replications <= 1)
+    {
+      return true;
+    }
+  uint32_t jobs = m_jobs;
+  if (jobs == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      jobs = processors > 0 ? processors : 1;
+    }
+  jobs = std::min (jobs, m_replications);
+  if (m_outputPrefix.empty ())
+    {
+      m_outputDirectory = SystemPath::MakeTemporaryDirectoryName ();
+      SystemPath::MakeDirectories (m_outputDirectory);
+    }
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  std::map<pid_t, uint64_t> running;
+  uint32_t started = 0;
+  m_exitStatus = 0;
+  while (started < m_replications || !running.empty ())
+    {
+      while (started < m_replications && running.size () < jobs)
+        {
+          uint64_t run = firstRun + started;
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "ReplicationRunner::Fork(): fork() failed: " << std::strerror (errno));
+          if (pid == 0)
+            {
+              StartReplication (run);
+              return true;
+            }
+          NS_LOG_LOGIC ("Started replication " << run << " in process " << pid);
+          running[pid] = run;
+          started++;
+        }
+      int wstatus;
+      pid_t pid = waitpid (-1, &wstatus, 0);
+      if (pid < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "ReplicationRunner::Fork(): waitpid() failed: " << std::strerror (errno));
+          continue;
+        }
+      std::map<pid_t, uint64_t>::iterator i = running.find (pid);
+      if (i == running.end ())
+        {
+          continue;
+        }
+      int status = 0;
+      if (WIFEXITED (wstatus))
+        {
+          status = WEXITSTATUS (wstatus);
+        }
+      else if (WIFSIGNALED (wstatus))
+        {
+          status = 128 + WTERMSIG (wstatus);
+        }
+      if (status != 0)
+        {
+          std::cerr << "Replication with RngRun=" << i->second
+                    << " failed with status " << status << std::endl;
+          if (m_exitStatus == 0)
+            {
+              m_exitStatus = status;
+            }
+        }
+      NS_LOG_LOGIC ("Replication " << i->second << " finished with status " << status);
+      running.erase (i);
+    }
+
+  if (m_outputPrefix.empty ())
+    {
+      CollectOutputs (firstRun);
+    }
+  return false;
+}
+
+void
+ReplicationRunner::StartReplication (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+  m_isReplication = true;
+  m_run = run;
+  RngSeedManager::SetRun (run);
+  RandomVariableStream::ResetAll ();
+  std::string output = GetOutputFileName (run);
+  int fd = open (output.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  NS_ABORT_MSG_IF (fd < 0, "ReplicationRunner: could not open " << output);
+  dup2 (fd, 1);
+  close (fd);
+}
+
+void
+ReplicationRunner::CollectOutputs (uint64_t firstRun)
+{
+  NS_LOG_FUNCTION (this << firstRun);
+  for (uint32_t i = 0; i < m_replications; i++)
+    {
+      uint64_t run = firstRun + i;
+      std::string output = GetOutputFileName (run);
+      std::ifstream file (output.c_str ());
+      std::cout << "# RngRun " << run << std::endl;
+      if (file.is_open () && file.peek () != std::ifstream::traits_type::eof ())
+        {
+          std::cout << file.rdbuf ();
+        }
+      file.close ();
+      std::remove (output.c_str ());
+    }
+  std::cout.flush ();
+  rmdir (m_outputDirectory.c_str ());
+}
+
+bool
+ReplicationRunner::IsReplication (void) const
+{
+  return m_isReplication;
+}
+
+uint64_t
+ReplicationRunner::GetRun (void) const
+{
+  return m_run;
+}
+
+std::string
+ReplicationRunner::GetOutputFileName (uint64_t run) const
+{
+  std::ostringstream oss;
+  if (m_outputPrefix.empty ())
+    {
+      oss << SystemPath::Append (m_outputDirectory, "run-") << run << ".txt";
+    }
+  else
+    {
+      oss << m_outputPrefix << "-" << run << ".txt";
+    }
+  return oss.str ();
+}
+
+int
+ReplicationRunner::GetExitStatus (void) const
+{
+  return m_exitStatus;
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * \file
+ * \ingroup core-helpers
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner declaration.
+ */
+
+namespace ns3 {
+
+class CommandLine;
+
+/**
+ * \ingroup core-helpers
+ * \ingroup randomvariable
+ *
+ * \brief Run independent replications of a simulation in parallel
+ * processes, after building it once.
+ *
+ * Independent replications of a scenario differ only by their
+ * \ref GlobalValueRngRun "RngRun". Rather than running the whole
+ * program once per run number, a program can build its topology and
+ * populate its routing tables once, then call Fork(): it forks one
+ * process per replication, running at most a given number at a time.
+ * Each of them sets its run number, restarts all the existing
+ * random variable streams with it (RandomVariableStream::ResetAll())
+ * and runs the simulation. The original process waits for all of
+ * them and collects their standard output.
+ *
+ * \code
+ *   int main (int argc, char *argv[])
+ *   {
+ *     ReplicationRunner runner;
+ *     CommandLine cmd;
+ *     runner.AddCommandLineValues (cmd);
+ *     cmd.Parse (argc, argv);
+ *
+ *     // Build the topology.
+ *     ...
+ *     Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+ *
+ *     if (!runner.Fork ())
+ *       {
+ *         return runner.GetExitStatus ();
+ *       }
+ *     Simulator::Run ();
+ *     // Print the statistics of replication runner.GetRun ().
+ *     ...
+ *   }
+ * \endcode
+ *
+ * which runs for instance with
+ * \code
+ *   ./waf --run "program --RngRun=1 --Replications=100 --ReplicationJobs=8"
+ * \endcode
+ * replications 1 to 100, eight at a time.
+ *
+ * The standard output of each replication goes to a file. Without the
+ * ReplicationOutput prefix, these are temporary files which the
+ * original process copies to its standard output in the order of the
+ * run numbers, each after a "# RngRun" line, and removes. The
+ * replications share the standard error.
+ *
+ * The random numbers drawn while building the topology come from the
+ * initial run number, and are therefore common to all the
+ * replications. Fork() must be called while the simulator runs no
+ * other threads.
+ *
+ * The files opened before Fork(), such as trace or pcap files, are
+ * shared by the replications: their processes write through the same
+ * file descriptor, at the same offset, and the data buffered before
+ * Fork() is written by each of them. The output files of a replication
+ * must therefore be opened after Fork(), with names which depend on
+ * GetRun().
+ */
+class ReplicationRunner
+{
+public:
+  /** Constructor: a single replication. */
+  ReplicationRunner ();
+
+  /**
+   * Add the options of the runner to a CommandLine:
+   *  - \c Replications, the number of replications;
+   *  - \c ReplicationJobs, the maximum number of replications running
+   *    at the same time, 0 for the number of processors;
+   *  - \c ReplicationOutput, the prefix of the output files.
+   *
+   * \param [in,out] cmd The CommandLine.
+   */
+  void AddCommandLineValues (CommandLine &cmd);
+  /**
+   * Set the number of replications.
+   * \param [in] replications The number of replications.
+   */
+  void SetReplications (uint32_t replications);
+  /**
+   * Set the maximum number of replications running at the same time.
+   * \param [in] jobs The number of processes, 0 for the number of
+   *             processors.
+   */
+  void SetJobs (uint32_t jobs);
+  /**
+   * Keep the standard output of each replication in a file.
+   * \param [in] prefix The prefix of the file names, or an empty string
+   *             to copy them to the standard output.
+   */
+  void SetOutputPrefix (const std::string &prefix);
+
+  /**
+   * Run the replications.
+   *
+   * With a single replication, this just returns \c true. Otherwise it
+   * returns \c true in each replication, and \c false in the original
+   * process once they are all finished.
+   *
+   * \returns \c true if the caller should run the simulation.
+   */
+  bool Fork (void);
+  /**
+   * Check if this process is a replication started by Fork().
+   * \returns \c true in the replications.
+   */
+  bool IsReplication (void) const;
+  /**
+   * Get the run number of this replication.
+   * \returns The run number.
+   */
+  uint64_t GetRun (void) const;
+  /**
+   * Get the name of the file which receives the standard output of a
+   * replication.
+   * \param [in] run The run number of the replication.
+   * \returns The file name.
+   */
+  std::string GetOutputFileName (uint64_t run) const;
+  /**
+   * Get the result of the replications, in the original process.
+   * \returns 0 if all the replications succeeded, otherwise the exit
+   *          status of the first one which failed.
+   */
+  int GetExitStatus (void) const;
+
+private:
+  /**
+   * Become a replication, in a new process.
+   * \param [in] run The run number.
+   */
+  void StartReplication (uint64_t run);
+  /**
+   * Copy the outputs of the replications to the standard output and
+   * remove them.
+   * \param [in] firstRun The first run number.
+   */
+  void CollectOutputs (uint64_t firstRun);
+
+  uint32_t m_replications;    //!< The number of replications.
+  uint32_t m_jobs;            //!< The maximum number of processes.
+  std::string m_outputPrefix; //!< The prefix of the output files.
+  std::string m_outputDirectory; //!< The temporary output directory.
+  bool m_isReplication;       //!< Set in the replications.
+  uint64_t m_run;             //!< The run number.
+  int m_exitStatus;           //!< The result of the replications.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
@@ -62,7 +62,7 @@ CallbackValue::SerializeToString (Ptr<const AttributeChecker> checker) const
 {
   NS_LOG_FUNCTION (this << checker);
   std::ostringstream oss;
-  oss << PeekPointer (m_value.GetImpl ());
+  oss << m_value.PeekImpl ();
   return oss.str ();
 }
 bool
@@ -74,6 +74,21 @@ CallbackValue::DeserializeFromString (std::string value, Ptr<const AttributeChec
 
 ATTRIBUTE_CHECKER_IMPLEMENT (Callback);
 
+CallbackImplBase *
+CallbackImplBase::Copy (void *storage) const
+{
+  NS_LOG_FUNCTION (this << storage);
+  NS_FATAL_ERROR ("Callback implementation " << GetTypeid () << " cannot be copied");
+  return 0;
+}
+
+void
+CallbackImplBase::DestroyInline (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_FATAL_ERROR ("Callback implementation " << GetTypeid () << " cannot be stored inline");
+}
+
 } // namespace ns3
 
 #if (__GNUC__ >= 3)
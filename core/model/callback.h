@@ -28,7 +28,10 @@
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
+#include "unused.h"
 #include <typeinfo>
+#include <new>
+#include <type_traits>
 
 /**
  * \file
@@ -139,6 +142,27 @@ struct CallbackTraits<T *>
 class CallbackImplBase : public SimpleRefCount<CallbackImplBase>
 {
 public:
+  /** The size of the inline storage of a CallbackBase. */
+  enum { INLINE_SIZE = 5 * sizeof (void *) };
+  /** The inline storage, aligned for pointers and member function pointers. */
+  union Storage
+  {
+    void *m_pointer;                    //!< alignment of pointers
+    double m_double;                    //!< alignment of doubles
+    long long m_longLong;               //!< alignment of 64 bit integers
+    char m_bytes[INLINE_SIZE];          //!< the storage
+  };
+  /**
+   * Whether an implementation can be stored inline.
+   *
+   * \tparam T The type of the implementation.
+   */
+  template <typename T>
+  struct FitsInline
+    : public std::integral_constant<bool, sizeof (T) <= INLINE_SIZE
+                                    && alignof (T) <= alignof (Storage)>
+  {};
+
   /** Virtual destructor */
   virtual ~CallbackImplBase () {}
   /**
@@ -153,8 +177,105 @@ public:
    * \return The object type as a string.
    */
   virtual std::string GetTypeid (void) const = 0;
+  /**
+   * Copy this implementation.
+   *
+   * Only the implementations which a Callback can store inline need
+   * to support this: the default implementation is a fatal error.
+   *
+   * \param [in] storage The inline storage of a CallbackBase which
+   *            receives the copy, or zero to allocate the copy.
+   * \return The copy, with a reference count of one.
+   */
+  virtual CallbackImplBase *Copy (void *storage) const;
+  /**
+   * Destroy this implementation, stored inline in a CallbackBase.
+   *
+   * Like Copy(), this needs to be supported only by the
+   * implementations which a Callback can store inline.
+   */
+  virtual void DestroyInline (void);
 
 protected:
+  /**
+   * Helper to implement Copy() in the concrete implementations.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   * \param [in] storage The inline storage which receives the copy,
+   *            or zero to allocate the copy.
+   * \return The copy.
+   */
+  template <typename T>
+  static CallbackImplBase *DoCopy (T const &impl, void *storage)
+  {
+    return DoCopy (impl, storage, FitsInline<T> ());
+  }
+  /**
+   * Copy an implementation which can be stored inline.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   * \param [in] storage The inline storage which receives the copy,
+   *            or zero to allocate the copy.
+   * \return The copy.
+   */
+  template <typename T>
+  static CallbackImplBase *DoCopy (T const &impl, void *storage, std::true_type)
+  {
+    if (storage == 0)
+      {
+        return new T (impl);
+      }
+    return new (storage) T (impl);
+  }
+  /**
+   * Copy an implementation which is never stored inline.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   * \param [in] storage Zero.
+   * \return The copy.
+   */
+  template <typename T>
+  static CallbackImplBase *DoCopy (T const &impl, void *storage, std::false_type)
+  {
+    NS_UNUSED (storage);
+    return new T (impl);
+  }
+  /**
+   * Helper to implement DestroyInline() in the concrete implementations.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation to destroy.
+   */
+  template <typename T>
+  static void DoDestroyInline (T *impl)
+  {
+    DoDestroyInline (impl, FitsInline<T> ());
+  }
+  /**
+   * Destroy an implementation stored inline.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation to destroy.
+   */
+  template <typename T>
+  static void DoDestroyInline (T *impl, std::true_type)
+  {
+    impl->T::~T ();
+  }
+  /**
+   * An implementation which does not fit is never stored inline.
+   *
+   * \tparam T \deduced The type of the implementation.
+   * \param [in] impl The implementation.
+   */
+  template <typename T>
+  static void DoDestroyInline (T *impl, std::false_type)
+  {
+    NS_FATAL_ERROR ("Callback implementation " << impl->GetTypeid () << " is not stored inline");
+  }
   /**
    * \param [in] mangled The mangled string
    * \return The demangled form of mangled
@@ -576,6 +697,14 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::Copy */
+  virtual CallbackImplBase *Copy (void *storage) const {
+    return CallbackImplBase::DoCopy (*this, storage);
+  }
+  /** \copydoc CallbackImplBase::DestroyInline */
+  virtual void DestroyInline (void) {
+    CallbackImplBase::DoDestroyInline (this);
+  }
 private:
   T m_functor;                          //!< the functor
 };
@@ -724,6 +853,14 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::Copy */
+  virtual CallbackImplBase *Copy (void *storage) const {
+    return CallbackImplBase::DoCopy (*this, storage);
+  }
+  /** \copydoc CallbackImplBase::DestroyInline */
+  virtual void DestroyInline (void) {
+    CallbackImplBase::DoDestroyInline (this);
+  }
 private:
   OBJ_PTR const m_objPtr;               //!< the object pointer
   MEM_PTR m_memPtr;                     //!< the member function pointer
@@ -858,6 +995,14 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::Copy */
+  virtual CallbackImplBase *Copy (void *storage) const {
+    return CallbackImplBase::DoCopy (*this, storage);
+  }
+  /** \copydoc CallbackImplBase::DestroyInline */
+  virtual void DestroyInline (void) {
+    CallbackImplBase::DoDestroyInline (this);
+  }
 private:
   T m_functor;                          //!< The functor
   typename TypeTraits<TX>::ReferencedType m_a;  //!< the bound argument
@@ -979,6 +1124,14 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::Copy */
+  virtual CallbackImplBase *Copy (void *storage) const {
+    return CallbackImplBase::DoCopy (*this, storage);
+  }
+  /** \copydoc CallbackImplBase::DestroyInline */
+  virtual void DestroyInline (void) {
+    CallbackImplBase::DoDestroyInline (this);
+  }
 private:
   T m_functor;                                    //!< The functor
   typename TypeTraits<TX1>::ReferencedType m_a1;  //!< first bound argument
@@ -1089,6 +1242,14 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::Copy */
+  virtual CallbackImplBase *Copy (void *storage) const {
+    return CallbackImplBase::DoCopy (*this, storage);
+  }
+  /** \copydoc CallbackImplBase::DestroyInline */
+  virtual void DestroyInline (void) {
+    CallbackImplBase::DoDestroyInline (this);
+  }
 private:
   T m_functor;                                    //!< The functor      
   typename TypeTraits<TX1>::ReferencedType m_a1;  //!< first bound argument 
@@ -1100,19 +1261,167 @@ private:
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The implementations of the member function pointer, functor and
+ * bound callbacks are usually small: they are then stored inline,
+ * in this object, rather than allocated and reference counted.
+ * Copying such a callback copies its implementation. The storage is
+ * part of this class rather than of Callback so that the callbacks
+ * stored as a CallbackBase keep their implementation.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return The impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  /** Tag type, to select the Callback constructor from an implementation. */
+  struct ImplTag {};
+  /** The size of the inline storage for small implementations. */
+  enum { INLINE_SIZE = CallbackImplBase::INLINE_SIZE };
+
+  CallbackBase () : m_impl (0) {}
+  /**
+   * Copy constructor
+   * \param [in] o The other callback
+   */
+  CallbackBase (const CallbackBase &o) : m_impl (0)
+  {
+    Acquire (o);
+  }
+  /**
+   * Assignment operator
+   * \param [in] o The other callback
+   * \return This callback
+   */
+  CallbackBase &operator = (const CallbackBase &o)
+  {
+    if (this != &o)
+      {
+        Release ();
+        Acquire (o);
+      }
+    return *this;
+  }
+  ~CallbackBase ()
+  {
+    Release ();
+  }
+  /**
+   * Get the implementation.
+   *
+   * An implementation stored inline is copied, so that the returned
+   * pointer stays valid after this callback is destroyed.
+   *
+   * \return The impl pointer
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const
+  {
+    if (IsInline ())
+      {
+        return Ptr<CallbackImplBase> (m_impl->Copy (0), false);
+      }
+    return Ptr<CallbackImplBase> (m_impl);
+  }
+  /**
+   * \return The impl pointer, which is valid only as long as this
+   *         callback is alive and not modified.
+   */
+  CallbackImplBase *PeekImpl (void) const
+  {
+    return m_impl;
+  }
+  /**
+   * Check for null implementation, without copying an inline one.
+   *
+   * \return \c true if this callback has no implementation
+   */
+  bool IsNull (void) const
+  {
+    return m_impl == 0;
+  }
 protected:
   /**
    * Construct from a pimpl
    * \param [in] impl The CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (PeekPointer (impl))
+  {
+    if (m_impl != 0)
+      {
+        m_impl->Ref ();
+      }
+  }
+  /**
+   * Set the implementation of a null callback to a copy of \p impl,
+   * stored inline if it fits.
+   *
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   */
+  template <typename IMPL>
+  void SetImpl (IMPL const &impl)
+  {
+    NS_ASSERT (m_impl == 0);
+    DoSetImpl (impl, CallbackImplBase::FitsInline<IMPL> ());
+  }
+  /** Drop the implementation, leaving a null callback. */
+  void Release (void)
+  {
+    if (IsInline ())
+      {
+        m_impl->DestroyInline ();
+      }
+    else if (m_impl != 0)
+      {
+        m_impl->Unref ();
+      }
+    m_impl = 0;
+  }
+  CallbackImplBase *m_impl;             //!< the pimpl
+private:
+  /**
+   * Store a copy of a small implementation inline.
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   */
+  template <typename IMPL>
+  void DoSetImpl (IMPL const &impl, std::true_type)
+  {
+    m_impl = new (&m_storage) IMPL (impl);
+    NS_ASSERT (IsInline ());
+  }
+  /**
+   * Allocate a copy of a large implementation.
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   */
+  template <typename IMPL>
+  void DoSetImpl (IMPL const &impl, std::false_type)
+  {
+    m_impl = new IMPL (impl);
+  }
+  /**
+   * Share or copy the implementation of a callback.
+   * \param [in] o The other callback
+   */
+  void Acquire (const CallbackBase &o)
+  {
+    if (o.IsInline ())
+      {
+        m_impl = o.m_impl->Copy (&m_storage);
+      }
+    else
+      {
+        m_impl = o.m_impl;
+        if (m_impl != 0)
+          {
+            m_impl->Ref ();
+          }
+      }
+  }
+  /** \return \c true if the implementation is stored inline */
+  bool IsInline (void) const
+  {
+    return static_cast<const void *> (m_impl) == static_cast<const void *> (&m_storage);
+  }
+  CallbackImplBase::Storage m_storage; //!< the inline storage
 };
 
 /**
@@ -1188,8 +1497,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    SetImpl (FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (functor));
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1199,8 +1509,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    SetImpl (MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (objPtr, memPtr));
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1211,6 +1522,20 @@ public:
     : CallbackBase (impl)
   {}
 
+  /**
+   * Construct from a copy of a CallbackImpl, stored inline if small
+   * enough.
+   *
+   * \param [in] impl The CallbackImpl to copy
+   */
+  template <typename IMPL>
+  Callback (IMPL const &impl, CallbackBase::ImplTag)
+  {
+    CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *check = &impl;
+    NS_UNUSED (check);
+    SetImpl (impl);
+  }
+
   /**
    * Bind the first arguments
    *
@@ -1272,7 +1597,7 @@ public:
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
-    m_impl = 0;
+    Release ();
   }
 
   /**
@@ -1391,7 +1716,7 @@ public:
    * \return \c true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return m_impl->IsEqual (Ptr<const CallbackImplBase> (other.PeekImpl ()));
   }
 
   /**
@@ -1401,7 +1726,7 @@ public:
    * \return \c true if other can be dynamic_cast to my type
    */
   bool CheckType (const CallbackBase & other) const {
-    return DoCheckType (other.GetImpl ());
+    return DoCheckType (other.PeekImpl ());
   }
   /**
    * Adopt the other's implementation, if type compatible
@@ -1410,22 +1735,22 @@ public:
    * \returns \c true if \p other was type-compatible and could be adopted.
    */
   bool Assign (const CallbackBase &other) {
-    return DoAssign (other.GetImpl ());
+    return DoAssign (other);
   }
 private:
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (m_impl);
   }
   /**
    * Check for compatible types
    *
-   * \param [in] other Callback Ptr
+   * \param [in] other Callback implementation
    * \return \c true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
+  bool DoCheckType (const CallbackImplBase *other) const {
     if (other != 0 &&
-        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1439,17 +1764,17 @@ private:
       }
   }
   /** \copydoc Assign */
-  bool DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  bool DoAssign (const CallbackBase &other) {
+    if (!DoCheckType (other.PeekImpl ()))
       {
-        std::string othTid = other->GetTypeid ();
+        std::string othTid = other.PeekImpl ()->GetTypeid ();
         std::string myTid = CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::DoGetTypeid ();
         NS_FATAL_ERROR_CONT ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
                         "got=" << othTid << std::endl <<
                         "expected=" << myTid);
         return false;
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    CallbackBase::operator = (other);
     return true;
   }
 };
@@ -1684,65 +2009,47 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> MakeNullCallback (void) {
  */   
 template <typename R, typename TX, typename ARG>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX), ARG a1) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1);
-  return Callback<R> (impl);
+  return Callback<R> (BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX,T1), ARG a1) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX,T1,T2), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7, typename T8>
 Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7,T8), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1757,58 +2064,42 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4
  */
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2);
-  return Callback<R> (impl);
+  return Callback<R> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1824,51 +2115,37 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,
  */
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2, a3);
-  return Callback<R> (impl);
+  return Callback<R> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 /**@}*/
 
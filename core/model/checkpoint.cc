@@ -0,0 +1,542 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "log.h"
+#include "abort.h"
+#include "fatal-impl.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace {
+
+/** Request to restore the checkpoint, with the standard streams. */
+const char RESTORE_REQUEST = 'R';
+/** Request to terminate the checkpoint process. */
+const char CLOSE_REQUEST = 'C';
+/** Number of file descriptors sent with a restore request. */
+const int STANDARD_STREAMS = 3;
+
+/** Set in a restored process. */
+bool g_restored = false;
+/** The arguments of a restored process. */
+std::vector<std::string> g_arguments;
+
+/**
+ * Fill the address of a socket.
+ * \param [in] path The file name of the socket.
+ * \param [out] address The address.
+ */
+void
+MakeAddress (const std::string &path, struct sockaddr_un &address)
+{
+  NS_ABORT_MSG_IF (path.size () >= sizeof (address.sun_path),
+                   "Checkpoint socket name too long: " << path);
+  std::memset (&address, 0, sizeof (address));
+  address.sun_family = AF_UNIX;
+  std::strncpy (address.sun_path, path.c_str (), sizeof (address.sun_path) - 1);
+}
+
+/**
+ * Connect to a checkpoint process.
+ * \param [in] path The file name of the socket.
+ * \returns The connected socket, or -1.
+ */
+int
+Connect (const std::string &path)
+{
+  struct sockaddr_un address;
+  MakeAddress (path, address);
+  int sock = socket (AF_UNIX, SOCK_STREAM, 0);
+  NS_ABORT_MSG_IF (sock < 0, "Checkpoint: socket() failed: " << std::strerror (errno));
+  if (connect (sock, (struct sockaddr *) &address, sizeof (address)) < 0)
+    {
+      close (sock);
+      return -1;
+    }
+  return sock;
+}
+
+/**
+ * Write a buffer to a socket.
+ * \param [in] sock The socket.
+ * \param [in] buffer The data.
+ * \param [in] size The size of \p buffer.
+ * \returns \c false on error.
+ */
+bool
+WriteAll (int sock, const void *buffer, size_t size)
+{
+  const char *data = static_cast<const char *> (buffer);
+  while (size > 0)
+    {
+      ssize_t written = send (sock, data, size, MSG_NOSIGNAL);
+      if (written < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (written <= 0)
+        {
+          return false;
+        }
+      data += written;
+      size -= written;
+    }
+  return true;
+}
+
+/**
+ * Read a buffer from a socket.
+ * \param [in] sock The socket.
+ * \param [out] buffer The data.
+ * \param [in] size The size of \p buffer.
+ * \returns \c false on error or end of file.
+ */
+bool
+ReadAll (int sock, void *buffer, size_t size)
+{
+  char *data = static_cast<char *> (buffer);
+  while (size > 0)
+    {
+      ssize_t bytesRead = recv (sock, data, size, 0);
+      if (bytesRead < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (bytesRead <= 0)
+        {
+          return false;
+        }
+      data += bytesRead;
+      size -= bytesRead;
+    }
+  return true;
+}
+
+/**
+ * Write strings to a socket, preceded by their number and sizes.
+ * \param [in] sock The socket.
+ * \param [in] strings The strings.
+ * \returns \c false on error.
+ */
+bool
+WriteStrings (int sock, const std::vector<std::string> &strings)
+{
+  uint32_t n = strings.size ();
+  if (!WriteAll (sock, &n, sizeof (n)))
+    {
+      return false;
+    }
+  for (std::vector<std::string>::const_iterator i = strings.begin (); i != strings.end (); ++i)
+    {
+      uint32_t size = i->size ();
+      if (!WriteAll (sock, &size, sizeof (size)) || !WriteAll (sock, i->data (), size))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * Read strings written by WriteStrings().
+ * \param [in] sock The socket.
+ * \param [out] strings The strings.
+ * \returns \c false on error.
+ */
+bool
+ReadStrings (int sock, std::vector<std::string> &strings)
+{
+  uint32_t n;
+  if (!ReadAll (sock, &n, sizeof (n)))
+    {
+      return false;
+    }
+  strings.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t size;
+      if (!ReadAll (sock, &size, sizeof (size)))
+        {
+          return false;
+        }
+      std::string s (size, '\0');
+      if (size > 0 && !ReadAll (sock, &s[0], size))
+        {
+          return false;
+        }
+      strings.push_back (s);
+    }
+  return true;
+}
+
+/**
+ * Send a request, with file descriptors.
+ * \param [in] sock The socket.
+ * \param [in] request The request type.
+ * \param [in] fds The file descriptors to send, or 0.
+ * \param [in] nFds The number of file descriptors.
+ * \returns \c false on error.
+ */
+bool
+SendRequest (int sock, char request, const int *fds, int nFds)
+{
+  struct iovec iov;
+  iov.iov_base = &request;
+  iov.iov_len = 1;
+  char control[CMSG_SPACE (STANDARD_STREAMS * sizeof (int))];
+  struct msghdr msg;
+  std::memset (&msg, 0, sizeof (msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  if (nFds > 0)
+    {
+      std::memset (control, 0, sizeof (control));
+      msg.msg_control = control;
+      msg.msg_controllen = CMSG_SPACE (nFds * sizeof (int));
+      struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN (nFds * sizeof (int));
+      std::memcpy (CMSG_DATA (cmsg), fds, nFds * sizeof (int));
+    }
+  return sendmsg (sock, &msg, MSG_NOSIGNAL) == 1;
+}
+
+/**
+ * Receive a request and its file descriptors.
+ * \param [in] sock The socket.
+ * \param [out] request The request type.
+ * \param [out] fds The file descriptors received.
+ * \returns The number of file descriptors, or -1 on error.
+ */
+int
+ReceiveRequest (int sock, char &request, int fds[STANDARD_STREAMS])
+{
+  struct iovec iov;
+  iov.iov_base = &request;
+  iov.iov_len = 1;
+  char control[CMSG_SPACE (STANDARD_STREAMS * sizeof (int))];
+  struct msghdr msg;
+  std::memset (&msg, 0, sizeof (msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+  if (recvmsg (sock, &msg, 0) != 1)
+    {
+      return -1;
+    }
+  int nFds = 0;
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg); cmsg != NULL; cmsg = CMSG_NXTHDR (&msg, cmsg))
+    {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+          nFds = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+          std::memcpy (fds, CMSG_DATA (cmsg), nFds * sizeof (int));
+        }
+    }
+  return nFds;
+}
+
+/**
+ * Close file descriptors.
+ * \param [in] fds The file descriptors.
+ * \param [in] nFds Their number.
+ */
+void
+CloseAll (const int *fds, int nFds)
+{
+  for (int i = 0; i < nFds; i++)
+    {
+      close (fds[i]);
+    }
+}
+
+/**
+ * Serve one restore request, in a child of the checkpoint process:
+ * start the restored process and report its exit status.
+ * \param [in] sock The connection.
+ * \param [in] fds The standard streams of the requester.
+ * \returns Only in the restored process.
+ */
+void
+ServeRestore (int sock, const int fds[STANDARD_STREAMS])
+{
+  std::vector<std::string> strings;
+  if (!ReadStrings (sock, strings) || strings.empty ())
+    {
+      _exit (1);
+    }
+  signal (SIGCHLD, SIG_DFL);
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      // The restored process.
+      for (int i = 0; i < STANDARD_STREAMS; i++)
+        {
+          dup2 (fds[i], i);
+        }
+      CloseAll (fds, STANDARD_STREAMS);
+      close (sock);
+      if (chdir (strings[0].c_str ()) < 0)
+        {
+          NS_LOG_WARN ("Could not change directory to " << strings[0]);
+        }
+      g_restored = true;
+      g_arguments.assign (strings.begin () + 1, strings.end ());
+      return;
+    }
+  CloseAll (fds, STANDARD_STREAMS);
+  int32_t status = 1;
+  if (pid > 0)
+    {
+      int wstatus;
+      while (waitpid (pid, &wstatus, 0) < 0 && errno == EINTR)
+        {
+        }
+      if (WIFEXITED (wstatus))
+        {
+          status = WEXITSTATUS (wstatus);
+        }
+      else if (WIFSIGNALED (wstatus))
+        {
+          status = 128 + WTERMSIG (wstatus);
+        }
+    }
+  WriteAll (sock, &status, sizeof (status));
+  _exit (0);
+}
+
+/**
+ * The loop of the checkpoint process.
+ * \param [in] listener The listening socket.
+ * \param [in] path The file name of the socket.
+ * \returns Only in the restored processes.
+ */
+void
+Serve (int listener, const std::string &path)
+{
+  while (true)
+    {
+      int sock = accept (listener, 0, 0);
+      if (sock < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          _exit (1);
+        }
+      char request;
+      int fds[STANDARD_STREAMS];
+      int nFds = ReceiveRequest (sock, request, fds);
+      if (nFds >= 0 && request == CLOSE_REQUEST)
+        {
+          unlink (path.c_str ());
+          _exit (0);
+        }
+      if (nFds == STANDARD_STREAMS && request == RESTORE_REQUEST)
+        {
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              close (listener);
+              ServeRestore (sock, fds);
+              return;
+            }
+        }
+      if (nFds > 0)
+        {
+          CloseAll (fds, nFds);
+        }
+      close (sock);
+    }
+}
+
+/**
+ * Flush the output streams before a fork or a restore: the standard
+ * streams, the stdio streams and the trace files registered with
+ * FatalImpl::RegisterStream().
+ */
+void
+FlushStreams (void)
+{
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  FatalImpl::FlushRegisteredStreams ();
+  std::fflush (0);
+}
+
+} // unnamed namespace
+
+void
+Checkpoint::Save (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  struct sockaddr_un address;
+  MakeAddress (path, address);
+  int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+  NS_ABORT_MSG_IF (listener < 0, "Checkpoint::Save(): socket() failed: " << std::strerror (errno));
+  unlink (path.c_str ());
+  NS_ABORT_MSG_IF (bind (listener, (struct sockaddr *) &address, sizeof (address)) < 0,
+                   "Checkpoint::Save(): bind(" << path << ") failed: " << std::strerror (errno));
+  NS_ABORT_MSG_IF (listen (listener, 16) < 0,
+                   "Checkpoint::Save(): listen() failed: " << std::strerror (errno));
+
+  FlushStreams ();
+  // Fork twice, so the checkpoint process is not a child of the caller.
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "Checkpoint::Save(): fork() failed: " << std::strerror (errno));
+  if (pid > 0)
+    {
+      close (listener);
+      int status;
+      while (waitpid (pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+      NS_LOG_LOGIC ("Saved checkpoint " << path);
+      return;
+    }
+  if (fork () != 0)
+    {
+      _exit (0);
+    }
+
+  // The checkpoint process: detach from the standard streams of the
+  // caller, which could otherwise wait for them to be closed.
+  int null = open ("/dev/null", O_RDWR);
+  if (null >= 0)
+    {
+      for (int i = 0; i < STANDARD_STREAMS; i++)
+        {
+          dup2 (null, i);
+        }
+      close (null);
+    }
+  setsid ();
+  // Do not leave zombies of the restore requests.
+  signal (SIGCHLD, SIG_IGN);
+  Serve (listener, path);
+  NS_LOG_LOGIC ("Restored checkpoint " << path);
+}
+
+bool
+Checkpoint::IsRestored (void)
+{
+  return g_restored;
+}
+
+std::vector<std::string>
+Checkpoint::GetArguments (void)
+{
+  return g_arguments;
+}
+
+bool
+Checkpoint::IsAvailable (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  int sock = Connect (path);
+  if (sock < 0)
+    {
+      return false;
+    }
+  close (sock);
+  return true;
+}
+
+int
+Checkpoint::Restore (const std::string &path, const std::vector<std::string> &args)
+{
+  NS_LOG_FUNCTION (path);
+  int sock = Connect (path);
+  NS_ABORT_MSG_IF (sock < 0, "Checkpoint::Restore(): no checkpoint at " << path);
+
+  std::vector<char> cwd (4096);
+  while (getcwd (&cwd[0], cwd.size ()) == 0)
+    {
+      NS_ABORT_MSG_IF (errno != ERANGE, "Checkpoint::Restore(): getcwd() failed");
+      cwd.resize (cwd.size () * 2);
+    }
+  std::vector<std::string> strings;
+  strings.push_back (&cwd[0]);
+  strings.insert (strings.end (), args.begin (), args.end ());
+
+  FlushStreams ();
+  const int fds[STANDARD_STREAMS] = { 0, 1, 2 };
+  int32_t status;
+  bool ok = SendRequest (sock, RESTORE_REQUEST, fds, STANDARD_STREAMS)
+    && WriteStrings (sock, strings)
+    && ReadAll (sock, &status, sizeof (status));
+  close (sock);
+  NS_ABORT_MSG_IF (!ok, "Checkpoint::Restore(): the checkpoint at " << path << " failed");
+  NS_LOG_LOGIC ("Restored process exited with " << status);
+  return status;
+}
+
+int
+Checkpoint::Restore (const std::string &path, int argc, char *argv[])
+{
+  return Restore (path, std::vector<std::string> (argv, argv + argc));
+}
+
+void
+Checkpoint::Close (const std::string &path)
+{
+  NS_LOG_FUNCTION (path);
+  int sock = Connect (path);
+  if (sock < 0)
+    {
+      return;
+    }
+  if (SendRequest (sock, CLOSE_REQUEST, 0, 0))
+    {
+      // Wait for the checkpoint process to exit.
+      char c;
+      ReadAll (sock, &c, 1);
+    }
+  close (sock);
+}
+
+} // namespace ns3
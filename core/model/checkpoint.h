@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Save the state of a running simulation and restore it in
+ * other processes.
+ *
+ * The pending events of a simulation are arbitrary function objects
+ * bound to pointers into the models, so they cannot be written to a
+ * file. Instead, Save() forks a copy of the whole process: the
+ * checkpoint process. It holds the simulator and its events, the
+ * NodeList, all the objects and their aggregates, and the state of
+ * every RngStream, exactly as they were when Save() was called, and
+ * waits for requests on a unix domain socket.
+ *
+ * Restore(), typically called from a new invocation of the same
+ * program, asks the checkpoint process for a copy of itself. In that
+ * copy, the restored process, Save() returns a second time, with
+ * IsRestored() true: the restored process runs with the standard
+ * input and outputs, working directory and arguments of the caller of
+ * Restore(), which waits for it to exit and returns its exit status.
+ *
+ * A parameter sweep can thus skip the warm-up of the simulation:
+ *
+ * \code
+ *   int main (int argc, char *argv[])
+ *   {
+ *     std::string checkpoint = "warm-up.checkpoint";
+ *     double rate = 1.0;
+ *     CommandLine cmd;
+ *     cmd.AddValue ("rate", "The offered load", rate);
+ *     cmd.Parse (argc, argv);
+ *     if (Checkpoint::IsAvailable (checkpoint))
+ *       {
+ *         return Checkpoint::Restore (checkpoint, argc, argv);
+ *       }
+ *
+ *     // Build the topology and run the warm-up.
+ *     ...
+ *     Simulator::Stop (Seconds (30));
+ *     Simulator::Run ();
+ *
+ *     Checkpoint::Save (checkpoint);
+ *     if (Checkpoint::IsRestored ())
+ *       {
+ *         cmd.Parse (Checkpoint::GetArguments ());
+ *       }
+ *     // Apply rate and run the measurement phase.
+ *     ...
+ *   }
+ * \endcode
+ *
+ * Each restored process starts from the same state, including the
+ * random number streams. The checkpoint process lives until Close().
+ *
+ * Save() must be called while the simulator is not running other
+ * threads: between two calls to Simulator::Run(), or from an event of
+ * a single threaded simulator implementation. The restored process
+ * keeps the logging configuration and the environment of the
+ * checkpoint.
+ *
+ * Save() flushes the standard streams and the trace files, such as
+ * the OutputStreamWrapper, PcapFile and AsciiFile streams, so that
+ * their buffered data is not written again by the restored processes.
+ * The files opened before Save() are nonetheless shared by all the
+ * restored processes, which write through the same file descriptor at
+ * the same offset. The traces of the measurement phase must therefore
+ * be opened after Save(), in the restored process, with names which
+ * depend on its arguments; other streams must be flushed by the
+ * caller before Save().
+ */
+class Checkpoint
+{
+public:
+  /**
+   * Save a checkpoint, held by a new process listening on a socket.
+   *
+   * Save() returns immediately in the calling process, and again in
+   * each restored process.
+   *
+   * \param [in] path The file name of the socket, which is replaced if
+   *             it exists.
+   */
+  static void Save (const std::string &path);
+  /**
+   * Check if this process was restored from a checkpoint.
+   *
+   * \returns \c true in a restored process.
+   */
+  static bool IsRestored (void);
+  /**
+   * Get the arguments passed to Restore().
+   *
+   * \returns The arguments, starting with the program name, or an empty
+   *          vector if this process was not restored.
+   */
+  static std::vector<std::string> GetArguments (void);
+
+  /**
+   * Check if a checkpoint process listens on a socket.
+   *
+   * \param [in] path The file name of the socket.
+   * \returns \c true if the checkpoint can be restored.
+   */
+  static bool IsAvailable (const std::string &path);
+  /**
+   * Restore a checkpoint in a new process and wait for it to exit.
+   *
+   * \param [in] path The file name of the socket.
+   * \param [in] args The arguments for the restored process, starting
+   *             with the program name.
+   * \returns The exit status of the restored process, or 128 plus the
+   *          signal number if it was killed by a signal.
+   */
+  static int Restore (const std::string &path, const std::vector<std::string> &args);
+  /**
+   * Restore a checkpoint with the arguments of main().
+   *
+   * \param [in] path The file name of the socket.
+   * \param [in] argc The number of arguments.
+   * \param [in] argv The arguments.
+   * \returns The exit status of the restored process.
+   */
+  static int Restore (const std::string &path, int argc, char *argv[]);
+  /**
+   * Terminate a checkpoint process and remove its socket. The
+   * restored processes still running are not affected.
+   *
+   * \param [in] path The file name of the socket.
+   */
+  static void Close (const std::string &path);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -114,12 +114,29 @@ CommandLine::Parse (int argc, char *argv[])
 {
   NS_LOG_FUNCTION (this << argc << argv);
 
-  m_name = SystemPath::Split (argv[0]).back ();
+  Parse (std::vector<std::string> (argv, argv + argc));
+
+#ifdef ENABLE_DES_METRICS
+  DesMetrics::Get ()->Initialize (argc, argv);
+#endif
   
-  for (int iargc = 1; iargc < argc; iargc++)
+}
+
+void
+CommandLine::Parse (const std::vector<std::string> &args)
+{
+  NS_LOG_FUNCTION (this << args.size ());
+
+  if (args.empty ())
+    {
+      return;
+    }
+  m_name = SystemPath::Split (args[0]).back ();
+  
+  for (std::vector<std::string>::size_type iarg = 1; iarg < args.size (); iarg++)
     {
       // remove "--" or "-" heading.
-      std::string param = argv[iargc];
+      std::string param = args[iarg];
       std::string::size_type cur = param.find ("--");
       if (cur == 0)
         {
@@ -152,11 +169,6 @@ CommandLine::Parse (int argc, char *argv[])
         }
       HandleArgument (name, value);
     }
-
-#ifdef ENABLE_DES_METRICS
-  DesMetrics::Get ()->Initialize (argc, argv);
-#endif
-  
 }
 
 void
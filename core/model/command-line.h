@@ -23,6 +23,7 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
 
 #include "callback.h"
 
@@ -283,6 +284,12 @@ public:
    * can be retrieved by GetName().
    */
   void Parse (int argc, char *argv[]);
+  /**
+   * Parse the program arguments, from a vector.
+   *
+   * \param [in] args The arguments, starting with the main program name.
+   */
+  void Parse (const std::vector<std::string> &args);
 
   /**
    * Get the program name
@@ -24,8 +24,10 @@
 #include "object-ptr-container.h"
 #include "names.h"
 #include "pointer.h"
+#include "trace-source-accessor.h"
 #include "log.h"
 
+#include <map>
 #include <sstream>
 
 /**
@@ -40,6 +42,55 @@ NS_LOG_COMPONENT_DEFINE ("Config");
 
 namespace Config {
 
+/**
+ * \ingroup config-impl
+ * Find the trace source of the objects matched by a Config path,
+ * looking it up again only when the instance TypeId changes.
+ */
+class TraceSourceLookup
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] name The name of the trace source.
+   */
+  TraceSourceLookup (std::string name);
+  /**
+   * Get the trace source of an object.
+   *
+   * \param [in] object The object.
+   * \returns The trace source accessor, or 0 if \p object has none
+   *          with this name.
+   */
+  Ptr<const TraceSourceAccessor> Get (Ptr<Object> object);
+private:
+  std::string m_name;                        //!< The trace source name.
+  bool m_found;                              //!< Whether m_tid is valid.
+  TypeId m_tid;                              //!< The last instance TypeId.
+  Ptr<const TraceSourceAccessor> m_accessor; //!< The trace source of m_tid.
+};
+
+TraceSourceLookup::TraceSourceLookup (std::string name)
+  : m_name (name),
+    m_found (false)
+{
+  NS_LOG_FUNCTION (this << name);
+}
+Ptr<const TraceSourceAccessor>
+TraceSourceLookup::Get (Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << object);
+  TypeId tid = object->GetInstanceTypeId ();
+  if (!m_found || tid != m_tid)
+    {
+      m_tid = tid;
+      m_accessor = tid.LookupTraceSourceByName (m_name);
+      m_found = true;
+    }
+  return m_accessor;
+}
+
 MatchContainer::MatchContainer ()
 {
   NS_LOG_FUNCTION (this);
@@ -105,11 +156,16 @@ MatchContainer::Connect (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
   NS_ASSERT (m_objects.size () == m_contexts.size ());
+  TraceSourceLookup lookup (name);
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
       Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceConnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor = lookup.Get (object);
+      if (accessor != 0)
+        {
+          std::string ctx = m_contexts[i] + name;
+          accessor->Connect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -117,32 +173,71 @@ MatchContainer::ConnectWithoutContext (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
 
+  TraceSourceLookup lookup (name);
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceConnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor = lookup.Get (object);
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
+uint32_t
+MatchContainer::ConnectEach (std::string name, SinkFactory factory)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ASSERT (m_objects.size () == m_contexts.size ());
+  TraceSourceLookup lookup (name);
+  uint32_t connected = 0;
+  for (uint32_t i = 0; i < m_objects.size (); ++i)
+    {
+      Ptr<Object> object = m_objects[i];
+      Ptr<const TraceSourceAccessor> accessor = lookup.Get (object);
+      if (accessor == 0)
+        {
+          continue;
+        }
+      CallbackBase cb = factory (object, m_contexts[i] + name);
+      if (!cb.IsNull () &&
+          accessor->ConnectWithoutContext (PeekPointer (object), cb))
+        {
+          connected++;
+        }
+    }
+  return connected;
+}
 void 
 MatchContainer::Disconnect (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
   NS_ASSERT (m_objects.size () == m_contexts.size ());
+  TraceSourceLookup lookup (name);
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
       Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceDisconnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor = lookup.Get (object);
+      if (accessor != 0)
+        {
+          std::string ctx = m_contexts[i] + name;
+          accessor->Disconnect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
 MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
+  TraceSourceLookup lookup (name);
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceDisconnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor = lookup.Get (object);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 
@@ -150,6 +245,8 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a list of ranges of indices.
  */
 class ArrayMatcher
 {
@@ -167,7 +264,20 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  /**
+   * Test if the Config Path matches a single index.
+   *
+   * \param [out] i The index.
+   * \returns \c true if the Config Path matches only \p i.
+   */
+  bool GetSingleIndex (uint32_t *i) const;
 private:
+  /**
+   * Parse a Config path specification, or one of its alternatives.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,78 +288,96 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether the element is a wildcard. */
+  bool m_all;
+  /** The ranges of matching indices, with their bounds. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+bool
+ArrayMatcher::GetSingleIndex (uint32_t *i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all || m_ranges.size () != 1 || m_ranges[0].first != m_ranges[0].second)
+    {
+      return false;
+    }
+  *i = m_ranges[0].first;
+  return true;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -261,9 +389,111 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * An attribute through which a Config path reaches other objects:
+ * either a Ptr to an object, or a container of objects.
+ */
+struct PathAttribute
+{
+  std::string name;                            //!< The attribute name.
+  Ptr<const AttributeAccessor> accessor;       //!< The attribute accessor.
+  bool isContainer;                            //!< Whether it holds a container of objects.
+  const ObjectPtrContainerAccessor *container; //!< The container accessor, if usable directly.
+};
+
+/** The attributes matching a Config path element. */
+typedef std::vector<PathAttribute> PathAttributes;
+
+/**
+ * \ingroup config-impl
+ * Get a number which changes when attributes are added to a TypeId
+ * or to one of its parents.
+ *
+ * \param [in] tid The TypeId.
+ * \returns The number of attributes of \p tid and its parents.
+ */
+static uint32_t
+GetAttributeSignature (TypeId tid)
+{
+  uint32_t n = 0;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      n += tid.GetAttributeN ();
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return n;
+}
+
+/**
+ * \ingroup config-impl
+ * Find the attributes of a TypeId and its parents which match a Config
+ * path element, and remember them for the next paths.
+ *
+ * \param [in] tid The instance TypeId of the object.
+ * \param [in] item The Config path element: an attribute name or \c "*".
+ * \param [in] signature The result of GetAttributeSignature() for \p tid.
+ * \returns The matching Ptr and container attributes, in the order of
+ *          the TypeId hierarchy, from \p tid to its root.
+ */
+static const PathAttributes *
+LookupPathAttributes (TypeId tid, const std::string &item, uint32_t signature)
+{
+  NS_LOG_FUNCTION (tid << item << signature);
+  /** The matching attributes, and the signature they were found with. */
+  typedef std::pair<uint32_t, PathAttributes> Entry;
+  static std::map<std::pair<uint16_t, std::string>, Entry> cache;
+  Entry &entry = cache[std::make_pair (tid.GetUid (), item)];
+  if (entry.first == signature && signature != 0)
+    {
+      return &entry.second;
+    }
+  entry.first = signature;
+  entry.second.clear ();
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          PathAttribute attribute;
+          attribute.name = info.name;
+          attribute.accessor = info.accessor;
+          attribute.container = 0;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = false;
+              entry.second.push_back (attribute);
+            }
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = true;
+              attribute.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+              entry.second.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return &entry.second;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * The path is split once into its elements, each with its parsed
+ * index specification and its last matching attributes, so that
+ * wildcards matching many objects of the same type do not parse
+ * the path again for each of them.
  */
 class Resolver
 {
@@ -287,23 +517,58 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
+  /** An element of the Config path, parsed once. */
+  struct Element
+  {
+    /**
+     * Constructor.
+     *
+     * \param [in] item The path element.
+     */
+    Element (std::string item);
+    std::string item;      //!< The path element.
+    ArrayMatcher matcher;  //!< The path element as an index specification.
+    bool hasTid;           //!< Whether tid was looked up.
+    TypeId tid;            //!< The TypeId of a \c $ element.
+    uint16_t uid;          //!< The instance TypeId of the last attribute lookup.
+    uint32_t signature;    //!< The attribute signature of the last lookup.
+    const PathAttributes *attributes;  //!< The result of the last lookup.
+  };
+
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] pos The position of the element in the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t pos, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] pos The position of the index in the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
+   */
+  void DoArrayResolve (uint32_t pos, Ptr<Object> root, const PathAttribute &attribute);
+  /**
+   * Continue with an object of a container matched by the Config path.
+   *
+   * \param [in] pos The position of the index in the Config path.
+   * \param [in] index The index of the object in the container.
+   * \param [in] object The object.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolveIndex (uint32_t pos, uint32_t index, Ptr<Object> object);
+  /**
+   * Get the attributes of an object matching an element of the path.
+   *
+   * \param [in] element The path element.
+   * \param [in] root The object.
+   * \returns The matching attributes.
+   */
+  const PathAttributes *GetAttributes (Element &element, Ptr<Object> root);
   /**
    * Handle one object found on the path.
    *
@@ -328,14 +593,32 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The elements of the Config path. */
+  std::vector<Element> m_elements;
 
 };  // class Resolver
 
+Resolver::Element::Element (std::string item)
+  : item (item),
+    matcher (item),
+    hasTid (false),
+    uid (0),
+    signature (0),
+    attributes (0)
+{}
+
 Resolver::Resolver (std::string path)
   : m_path (path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", start)) != std::string::npos)
+    {
+      m_elements.push_back (Element (m_path.substr (start, next - start)));
+      start = next + 1;
+    }
 }
 Resolver::~Resolver ()
 {
@@ -366,7 +649,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -391,14 +674,27 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+const PathAttributes *
+Resolver::GetAttributes (Element &element, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << element.item << root);
+  TypeId tid = root->GetInstanceTypeId ();
+  uint32_t signature = GetAttributeSignature (tid);
+  if (element.attributes == 0 || element.uid != tid.GetUid () || element.signature != signature)
+    {
+      element.attributes = LookupPathAttributes (tid, element.item, signature);
+      element.uid = tid.GetUid ();
+      element.signature = signature;
+    }
+  return element.attributes;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t pos, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << pos << root);
 
-  if (next == std::string::npos)
+  if (pos == m_elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +710,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  Element &element = m_elements[pos];
+  const std::string &item = element.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +722,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (pos + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +742,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (pos + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -467,77 +762,60 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   if (dollarPos == 0)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      if (!element.hasTid)
+        {
+          std::string tidString = item.substr (1, item.size () - 1);
+          NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
+          element.tid = TypeId::LookupByName (tidString);
+          element.hasTid = true;
+        }
+      Ptr<Object> object = root->GetObject<Object> (element.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (pos + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const PathAttributes *attributes = GetAttributes (element, root);
       bool foundMatch = false;
-      
-      do
+      for (PathAttributes::const_iterator i = attributes->begin (); i != attributes->end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!i->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              if (!i->accessor->Get (PeekPointer (root), ptr))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  root->GetAttribute (i->name, ptr);
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (pos + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoArrayResolve (pos + 1, root, *i);
+              m_workStack.pop_back ();
+            }
+        }
       
       if (!foundMatch)
         {
@@ -548,32 +826,84 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t pos, Ptr<Object> root, const PathAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << pos << root << attribute.name);
+  if (pos == m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_elements[pos].matcher;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  uint32_t n;
+  if (attribute.container == 0 || !attribute.container->GetN (PeekPointer (root), &n))
     {
-      if (matcher.Matches ((*it).first))
+      // Not a container we know how to walk: copy it.
+      ObjectPtrContainerValue container;
+      root->GetAttribute (attribute.name, container);
+      ObjectPtrContainerValue::Iterator it;
+      for (it = container.Begin (); it != container.End (); ++it)
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          if (matcher.Matches ((*it).first))
+            {
+              DoResolveIndex (pos, (*it).first, (*it).second);
+            }
+        }
+      return;
+    }
+
+  // A single index is usually at the same position in the container.
+  uint32_t i;
+  if (matcher.GetSingleIndex (&i) && i < n)
+    {
+      uint32_t index;
+      Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), i, &index);
+      if (index == i)
+        {
+          DoResolveIndex (pos, index, object);
+          return;
         }
     }
+
+  // Otherwise walk the whole container, in the order of the indices.
+  typedef std::vector<std::pair<uint32_t, Ptr<Object> > > Matches;
+  Matches matches;
+  bool sorted = true;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      uint32_t index;
+      Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), j, &index);
+      if (!matcher.Matches (index))
+        {
+          continue;
+        }
+      if (!matches.empty () && index <= matches.back ().first)
+        {
+          sorted = false;
+        }
+      matches.push_back (std::make_pair (index, object));
+    }
+  if (!sorted)
+    {
+      std::map<uint32_t, Ptr<Object> > ordered;
+      ordered.insert (matches.begin (), matches.end ());
+      matches.assign (ordered.begin (), ordered.end ());
+    }
+  for (Matches::const_iterator j = matches.begin (); j != matches.end (); ++j)
+    {
+      DoResolveIndex (pos, j->first, j->second);
+    }
+}
+
+void
+Resolver::DoResolveIndex (uint32_t pos, uint32_t index, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << pos << index << object);
+  std::ostringstream oss;
+  oss << index;
+  m_workStack.push_back (oss.str ());
+  DoResolve (pos + 1, object);
+  m_workStack.pop_back ();
 }
 
 /**
@@ -593,6 +923,8 @@ public:
   void DisconnectWithoutContext (std::string path, const CallbackBase &cb);
   /** \copydoc Config::Disconnect() */
   void Disconnect (std::string path, const CallbackBase &cb);
+  /** \copydoc Config::ConnectEach() */
+  uint32_t ConnectEach (std::string path, MatchContainer::SinkFactory factory);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
 
@@ -684,6 +1016,16 @@ ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
   MatchContainer container = LookupMatches (root);
   container.Disconnect (leaf, cb);
 }
+uint32_t
+ConfigImpl::ConnectEach (std::string path, MatchContainer::SinkFactory factory)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  std::string root, leaf;
+  ParsePath (path, &root, &leaf);
+  MatchContainer container = LookupMatches (root);
+  return container.ConnectEach (leaf, factory);
+}
 
 MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
@@ -851,6 +1193,12 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   ConfigImpl::Get ()->Disconnect (path, cb);
 }
+uint32_t
+ConnectEach (std::string path, MatchContainer::SinkFactory factory)
+{
+  NS_LOG_FUNCTION (path);
+  return ConfigImpl::Get ()->ConnectEach (path, factory);
+}
 MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
@@ -21,6 +21,7 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "callback.h"
 #include <string>
 #include <vector>
 
@@ -34,7 +35,6 @@ namespace ns3 {
 
 class AttributeValue;
 class Object;
-class CallbackBase;
 
 /**
  * \ingroup core
@@ -153,6 +153,14 @@ class MatchContainer
 public:
   /** Const iterator over the objects in this container. */
   typedef std::vector<Ptr<Object> >::const_iterator Iterator;
+  /**
+   * Make the sink connected to the trace source of one object.
+   *
+   * The arguments are the object and the context of its trace source;
+   * the sink returned is connected without context, or not at all if it
+   * is null.
+   */
+  typedef Callback<CallbackBase, Ptr<Object>, std::string> SinkFactory;
   MatchContainer ();
   /**
    * Constructor used only by implementation.
@@ -240,6 +248,17 @@ public:
    * \sa ns3::Config::DisconnectWithoutContext
    */
   void DisconnectWithoutContext (std::string name, const CallbackBase &cb);
+  /**
+   * \param [in] name The name of the trace source to connect to
+   * \param [in] factory Make the sink of each object
+   * \returns The number of trace sources connected
+   *
+   * Connect a different sink to each of the objects stored in this
+   * container, for instance a per-device statistics collector. The
+   * objects for which the factory returns a null callback are skipped.
+   * \sa ns3::Config::ConnectEach
+   */
+  uint32_t ConnectEach (std::string name, SinkFactory factory);
   
 private:
   /** The list of objects in this container. */
@@ -258,6 +277,34 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \param [in] path A path to match trace sources, typically with
+ *            wildcards.
+ * \param [in] factory Make the sink of each matching trace source,
+ *            from its object and its context.
+ * \returns The number of trace sources connected.
+ *
+ * Resolve the path once and connect a sink per matching object,
+ * without context, skipping the objects for which the factory returns
+ * a null callback. This is the bulk equivalent of calling
+ * ConnectWithoutContext with the full path of each object, which
+ * resolves the path again for each of them:
+ * \code
+ *   CallbackBase
+ *   MakeCounter (Ptr<Object> device, std::string context)
+ *   {
+ *     Ptr<Counter> counter = Create<Counter> ();
+ *     g_counters[context] = counter;
+ *     return MakeCallback (&Counter::Count, counter);
+ *   }
+ *   ...
+ *   Config::ConnectEach ("/NodeList/[0-999]/DeviceList/0/Mac/MacTx",
+ *                        MakeCallback (&MakeCounter));
+ * \endcode
+ */
+uint32_t ConnectEach (std::string path, MatchContainer::SinkFactory factory);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
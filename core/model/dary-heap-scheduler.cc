@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DaryHeapScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<DaryHeapScheduler> ()
+  ;
+  return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+DaryHeapScheduler::IsLess (const HeapKey &a, const HeapKey &b)
+{
+  if (a.m_ts != b.m_ts)
+    {
+      return a.m_ts < b.m_ts;
+    }
+  return a.m_uid < b.m_uid;
+}
+
+void
+DaryHeapScheduler::SiftUp (uint32_t index)
+{
+  // Move a hole up instead of swapping entries at each level.
+  HeapKey key = m_keys[index];
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / ARITY;
+      if (!IsLess (key, m_keys[parent]))
+        {
+          break;
+        }
+      m_keys[index] = m_keys[parent];
+      index = parent;
+    }
+  m_keys[index] = key;
+}
+
+void
+DaryHeapScheduler::SiftDown (uint32_t index)
+{
+  uint32_t size = m_keys.size ();
+  HeapKey key = m_keys[index];
+  while (true)
+    {
+      uint32_t first = index * ARITY + 1;
+      if (first >= size)
+        {
+          break;
+        }
+      uint32_t last = first + ARITY;
+      if (last > size)
+        {
+          last = size;
+        }
+      uint32_t smallest = first;
+      for (uint32_t child = first + 1; child < last; child++)
+        {
+          if (IsLess (m_keys[child], m_keys[smallest]))
+            {
+              smallest = child;
+            }
+        }
+      if (!IsLess (m_keys[smallest], key))
+        {
+          break;
+        }
+      m_keys[index] = m_keys[smallest];
+      index = smallest;
+    }
+  m_keys[index] = key;
+}
+
+void
+DaryHeapScheduler::RemoveAt (uint32_t index)
+{
+  NS_ASSERT (index < m_keys.size ());
+  m_freeSlots.push_back (m_keys[index].m_slot);
+  uint32_t last = m_keys.size () - 1;
+  if (index != last)
+    {
+      m_keys[index] = m_keys[last];
+      m_keys.pop_back ();
+      // The moved entry comes from another subtree: it may have to go
+      // either up or down from here.
+      if (index > 0 && IsLess (m_keys[index], m_keys[(index - 1) / ARITY]))
+        {
+          SiftUp (index);
+        }
+      else
+        {
+          SiftDown (index);
+        }
+    }
+  else
+    {
+      m_keys.pop_back ();
+    }
+}
+
+Scheduler::Event
+DaryHeapScheduler::GetEvent (const HeapKey &key) const
+{
+  const Payload &payload = m_payloads[key.m_slot];
+  Scheduler::Event ev;
+  ev.impl = payload.m_impl;
+  ev.key.m_ts = key.m_ts;
+  ev.key.m_uid = key.m_uid;
+  ev.key.m_context = payload.m_context;
+  return ev;
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  Payload payload;
+  payload.m_impl = ev.impl;
+  payload.m_context = ev.key.m_context;
+
+  HeapKey key;
+  key.m_ts = ev.key.m_ts;
+  key.m_uid = ev.key.m_uid;
+  if (m_freeSlots.empty ())
+    {
+      key.m_slot = m_payloads.size ();
+      m_payloads.push_back (payload);
+    }
+  else
+    {
+      key.m_slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+      m_payloads[key.m_slot] = payload;
+    }
+  m_keys.push_back (key);
+  SiftUp (m_keys.size () - 1);
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_keys.empty ();
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_keys.empty ());
+  return GetEvent (m_keys[0]);
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_keys.empty ());
+  Event next = GetEvent (m_keys[0]);
+  RemoveAt (0);
+  return next;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint32_t uid = ev.key.m_uid;
+  for (uint32_t i = 0; i < m_keys.size (); i++)
+    {
+      if (uid == m_keys[i].m_uid)
+        {
+          NS_ASSERT (m_payloads[m_keys[i].m_slot].m_impl == ev.impl);
+          RemoveAt (i);
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-friendly 4-ary heap event scheduler
+ *
+ * This scheduler keeps the same ordering as ns3::HeapScheduler but
+ * is laid out for large event lists:
+ *  - the heap is 4-ary instead of binary, which halves its depth.
+ *    The four children of a node are adjacent in memory so that
+ *    finding the smallest of them reads 64 contiguous bytes.
+ *  - the heap itself only stores a compact 16-byte key (time stamp,
+ *    uid and a slot index). The EventImpl pointer and the context
+ *    live in a separate payload array indexed by the slot, which is
+ *    never touched while percolating entries up or down the heap.
+ *
+ * Freed payload slots are recycled through a free list, so that in
+ * steady state Insert and RemoveNext do not allocate memory.
+ *
+ * Removing an arbitrary event (Remove) requires a linear scan of the
+ * key array, as in ns3::HeapScheduler.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DaryHeapScheduler ();
+  /** Destructor. */
+  virtual ~DaryHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** The heap arity. */
+  static const uint32_t ARITY = 4;
+
+  /** Compact heap entry: the sort key and the index of the payload. */
+  struct HeapKey
+  {
+    uint64_t m_ts;    /**< Event time stamp. */
+    uint32_t m_uid;   /**< Event unique id. */
+    uint32_t m_slot;  /**< Index of the event payload in m_payloads. */
+  };
+  /** Event data which is not needed to maintain the heap order. */
+  struct Payload
+  {
+    EventImpl *m_impl;   /**< Pointer to the event implementation. */
+    uint32_t m_context;  /**< Event context. */
+  };
+
+  /**
+   * Compare (less than) two heap keys.
+   *
+   * \param [in] a The first key.
+   * \param [in] b The second key.
+   * \returns \c true if \c a < \c b
+   */
+  static inline bool IsLess (const HeapKey &a, const HeapKey &b);
+  /**
+   * Percolate an entry up towards the root.
+   *
+   * \param [in] index The heap index of the entry to move.
+   */
+  void SiftUp (uint32_t index);
+  /**
+   * Percolate an entry down towards the leaves.
+   *
+   * \param [in] index The heap index of the entry to move.
+   */
+  void SiftDown (uint32_t index);
+  /**
+   * Remove the heap entry at \p index and restore the heap order.
+   *
+   * \param [in] index The heap index of the entry to remove.
+   */
+  void RemoveAt (uint32_t index);
+  /**
+   * Rebuild a full Event from a heap key and its payload.
+   *
+   * \param [in] key The heap key.
+   * \returns The Event.
+   */
+  Scheduler::Event GetEvent (const HeapKey &key) const;
+
+  /** The heap of keys, root at index 0. */
+  std::vector<HeapKey> m_keys;
+  /** The event payloads, indexed by HeapKey::m_slot. */
+  std::vector<Payload> m_payloads;
+  /** The unused slots of m_payloads. */
+  std::vector<uint32_t> m_freeSlots;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
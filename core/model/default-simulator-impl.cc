@@ -22,13 +22,18 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "double.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <vector>
 
 
 /**
@@ -46,6 +51,13 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/** Smallest number of cancelled events worth a compaction. */
+const uint64_t COMPACTION_MIN_CANCELLED = 64;
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +65,32 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("LazyRemove",
+                   "Make Simulator::Remove cancel the event and leave it in the "
+                   "event list, where it costs nothing until it expires or the "
+                   "event list is compacted.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_lazyRemove),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CompactionThreshold",
+                   "Purge the cancelled events from the event list when they "
+                   "are more than this fraction of it; 1 to never purge them.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Profile",
+                   "Measure the wall clock time of the events, by event type "
+                   "and by context, and write it at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfileOutput",
+                   "The prefix of the profile files: a sorted report is written "
+                   "to <prefix>.txt and folded stacks for flame graphs to "
+                   "<prefix>.folded.",
+                   StringValue ("simulator-profile"),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileOutput),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -71,6 +109,12 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
+  m_compactions = 0;
+  m_lazyRemove = false;
+  m_compactionThreshold = 0.5;
+  m_profile = false;
+  m_profiler = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
 }
@@ -92,12 +136,20 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  delete m_profiler;
+  m_profiler = 0;
   SimulatorImpl::DoDispose ();
 }
 void
 DefaultSimulatorImpl::Destroy ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_profiler != 0)
+    {
+      m_profiler->Write (m_profileOutput);
+      delete m_profiler;
+      m_profiler = 0;
+    }
   while (!m_destroyEvents.empty ()) 
     {
       Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
@@ -114,6 +166,7 @@ void
 DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
 {
   NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
   Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
 
   if (m_events != 0)
@@ -141,12 +194,25 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
+  if (next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler != 0 && !next.impl->IsCancelled ())
+    {
+      m_profiler->Start (next.impl, m_currentContext);
+      next.impl->Invoke ();
+      m_profiler->Stop ();
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -196,6 +262,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profile && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -242,6 +312,10 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_profiler != 0)
+    {
+      m_profiler->Scheduled ();
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -261,6 +335,10 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_profiler != 0)
+        {
+          m_profiler->Scheduled ();
+        }
     }
   else
     {
@@ -290,6 +368,10 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_profiler != 0)
+    {
+      m_profiler->Scheduled ();
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -344,6 +426,11 @@ DefaultSimulatorImpl::Remove (const EventId &id)
     {
       return;
     }
+  if (m_lazyRemove)
+    {
+      CancelQueued (id);
+      return;
+    }
   Scheduler::Event event;
   event.impl = id.PeekEventImpl ();
   event.key.m_ts = id.GetTs ();
@@ -360,10 +447,62 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
     {
+      return;
+    }
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
       id.PeekEventImpl ()->Cancel ();
+      return;
     }
+  CancelQueued (id);
+}
+
+void
+DefaultSimulatorImpl::CancelQueued (const EventId &id)
+{
+  id.PeekEventImpl ()->Cancel ();
+  m_cancelledEvents++;
+  if (m_cancelledEvents >= COMPACTION_MIN_CANCELLED
+      && m_cancelledEvents > m_compactionThreshold * m_unscheduledEvents
+      && m_compactionThreshold < 1)
+    {
+      Compact ();
+    }
+}
+
+void
+DefaultSimulatorImpl::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_unscheduledEvents << m_cancelledEvents);
+  std::vector<Scheduler::Event> live;
+  live.reserve (m_unscheduledEvents - m_cancelledEvents);
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          next.impl->Unref ();
+          m_unscheduledEvents--;
+        }
+      else
+        {
+          live.push_back (next);
+        }
+    }
+  // Some schedulers cannot go back in time once they have dequeued
+  // events: start from a new one. Insert the events in increasing time
+  // order: the LadderScheduler handles it best, and the ListScheduler
+  // appends each event.
+  m_events = m_schedulerFactory.Create<Scheduler> ();
+  for (std::vector<Scheduler::Event>::iterator i = live.begin (); i != live.end (); ++i)
+    {
+      m_events->Insert (*i);
+    }
+  m_cancelledEvents = 0;
+  m_compactions++;
 }
 
 bool
@@ -412,4 +551,22 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCompactionCount (void) const
+{
+  return m_compactions;
+}
+
 } // namespace ns3
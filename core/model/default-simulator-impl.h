@@ -30,6 +30,7 @@
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -39,6 +40,8 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
@@ -77,12 +80,24 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetCancelledEventCount (void) const;
+  virtual uint64_t GetCompactionCount (void) const;
 
 private:
   virtual void DoDispose (void);
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Mark an event of the event list as cancelled, and compact the
+   * event list if too many events are cancelled.
+   *
+   * \param [in] id The event to cancel.
+   */
+  void CancelQueued (const EventId &id);
+  /** Purge the cancelled events from the event list. */
+  void Compact (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -115,6 +130,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The factory of the event priority queue. */
+  ObjectFactory m_schedulerFactory;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -129,6 +146,24 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /** Number of cancelled events still in the event list. */
+  uint64_t m_cancelledEvents;
+  /** Number of compactions of the event list. */
+  uint64_t m_compactions;
+  /** Remove events lazily, by cancelling them. */
+  bool m_lazyRemove;
+  /**
+   * Compact the event list when the fraction of cancelled events
+   * exceeds this threshold.
+   */
+  double m_compactionThreshold;
+
+  /** Measure the wall clock time of the events. */
+  bool m_profile;
+  /** The prefix of the profile files. */
+  std::string m_profileOutput;
+  /** The profiler, while profiling. */
+  EventProfiler *m_profiler;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
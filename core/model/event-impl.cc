@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "free-list-allocator.h"
 #include "log.h"
 
 /**
@@ -66,4 +67,22 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+EventImpl::FunctionId
+EventImpl::GetFunctionId (void) const
+{
+  return FunctionId (0, 0);
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return FreeListAllocator::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  FreeListAllocator::Deallocate (p, size);
+}
+
 } // namespace ns3
@@ -21,6 +21,9 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <utility>
 #include "simple-ref-count.h"
 
 /**
@@ -66,7 +69,61 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * The identity of the function or method called by an event: the
+   * bytes of its function pointer or member function pointer.
+   */
+  typedef std::pair<uintptr_t, uintptr_t> FunctionId;
+  /**
+   * Get the identity of the function or method called by this event.
+   *
+   * The events created by MakeEvent() return the function they were
+   * created with, so that the EventProfiler can tell apart the events
+   * of the same type which call different methods. The default
+   * implementation returns zeros.
+   *
+   * eturns The function identity.
+   */
+  virtual FunctionId GetFunctionId (void) const;
+
+  /**
+   * Allocate the storage of an event.
+   *
+   * Events are allocated from the per-thread free lists of the
+   * FreeListAllocator, so that creating an event in MakeEvent does
+   * not call the system allocator once the simulation has reached
+   * its steady state.
+   *
+   * \param [in] size The size of the event subclass.
+   * \returns The storage.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the storage of an event.
+   *
+   * \param [in] p The storage.
+   * \param [in] size The size of the event subclass.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
+  /**
+   * Helper to implement GetFunctionId().
+   *
+   * The member function pointers larger than a FunctionId are
+   * truncated: the events which call them may then be merged.
+   *
+   * \tparam F \deduced The type of the function pointer.
+   * \param [in] function The function pointer.
+   * \returns The function identity.
+   */
+  template <typename F>
+  static FunctionId MakeFunctionId (F function)
+  {
+    uintptr_t words[2] = { 0, 0 };
+    std::memcpy (words, &function, sizeof (F) < sizeof (words) ? sizeof (F) : sizeof (words));
+    return FunctionId (words[0], words[1]);
+  }
   /**
    * Implementation for Invoke().
    *
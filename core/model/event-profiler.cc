@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * A line of the report.
+ */
+struct Line
+{
+  std::string name;     /**< Event type or context. */
+  uint64_t count;       /**< Number of events. */
+  int64_t nanoseconds;  /**< Wall clock time. */
+  uint64_t fanOut;      /**< Number of events scheduled. */
+};
+
+/**
+ * Sort the report lines by decreasing wall clock time.
+ * \param [in] a The first line.
+ * \param [in] b The second line.
+ * \returns \c true if \p a comes first.
+ */
+bool
+SlowerThan (const Line &a, const Line &b)
+{
+  if (a.nanoseconds != b.nanoseconds)
+    {
+      return a.nanoseconds > b.nanoseconds;
+    }
+  return a.name < b.name;
+}
+
+/**
+ * Write a section of the report.
+ * \param [in,out] os The report.
+ * \param [in] title The title of the first column.
+ * \param [in] lines The lines.
+ * \param [in] total The total wall clock time, in nanoseconds.
+ */
+void
+WriteSection (std::ostream &os, std::string title, std::vector<Line> lines, int64_t total)
+{
+  std::sort (lines.begin (), lines.end (), &SlowerThan);
+  os << std::setw (12) << "wall ms"
+     << std::setw (8) << "%"
+     << std::setw (12) << "events"
+     << std::setw (12) << "ns/event"
+     << std::setw (10) << "fan-out"
+     << "  " << title << std::endl;
+  for (std::vector<Line>::const_iterator i = lines.begin (); i != lines.end (); ++i)
+    {
+      os << std::fixed
+         << std::setw (12) << std::setprecision (3) << i->nanoseconds / 1e6
+         << std::setw (8) << std::setprecision (2) << (total > 0 ? 100.0 * i->nanoseconds / total : 0)
+         << std::setw (12) << i->count
+         << std::setw (12) << std::setprecision (0) << (i->count > 0 ? double (i->nanoseconds) / i->count : 0)
+         << std::setw (10) << std::setprecision (2) << (i->count > 0 ? double (i->fanOut) / i->count : 0)
+         << "  " << i->name << std::endl;
+    }
+}
+
+} // unnamed namespace
+
+EventProfiler::Record::Record ()
+  : count (0),
+    nanoseconds (0),
+    fanOut (0)
+{
+}
+
+void
+EventProfiler::Record::Add (const Record &other)
+{
+  count += other.count;
+  nanoseconds += other.nanoseconds;
+  fanOut += other.fanOut;
+}
+
+EventProfiler::EventProfiler ()
+  : m_current (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Start (const EventImpl *event, uint32_t context)
+{
+  Type type (typeid (*event), event->GetFunctionId ());
+  m_current = &m_records[Key (type, context)];
+  m_start = std::chrono::steady_clock::now ();
+}
+
+void
+EventProfiler::Stop (void)
+{
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - m_start;
+  m_current->count++;
+  m_current->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ();
+  m_current = 0;
+}
+
+std::string
+EventProfiler::GetTypeName (std::type_index type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // The events of MakeEvent are local classes of its instances, such as
+  //   ns3::EventImpl* ns3::MakeEvent<void (ns3::A::*)(), ns3::A*>(void (ns3::A::*)(), ns3::A*)::EventMemberImpl0
+  // keep only the template arguments.
+  std::string::size_type start = name.find ("MakeEvent<");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  start += 10;
+  uint32_t depth = 1;
+  for (std::string::size_type i = start; i < name.size (); i++)
+    {
+      if (name[i] == '<')
+        {
+          depth++;
+        }
+      else if (name[i] == '>' && --depth == 0)
+        {
+          return name.substr (start, i - start);
+        }
+    }
+  return name;
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "context " << context;
+  return oss.str ();
+}
+
+void
+EventProfiler::Write (std::ostream &report, std::ostream &folded) const
+{
+  NS_LOG_FUNCTION (this);
+  std::map<Type, Record> types;
+  std::map<uint32_t, Record> contexts;
+  Record total;
+  std::map<std::type_index, uint32_t> functions;
+  for (std::map<Key, Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+    {
+      std::pair<std::map<Type, Record>::iterator, bool> type =
+        types.insert (std::make_pair (i->first.first, Record ()));
+      if (type.second)
+        {
+          functions[i->first.first.first]++;
+        }
+      type.first->second.Add (i->second);
+      contexts[i->first.second].Add (i->second);
+      total.Add (i->second);
+    }
+
+  // Number the functions of the EventImpl types which call several.
+  std::map<Type, std::string> names;
+  std::map<std::type_index, uint32_t> numbers;
+  for (std::map<Type, Record>::const_iterator i = types.begin (); i != types.end (); ++i)
+    {
+      std::string name = GetTypeName (i->first.first);
+      if (functions[i->first.first] > 1)
+        {
+          std::ostringstream oss;
+          oss << name << " #" << ++numbers[i->first.first];
+          name = oss.str ();
+        }
+      names[i->first] = name;
+    }
+
+  for (std::map<Key, Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+    {
+      folded << GetContextName (i->first.second) << ";" << names[i->first.first]
+             << " " << i->second.nanoseconds << std::endl;
+    }
+
+  std::vector<Line> lines;
+  for (std::map<Type, Record>::const_iterator i = types.begin (); i != types.end (); ++i)
+    {
+      Line line = { names[i->first], i->second.count, i->second.nanoseconds, i->second.fanOut };
+      lines.push_back (line);
+    }
+  report << "Simulator profile: " << total.count << " events, "
+         << std::fixed << std::setprecision (3) << total.nanoseconds / 1e9 << " s" << std::endl
+         << std::endl;
+  WriteSection (report, "event type", lines, total.nanoseconds);
+
+  lines.clear ();
+  for (std::map<uint32_t, Record>::const_iterator i = contexts.begin (); i != contexts.end (); ++i)
+    {
+      Line line = { GetContextName (i->first), i->second.count, i->second.nanoseconds, i->second.fanOut };
+      lines.push_back (line);
+    }
+  report << std::endl;
+  WriteSection (report, "context", lines, total.nanoseconds);
+}
+
+void
+EventProfiler::Write (const std::string &prefix) const
+{
+  NS_LOG_FUNCTION (this << prefix);
+  std::ofstream report ((prefix + ".txt").c_str ());
+  std::ofstream folded ((prefix + ".folded").c_str ());
+  if (!report.is_open () || !folded.is_open ())
+    {
+      NS_LOG_WARN ("Could not open the profile files " << prefix << ".*");
+      return;
+    }
+  Write (report, folded);
+}
+
+} // namespace ns3
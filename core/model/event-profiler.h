@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Attribute the wall clock time of a simulation to event types
+ * and contexts.
+ *
+ * The simulator implementation calls Start() and Stop() around the
+ * execution of each event, and Scheduled() for each event scheduled
+ * in the meantime. The profiler accumulates, for each pair of event
+ * type and context, the number of events, their wall clock time and
+ * the number of events they scheduled (the fan-out).
+ *
+ * The type of an event is the C++ type of its EventImpl and the
+ * function it calls, as returned by EventImpl::GetFunctionId(). For
+ * the events created by MakeEvent(), which are all the events
+ * scheduled through the Simulator API, the report names the signature
+ * of the function and the type of the object and of the arguments
+ * bound to it. The functions with the same signature, such as two
+ * methods of the same class, are reported separately, numbered
+ * \c #1, \c #2... in the order of their addresses.
+ *
+ * Write() produces two outputs:
+ *  - a report with the event types and the contexts sorted by
+ *    decreasing wall clock time;
+ *  - a "folded stacks" file, with one \c context;type line per pair
+ *    followed by its wall clock time in nanoseconds, which can be fed
+ *    to flamegraph.pl.
+ *
+ * The DefaultSimulatorImpl uses this class when its Profile attribute
+ * is set, and writes the outputs at Simulator::Destroy().
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Start measuring the execution of an event.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   */
+  void Start (const EventImpl *event, uint32_t context);
+  /** Stop measuring the execution of the current event. */
+  void Stop (void);
+  /**
+   * Record that an event was scheduled. This is ignored outside of
+   * Start() and Stop().
+   */
+  void Scheduled (void)
+  {
+    if (m_current != 0)
+      {
+        m_current->fanOut++;
+      }
+  }
+
+  /**
+   * Write the report and the folded stacks.
+   *
+   * \param [in,out] report The stream to write the report to.
+   * \param [in,out] folded The stream to write the folded stacks to.
+   */
+  void Write (std::ostream &report, std::ostream &folded) const;
+  /**
+   * Write the report and the folded stacks in files named after a
+   * prefix.
+   *
+   * \param [in] prefix The file name prefix: the report is written to
+   *             \c prefix.txt and the folded stacks to \c prefix.folded.
+   */
+  void Write (const std::string &prefix) const;
+
+private:
+  /** The counters of a set of events. */
+  struct Record
+  {
+    /** Constructor. */
+    Record ();
+    /**
+     * Accumulate another record.
+     * \param [in] other The record to add.
+     */
+    void Add (const Record &other);
+    uint64_t count;        /**< Number of events executed. */
+    int64_t nanoseconds;   /**< Wall clock time of the events. */
+    uint64_t fanOut;       /**< Number of events they scheduled. */
+  };
+
+  /** An event type: the type of the EventImpl and its function. */
+  typedef std::pair<std::type_index, EventImpl::FunctionId> Type;
+  /** The key of a Record: an event type and a context. */
+  typedef std::pair<Type, uint32_t> Key;
+
+  /**
+   * Get a readable name for an event type.
+   * \param [in] type The type of the EventImpl.
+   * \returns The name.
+   */
+  static std::string GetTypeName (std::type_index type);
+  /**
+   * Get a readable name for a context.
+   * \param [in] context The context.
+   * \returns The name.
+   */
+  static std::string GetContextName (uint32_t context);
+
+  /** The counters of each event type and context. */
+  std::map<Key, Record> m_records;
+  /** The counters of the event being executed, if any. */
+  Record *m_current;
+  /** Start of the execution of the current event. */
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
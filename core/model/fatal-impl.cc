@@ -32,6 +32,7 @@
  * \file
  * \ingroup fatalimpl
  * \brief ns3::FatalImpl::RegisterStream(), ns3::FatalImpl::UnregisterStream(),
+ * ns3::FatalImpl::FlushRegisteredStreams()
  * and ns3::FatalImpl::FlushStreams() implementations;
  * see Implementation note!
  *
@@ -120,6 +121,21 @@ UnregisterStream (std::ostream* stream)
     }
 }
 
+void
+FlushRegisteredStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::list<std::ostream*> **pl = PeekStreamList ();
+  if (*pl == 0)
+    {
+      return;
+    }
+  for (std::list<std::ostream*>::const_iterator i = (*pl)->begin (); i != (*pl)->end (); ++i)
+    {
+      (*i)->flush ();
+    }
+}
+
 /**
  * \ingroup fatalimpl
  * Unnamed namespace for fatal streams signal hander.
@@ -27,6 +27,7 @@
  * \file
  * \ingroup fatalimpl
  * ns3::FatalImpl::RegisterStream(), ns3::FatalImpl::UnregisterStream(),
+ * ns3::FatalImpl::FlushRegisteredStreams()
  * and ns3::FatalImpl::FlushStreams() declarations.
  */
 
@@ -73,6 +74,18 @@ void RegisterStream (std::ostream* stream);
  */
 void UnregisterStream (std::ostream* stream);
 
+/**
+ * \ingroup fatalimpl
+ *
+ * \brief Flush all currently registered streams, and keep them
+ * registered.
+ *
+ * Unlike FlushStreams(), this is meant for a program which goes on
+ * running, typically before a \c fork(): the data buffered in the
+ * registered streams would otherwise be written by both processes.
+ */
+void FlushRegisteredStreams (void);
+
 /**
  * \ingroup fatalimpl
  *
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "free-list-allocator.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::FreeListAllocator implementation.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** Number of size classes. */
+const uint32_t N_CLASSES = FreeListAllocator::MAX_SIZE / FreeListAllocator::GRANULARITY;
+
+/** A released block, linked in a free list. */
+struct Block
+{
+  Block *m_next;  /**< Next free block of the same size class. */
+};
+
+/** The free lists and counters of one thread. */
+struct Pool
+{
+  /** Constructor. */
+  Pool ()
+    : m_hits (0),
+      m_misses (0),
+      m_cached (0),
+      m_destroyed (false)
+  {
+    for (uint32_t i = 0; i < N_CLASSES; i++)
+      {
+        m_heads[i] = 0;
+        m_counts[i] = 0;
+      }
+  }
+  /** Destructor: give the cached blocks back to the system. */
+  ~Pool ()
+  {
+    for (uint32_t i = 0; i < N_CLASSES; i++)
+      {
+        while (m_heads[i] != 0)
+          {
+            Block *block = m_heads[i];
+            m_heads[i] = block->m_next;
+            ::operator delete (block);
+          }
+        m_counts[i] = 0;
+      }
+    m_cached = 0;
+    // Blocks released from now on, typically by static destructors,
+    // go straight back to the system allocator.
+    m_destroyed = true;
+  }
+  Block *m_heads[N_CLASSES];  /**< One free list per size class. */
+  uint32_t m_counts[N_CLASSES]; /**< Number of blocks in each free list. */
+  uint64_t m_hits;            /**< Allocations served from a free list. */
+  uint64_t m_misses;          /**< Allocations not served from a free list. */
+  uint64_t m_cached;          /**< Number of blocks in the free lists. */
+  bool m_destroyed;           /**< The thread is exiting. */
+};
+
+/** The free lists of the calling thread. */
+thread_local Pool g_pool;
+
+} // unnamed namespace
+
+void *
+FreeListAllocator::Allocate (std::size_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      return ::operator new (size);
+    }
+  // Always allocate full size classes: the block may be released
+  // into the free lists of another thread.
+  uint32_t index = size == 0 ? 0 : (size - 1) / GRANULARITY;
+  if (g_pool.m_destroyed)
+    {
+      return ::operator new ((index + 1) * GRANULARITY);
+    }
+  Block *block = g_pool.m_heads[index];
+  if (block != 0)
+    {
+      g_pool.m_heads[index] = block->m_next;
+      g_pool.m_counts[index]--;
+      g_pool.m_hits++;
+      g_pool.m_cached--;
+      return block;
+    }
+  g_pool.m_misses++;
+  return ::operator new ((index + 1) * GRANULARITY);
+}
+
+void
+FreeListAllocator::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (size > MAX_SIZE || g_pool.m_destroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  uint32_t index = size == 0 ? 0 : (size - 1) / GRANULARITY;
+  if (g_pool.m_counts[index] >= MAX_CACHED)
+    {
+      ::operator delete (p);
+      return;
+    }
+  Block *block = static_cast<Block *> (p);
+  block->m_next = g_pool.m_heads[index];
+  g_pool.m_heads[index] = block;
+  g_pool.m_counts[index]++;
+  g_pool.m_cached++;
+}
+
+FreeListAllocator::Stats
+FreeListAllocator::GetStats (void)
+{
+  Stats stats;
+  stats.hits = g_pool.m_hits;
+  stats.misses = g_pool.m_misses;
+  stats.cached = g_pool.m_cached;
+  return stats;
+}
+
+} // namespace ns3
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FREE_LIST_ALLOCATOR_H
+#define FREE_LIST_ALLOCATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::FreeListAllocator and ns3::FreeListStlAllocator declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief Size-classed, per-thread free lists for small objects.
+ *
+ * The objects created for every scheduled event (EventImpl subclasses
+ * and the nodes of the list and map schedulers) are small and short
+ * lived. This allocator rounds their size up to a multiple of
+ * GRANULARITY bytes and keeps the released blocks in one free list
+ * per size class, so that once a simulation has reached its steady
+ * state scheduling and executing events does not call the system
+ * allocator anymore.
+ *
+ * Each thread has its own free lists, so that no locking is needed.
+ * A block released by another thread than the one which allocated it
+ * simply moves to the free lists of the releasing thread. Each free
+ * list keeps at most MAX_CACHED blocks, so that a thread which
+ * releases the events of another one does not accumulate them: the
+ * blocks beyond go back to the system allocator. The free lists of a
+ * thread are released when it exits.
+ *
+ * Blocks larger than MAX_SIZE bytes are forwarded to the system
+ * allocator.
+ */
+class FreeListAllocator
+{
+public:
+  /** Allocator counters, for the calling thread. */
+  struct Stats
+  {
+    uint64_t hits;    /**< Allocations served from a free list. */
+    uint64_t misses;  /**< Allocations forwarded to the system allocator. */
+    uint64_t cached;  /**< Number of blocks currently in the free lists. */
+  };
+
+  /** Size class granularity, in bytes. */
+  static const uint32_t GRANULARITY = 16;
+  /** Largest size served from the free lists, in bytes. */
+  static const uint32_t MAX_SIZE = 256;
+  /** Largest number of blocks kept per thread and size class. */
+  static const uint32_t MAX_CACHED = 4096;
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in] size The block size, in bytes.
+   * \returns The block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release a block.
+   *
+   * \param [in] p The block, obtained from Allocate().
+   * \param [in] size The size given to Allocate().
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the counters of the calling thread.
+   *
+   * \returns The counters.
+   */
+  static Stats GetStats (void);
+};
+
+/**
+ * \ingroup events
+ * \brief A standard library allocator backed by FreeListAllocator.
+ *
+ * This is meant for node-based containers such as \c std::list and
+ * \c std::map, which allocate their elements one by one.
+ *
+ * \tparam T \explicit The element type.
+ */
+template <typename T>
+class FreeListStlAllocator
+{
+public:
+  typedef T value_type;              //!< Element type.
+  typedef T * pointer;               //!< Pointer type.
+  typedef const T * const_pointer;   //!< Const pointer type.
+  typedef T & reference;             //!< Reference type.
+  typedef const T & const_reference; //!< Const reference type.
+  typedef std::size_t size_type;     //!< Size type.
+  typedef std::ptrdiff_t difference_type;  //!< Pointer difference type.
+
+  /**
+   * Get the same allocator for another type.
+   * \tparam U \explicit The other element type.
+   */
+  template <typename U>
+  struct rebind
+  {
+    typedef FreeListStlAllocator<U> other;  //!< The allocator type.
+  };
+
+  /** Default constructor. */
+  FreeListStlAllocator ()
+  {}
+  /**
+   * Converting constructor.
+   * \tparam U \deduced The other element type.
+   */
+  template <typename U>
+  FreeListStlAllocator (const FreeListStlAllocator<U> &)
+  {}
+
+  /**
+   * Allocate storage.
+   * \param [in] n The number of elements.
+   * \returns The storage.
+   */
+  pointer allocate (size_type n, const void * = 0)
+  {
+    return static_cast<pointer> (FreeListAllocator::Allocate (n * sizeof (T)));
+  }
+  /**
+   * Release storage.
+   * \param [in] p The storage.
+   * \param [in] n The number of elements.
+   */
+  void deallocate (pointer p, size_type n)
+  {
+    FreeListAllocator::Deallocate (p, n * sizeof (T));
+  }
+  /**
+   * Construct an element.
+   * \param [in] p The element storage.
+   * \param [in] v The value to copy.
+   */
+  void construct (pointer p, const T &v)
+  {
+    new (static_cast<void *> (p)) T (v);
+  }
+  /**
+   * Destroy an element.
+   * \param [in] p The element.
+   */
+  void destroy (pointer p)
+  {
+    p->~T ();
+  }
+  /**
+   * Get the address of an element.
+   * \param [in] r The element.
+   * \returns The element address.
+   */
+  pointer address (reference r) const
+  {
+    return &r;
+  }
+  /**
+   * Get the address of an element.
+   * \param [in] r The element.
+   * \returns The element address.
+   */
+  const_pointer address (const_reference r) const
+  {
+    return &r;
+  }
+  /**
+   * Get the maximum number of elements.
+   * \returns The maximum number of elements.
+   */
+  size_type max_size (void) const
+  {
+    return static_cast<size_type> (-1) / sizeof (T);
+  }
+};
+
+/**
+ * Compare two FreeListStlAllocator: they are all interchangeable.
+ * \tparam T \deduced The first element type.
+ * \tparam U \deduced The second element type.
+ * \returns \c true.
+ */
+template <typename T, typename U>
+inline bool operator == (const FreeListStlAllocator<T> &, const FreeListStlAllocator<U> &)
+{
+  return true;
+}
+
+/**
+ * Compare two FreeListStlAllocator: they are all interchangeable.
+ * \tparam T \deduced The first element type.
+ * \tparam U \deduced The second element type.
+ * \returns \c false.
+ */
+template <typename T, typename U>
+inline bool operator != (const FreeListStlAllocator<T> &, const FreeListStlAllocator<U> &)
+{
+  return false;
+}
+
+} // namespace ns3
+
+#endif /* FREE_LIST_ALLOCATOR_H */
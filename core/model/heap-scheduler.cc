@@ -236,6 +236,14 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
+          // The former last item comes from another subtree, so it
+          // might be smaller than the parent of its new position.
+          while (!IsBottom (i) && !IsRoot (i)
+                 && IsLessStrictly (i, Parent (i)))
+            {
+              Exch (i, Parent (i));
+              i = Parent (i);
+            }
           TopDown (i);
           return;
         }
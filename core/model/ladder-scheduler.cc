@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  // The rungs are never reallocated, so that references to them stay
+  // valid while events are moved from one rung to the next.
+  m_rungs.resize (MAX_RUNGS);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung)
+{
+  return rung.m_start + rung.m_current * rung.m_width;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  // Each rung covers the time range just before the current bucket
+  // of the rung above it.
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= CurrentStart (m_rungs[i]))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::AddRung (uint64_t start, uint64_t end, Bucket &events)
+{
+  NS_LOG_FUNCTION (this << start << end << events.size ());
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (end > start && !events.empty ());
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+
+  // About one event per bucket.
+  uint64_t range = end - start;
+  uint64_t n = events.size ();
+  rung.m_width = (range + n - 1) / n;
+  uint32_t nBuckets = (range + rung.m_width - 1) / rung.m_width;
+  // The buckets of a retired rung are all empty; resizing keeps
+  // their capacity.
+  rung.m_buckets.resize (nBuckets);
+  rung.m_start = start;
+  rung.m_current = 0;
+  rung.m_count = events.size ();
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint64_t index = (i->key.m_ts - start) / rung.m_width;
+      NS_ASSERT (index < nBuckets);
+      rung.m_buckets[index].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::MoveToBottom (Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottomHead == m_bottom.size ());
+  m_bottom.clear ();
+  m_bottom.swap (events);
+  m_bottomHead = 0;
+  std::sort (m_bottom.begin (), m_bottom.end ());
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  if (m_bottomHead > THRES && m_bottomHead * 2 > m_bottom.size ())
+    {
+      // reclaim the space of the events already dequeued.
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+    }
+  Bucket::iterator begin = m_bottom.begin () + m_bottomHead;
+  if (m_bottomHead > 0 && (begin == m_bottom.end () || ev < *begin))
+    {
+      m_bottomHead--;
+      m_bottom[m_bottomHead] = ev;
+      return;
+    }
+  m_bottom.insert (std::upper_bound (begin, m_bottom.end (), ev), ev);
+
+  if (m_bottom.size () - m_bottomHead > THRES
+      && m_nRungs < MAX_RUNGS
+      && m_bottom[m_bottomHead].key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // Bottom has grown too large to be kept sorted cheaply: turn it
+      // into a new rung which ends where the lowest rung starts.
+      NS_LOG_LOGIC ("spawn bottom into rung " << m_nRungs);
+      uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+      uint64_t end = m_topStart;
+      if (m_nRungs > 0)
+        {
+          end = CurrentStart (m_rungs[m_nRungs - 1]);
+        }
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+      AddRung (start, end, m_bottom);
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottomHead == m_bottom.size ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              // the scheduler is empty.
+              return;
+            }
+          // start a new epoch with the content of Top.
+          uint64_t start = m_topMin;
+          m_topStart = m_topMax + 1;
+          if (m_top.size () <= THRES || m_topMin == m_topMax)
+            {
+              MoveToBottom (m_top);
+            }
+          else
+            {
+              AddRung (start, m_topStart, m_top);
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.m_count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.m_current++;
+      rung.m_count -= bucket.size ();
+
+      bool spawn = false;
+      if (bucket.size () > THRES && m_nRungs < MAX_RUNGS && rung.m_width > 1)
+        {
+          // a bucket of simultaneous events cannot be split.
+          uint64_t ts = bucket.front ().key.m_ts;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              if (i->key.m_ts != ts)
+                {
+                  spawn = true;
+                  break;
+                }
+            }
+        }
+      if (spawn)
+        {
+          AddRung (bucketStart, bucketStart + rung.m_width, bucket);
+        }
+      else
+        {
+          MoveToBottom (bucket);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_qSize++;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+      // If the scheduler was empty, Bottom has to be filled again.
+      Refill ();
+      return;
+    }
+  uint32_t r = FindRung (ts);
+  if (r < m_nRungs)
+    {
+      Rung &rung = m_rungs[r];
+      uint64_t index = (ts - rung.m_start) / rung.m_width;
+      NS_ASSERT (index < rung.m_buckets.size ());
+      rung.m_buckets[index].push_back (ev);
+      rung.m_count++;
+    }
+  else
+    {
+      InsertInBottom (ev);
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  NS_ASSERT (m_bottomHead < m_bottom.size ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  NS_ASSERT (m_bottomHead < m_bottom.size ());
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_qSize--;
+  Refill ();
+  NS_LOG_DEBUG (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  uint32_t uid = ev.key.m_uid;
+  // An event is always found where it would be inserted now.
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t r = FindRung (ts);
+      if (r == m_nRungs)
+        {
+          Bucket::iterator i = std::lower_bound (m_bottom.begin () + m_bottomHead,
+                                                 m_bottom.end (), ev);
+          NS_ASSERT (i != m_bottom.end () && i->key.m_uid == uid);
+          NS_ASSERT (i->impl == ev.impl);
+          if (i == m_bottom.begin () + m_bottomHead)
+            {
+              m_bottomHead++;
+            }
+          else
+            {
+              m_bottom.erase (i);
+            }
+          m_qSize--;
+          Refill ();
+          return;
+        }
+      Rung &rung = m_rungs[r];
+      uint64_t index = (ts - rung.m_start) / rung.m_width;
+      NS_ASSERT (index < rung.m_buckets.size ());
+      bucket = &rung.m_buckets[index];
+      rung.m_count--;
+    }
+  // Buckets and Top are not sorted.
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == uid)
+        {
+          NS_ASSERT (i->impl == ev.impl);
+          *i = bucket->back ();
+          bucket->pop_back ();
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the Ladder Queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are spread over three tiers:
+ *  - Top: an unsorted array which receives all the events scheduled
+ *    after the current epoch.
+ *  - Ladder: up to MAX_RUNGS rungs of unsorted buckets. Each rung
+ *    covers the time range of one bucket of the rung above it, with
+ *    finer buckets.
+ *  - Bottom: a small sorted array from which events are dequeued.
+ *
+ * When Bottom is exhausted, the first non-empty bucket of the lowest
+ * rung is either sorted into Bottom, if it holds few enough events,
+ * or spawned into a new, finer rung. Events are thus sorted lazily,
+ * in small batches, and unlike the calendar queue there is never a
+ * global resize of the structure.
+ *
+ * Buckets whose events all share the same time stamp (typical for
+ * bursts of simultaneous timers) cannot be split further and go to
+ * Bottom directly, where they are appended in uid order.
+ *
+ * All the tiers are backed by contiguous arrays. Buckets and rungs
+ * keep their capacity when emptied, so that the memory is reused from
+ * one epoch to the next.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Maximum number of events sorted at once into Bottom. */
+  static const uint32_t THRES = 50;
+  /** Maximum number of rungs in the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /** Bucket type: an unsorted array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> m_buckets;  /**< The buckets. */
+    uint64_t m_start;    /**< Time stamp of the start of the first bucket. */
+    uint64_t m_width;    /**< Bucket width, in dimensionless time units. */
+    uint32_t m_current;  /**< Index of the first bucket not yet dequeued. */
+    uint32_t m_count;    /**< Number of events in this rung. */
+  };
+
+  /**
+   * Get the start of the time range of a rung which is still
+   * covered by its buckets.
+   *
+   * \param [in] rung The rung.
+   * \returns The start time of the current bucket.
+   */
+  static inline uint64_t CurrentStart (const Rung &rung);
+  /**
+   * Find the rung which covers a time stamp.
+   *
+   * \param [in] ts The time stamp.
+   * \returns The rung index, or m_nRungs if \p ts belongs to Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Add a new rung at the bottom of the ladder, and distribute
+   * events in it.
+   *
+   * \param [in] start The start of the time range of the new rung.
+   * \param [in] end The end (excluded) of the time range of the new rung.
+   * \param [in] events The events to distribute; it is left empty.
+   */
+  void AddRung (uint64_t start, uint64_t end, Bucket &events);
+  /**
+   * Sort events and move them into Bottom, which must be empty.
+   *
+   * \param [in] events The events to move; it is left empty.
+   */
+  void MoveToBottom (Bucket &events);
+  /**
+   * Insert an event in Bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /**
+   * Refill Bottom from the ladder, or from Top, if it is empty.
+   *
+   * This maintains the invariant that Bottom is never empty unless
+   * the whole scheduler is empty.
+   */
+  void Refill (void);
+
+  /** Top: unsorted events at or after m_topStart. */
+  Bucket m_top;
+  /** Smallest time stamp in Top. */
+  uint64_t m_topMin;
+  /** Largest time stamp in Top. */
+  uint64_t m_topMax;
+  /** Events at or after this time stamp go to Top. */
+  uint64_t m_topStart;
+  /**
+   * The rungs. Only the first m_nRungs are in use, the others are
+   * kept to reuse their buckets.
+   */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Bottom: sorted events, starting at index m_bottomHead. */
+  Bucket m_bottom;
+  /** Index of the first valid event in m_bottom. */
+  uint32_t m_bottomHead;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
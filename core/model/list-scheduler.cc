@@ -60,6 +60,12 @@ void
 ListScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
+  if (m_events.empty () || !(ev.key < m_events.back ().key))
+    {
+      // Later than all the events, as when they are inserted in order.
+      m_events.push_back (ev);
+      return;
+    }
   for (EventsI i = m_events.begin (); i != m_events.end (); i++)
     {
       if (ev.key < i->key)
@@ -55,6 +55,22 @@
 #define NS_LOG_UNCOND(msg) \
         NS_LOG_NOOP_INTERNAL (msg)
 
+/**
+ * \ingroup logging
+ * Empty logging macro implementation, used when logging is disabled.
+ * \param [in] level Unused.
+ * \param [in] ... Unused.
+ */
+#define NS_LOG_RECORD(level, ...)                                       \
+  do                                                                    \
+    {                                                                   \
+      if (false)                                                        \
+        {                                                               \
+          ns3::LogRingBuffer::Format (std::clog, __VA_ARGS__);          \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
 
 #endif /* !NS3_LOG_ENABLE */
 
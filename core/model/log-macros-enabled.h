@@ -30,6 +30,50 @@
 #ifdef NS3_LOG_ENABLE
 
 
+#ifndef NS_LOG_MAX_LEVEL
+/**
+ * \ingroup logging
+ * The log levels compiled into the program, for all the components.
+ *
+ * Messages of the other levels are removed at compile time: they cost
+ * nothing, and cannot be enabled at run time.  Set it when
+ * configuring, for instance with
+ * \code
+ *   CXXFLAGS="-DNS_LOG_MAX_LEVEL=ns3::LOG_LEVEL_INFO" ./waf configure ...
+ * \endcode
+ * to keep the errors, warnings, debug and info messages in optimized
+ * builds while removing the function and logic tracing.
+ */
+#define NS_LOG_MAX_LEVEL ns3::LOG_LEVEL_ALL
+#endif /* NS_LOG_MAX_LEVEL */
+
+#ifndef NS_LOG_COMPONENT_MAX_LEVEL
+/**
+ * \ingroup logging
+ * The log levels compiled into the current file, within
+ * NS_LOG_MAX_LEVEL.
+ *
+ * A file on a hot path can restrict its own log levels, after its
+ * includes, like NS_LOG_APPEND_CONTEXT:
+ * \code
+ *   #undef NS_LOG_COMPONENT_MAX_LEVEL
+ *   #define NS_LOG_COMPONENT_MAX_LEVEL ns3::LOG_LEVEL_DEBUG
+ * \endcode
+ */
+#define NS_LOG_COMPONENT_MAX_LEVEL NS_LOG_MAX_LEVEL
+#endif /* NS_LOG_COMPONENT_MAX_LEVEL */
+
+/**
+ * \ingroup logging
+ * Check at compile time if a log level is compiled in.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ * \param [in] level The log level.
+ */
+#define NS_LOG_STATIC_ENABLED(level)                            \
+  (((level) & (NS_LOG_MAX_LEVEL) & (NS_LOG_COMPONENT_MAX_LEVEL)) != 0)
+
+
 /**
  * \ingroup logging
  * Append the simulation time to a log message.
@@ -153,7 +197,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if (NS_LOG_STATIC_ENABLED (level)                         \
+          && g_log.IsEnabled (level))                           \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -177,7 +222,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_STATIC_ENABLED (ns3::LOG_FUNCTION)             \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -214,7 +260,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_STATIC_ENABLED (ns3::LOG_FUNCTION)             \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -228,6 +275,51 @@
   while (false)
 
 
+/**
+ * \ingroup logging
+ *
+ * Log a message with lazy formatting.
+ *
+ * The message is made of a format string literal, in which each
+ * \c {} stands for an argument, and of numbers, pointers or string
+ * literals:
+ * \code
+ * NS_LOG_RECORD (ns3::LOG_LOGIC, "Rx packet {} of {} bytes", uid, size);
+ * \endcode
+ * Once ns3::LogRingBuffer::Enable() is called, the message is stored
+ * in binary form into the ring buffer, and only formatted when it is
+ * flushed.  Otherwise it is printed like NS_LOG().
+ *
+ * \param [in] level The log level.
+ * \param [in] ... The format string literal and its arguments.
+ */
+#define NS_LOG_RECORD(level, ...)                               \
+  NS_LOG_CONDITION                                              \
+  do                                                            \
+    {                                                           \
+      if (NS_LOG_STATIC_ENABLED (level)                         \
+          && g_log.IsEnabled (level))                           \
+        {                                                       \
+          if (ns3::LogRingBuffer::IsEnabled ())                 \
+            {                                                   \
+              ns3::LogRingBuffer::Record (g_log, level,         \
+                                          __VA_ARGS__);         \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              NS_LOG_APPEND_FUNC_PREFIX;                        \
+              NS_LOG_APPEND_LEVEL_PREFIX (level);               \
+              ns3::LogRingBuffer::Format (std::clog,            \
+                                          __VA_ARGS__);         \
+              std::clog << std::endl;                           \
+            }                                                   \
+        }                                                       \
+    }                                                           \
+  while (false)
+
 /**
  * \ingroup logging
  *
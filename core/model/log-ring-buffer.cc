@@ -0,0 +1,327 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-ring-buffer.h"
+#include "nstime.h"
+
+#include <atomic>
+#include <iomanip>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogRingBuffer implementation.
+ */
+
+namespace ns3 {
+
+// Note: no logging in this file, since it implements logging.
+
+namespace {
+
+/**
+ * \ingroup logging
+ * A message stored in the ring buffer.
+ *
+ * The sequence number is odd while the message is written, and
+ * <tt>2 * (position + 1)</tt> once it is complete, so that a reader
+ * can detect the messages being written or overwritten.
+ */
+struct LogSlot
+{
+  std::atomic<uint64_t> sequence;      //!< The sequence number.
+  int64_t time;                        //!< The simulation time step.
+  uint32_t context;                    //!< The simulation context.
+  enum LogLevel level;                 //!< The log level.
+  const LogComponent *component;       //!< The log component.
+  const char *format;                  //!< The format string.
+  std::size_t n;                       //!< The number of arguments.
+  /** The arguments. */
+  LogRingBuffer::Argument args[LogRingBuffer::MAX_ARGUMENTS];
+};
+
+/**
+ * \ingroup logging
+ * The ring buffer.
+ */
+struct LogRing
+{
+  /**
+   * Constructor.
+   * \param [in] capacity The number of messages, a power of two.
+   */
+  LogRing (std::size_t capacity)
+    : mask (capacity - 1),
+      slots (new LogSlot[capacity]),
+      head (0),
+      tail (0),
+      overwritten (0),
+      retired (0)
+  {
+    for (std::size_t i = 0; i < capacity; i++)
+      {
+        slots[i].sequence.store (0, std::memory_order_relaxed);
+      }
+  }
+  /** Destructor. */
+  ~LogRing ()
+  {
+    delete [] slots;
+  }
+
+  uint64_t mask;                   //!< The capacity minus one.
+  LogSlot *slots;                  //!< The messages.
+  std::atomic<uint64_t> head;      //!< The position of the next message.
+  uint64_t tail;                   //!< The position of the first message not flushed.
+  uint64_t overwritten;            //!< The messages lost before the last flush.
+  LogRing *retired;                //!< The next retired ring buffer.
+};
+
+/** The ring buffer, if enabled. */
+std::atomic<LogRing *> g_logRing (0);
+
+/**
+ * The ring buffers replaced by Enable() or Disable().  Other threads
+ * may still be writing to them, so they are only freed at exit.
+ */
+std::atomic<LogRing *> g_logRetiredRings (0);
+
+/** Free the retired ring buffers at exit. */
+struct LogRingReaper
+{
+  ~LogRingReaper ()
+  {
+    LogRing *ring = g_logRetiredRings.exchange (0);
+    while (ring != 0)
+      {
+        LogRing *next = ring->retired;
+        delete ring;
+        ring = next;
+      }
+  }
+} g_logRingReaper; //!< Frees the retired ring buffers at exit.
+
+/**
+ * Retire a ring buffer which was replaced.
+ * \param [in] ring The ring buffer, or 0.
+ */
+void
+RetireLogRing (LogRing *ring)
+{
+  if (ring == 0)
+    {
+      return;
+    }
+  ring->retired = g_logRetiredRings.load (std::memory_order_relaxed);
+  while (!g_logRetiredRings.compare_exchange_weak (ring->retired, ring))
+    {
+    }
+}
+
+/** The time and context getter. */
+LogRingBuffer::StampGetter g_logStampGetter = 0;
+
+} // unnamed namespace
+
+void
+LogRingBuffer::Enable (std::size_t capacity)
+{
+  std::size_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  RetireLogRing (g_logRing.exchange (new LogRing (size)));
+}
+
+void
+LogRingBuffer::Disable (void)
+{
+  RetireLogRing (g_logRing.exchange (0));
+}
+
+bool
+LogRingBuffer::IsEnabled (void)
+{
+  return g_logRing.load (std::memory_order_relaxed) != 0;
+}
+
+void
+LogRingBuffer::SetStampGetter (StampGetter getter)
+{
+  g_logStampGetter = getter;
+}
+
+void
+LogRingBuffer::DoRecord (const LogComponent &component, enum LogLevel level,
+                         const char *format, const Argument *args, std::size_t n)
+{
+  LogRing *ring = g_logRing.load (std::memory_order_acquire);
+  if (ring == 0)
+    {
+      // Disabled in the meantime.
+      DoFormat (std::clog, format, args, n);
+      std::clog << std::endl;
+      return;
+    }
+  int64_t time = -1;
+  uint32_t context = 0xffffffff;
+  if (g_logStampGetter != 0)
+    {
+      (*g_logStampGetter)(&time, &context);
+    }
+
+  uint64_t position = ring->head.fetch_add (1, std::memory_order_relaxed);
+  LogSlot &slot = ring->slots[position & ring->mask];
+  slot.sequence.store (2 * position + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence (std::memory_order_release);
+  slot.time = time;
+  slot.context = context;
+  slot.level = level;
+  slot.component = &component;
+  slot.format = format;
+  slot.n = n;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      slot.args[i] = args[i];
+    }
+  slot.sequence.store (2 * position + 2, std::memory_order_release);
+}
+
+void
+LogRingBuffer::DoFormat (std::ostream &os, const char *format,
+                         const Argument *args, std::size_t n)
+{
+  std::size_t next = 0;
+  for (const char *c = format; *c != 0; c++)
+    {
+      if (c[0] != '{' || c[1] != '}' || next == n)
+        {
+          os << *c;
+          continue;
+        }
+      const Argument &arg = args[next++];
+      switch (arg.type)
+        {
+        case Argument::SIGNED:
+          os << arg.i;
+          break;
+        case Argument::UNSIGNED:
+          os << arg.u;
+          break;
+        case Argument::DOUBLE:
+          os << arg.d;
+          break;
+        case Argument::STRING:
+          os << (arg.s != 0 ? arg.s : "(null)");
+          break;
+        case Argument::POINTER:
+          os << arg.p;
+          break;
+        case Argument::NONE:
+          break;
+        }
+      c++;
+    }
+}
+
+std::size_t
+LogRingBuffer::Flush (std::ostream &os)
+{
+  LogRing *ring = g_logRing.load (std::memory_order_acquire);
+  if (ring == 0)
+    {
+      return 0;
+    }
+  uint64_t head = ring->head.load (std::memory_order_acquire);
+  uint64_t first = ring->tail;
+  if (head - first > ring->mask + 1)
+    {
+      first = head - (ring->mask + 1);
+      ring->overwritten += first - ring->tail;
+    }
+
+  std::size_t printed = 0;
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  for (uint64_t position = first; position < head; position++)
+    {
+      LogSlot &slot = ring->slots[position & ring->mask];
+      uint64_t sequence = slot.sequence.load (std::memory_order_acquire);
+      if (sequence != 2 * position + 2)
+        {
+          // Still being written, or already overwritten.
+          continue;
+        }
+      int64_t time = slot.time;
+      uint32_t context = slot.context;
+      enum LogLevel level = slot.level;
+      const LogComponent *component = slot.component;
+      const char *format = slot.format;
+      std::size_t n = slot.n;
+      Argument args[MAX_ARGUMENTS];
+      for (std::size_t i = 0; i < n && i < MAX_ARGUMENTS; i++)
+        {
+          args[i] = slot.args[i];
+        }
+      std::atomic_thread_fence (std::memory_order_acquire);
+      if (slot.sequence.load (std::memory_order_relaxed) != sequence)
+        {
+          continue;
+        }
+
+      if (time >= 0)
+        {
+          os << "+" << std::fixed << std::setprecision (9)
+             << TimeStep (time).GetSeconds () << "s ";
+          os.flags (flags);
+          os.precision (precision);
+        }
+      if (context == 0xffffffff)
+        {
+          os << "-1 ";
+        }
+      else
+        {
+          os << context << " ";
+        }
+      os << component->Name () << ":[" << LogComponent::GetLevelLabel (level) << "] ";
+      DoFormat (os, format, args, n);
+      os << std::endl;
+      printed++;
+    }
+  ring->tail = head;
+  return printed;
+}
+
+uint64_t
+LogRingBuffer::GetOverwritten (void)
+{
+  LogRing *ring = g_logRing.load (std::memory_order_acquire);
+  if (ring == 0)
+    {
+      return 0;
+    }
+  uint64_t pending = ring->head.load (std::memory_order_relaxed) - ring->tail;
+  uint64_t lost = ring->overwritten;
+  if (pending > ring->mask + 1)
+    {
+      lost += pending - (ring->mask + 1);
+    }
+  return lost;
+}
+
+} // namespace ns3
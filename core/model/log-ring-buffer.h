@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_RING_BUFFER_H
+#define NS3_LOG_RING_BUFFER_H
+
+#include "log.h"
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogRingBuffer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ *
+ * \brief A binary in-memory sink for the NS_LOG_RECORD() messages.
+ *
+ * NS_LOG_RECORD() messages are made of a format string literal, in
+ * which each \c {} stands for an argument, and of up to MAX_ARGUMENTS
+ * numbers, pointers or string literals:
+ * \code
+ *   NS_LOG_RECORD (LOG_LOGIC, "Rx packet {} of {} bytes", p->GetUid (), p->GetSize ());
+ * \endcode
+ *
+ * Without a ring buffer, they are printed to \c std::clog like the
+ * other NS_LOG messages.  Once Enable() is called, they are instead
+ * stored in binary form, with the simulation time and context, into a
+ * fixed-size ring buffer which keeps the latest messages.  Storing a
+ * message takes no lock and does no formatting: the messages are only
+ * formatted by Flush(), for instance when something went wrong.  This
+ * makes it cheap to keep hot path messages enabled in long runs.
+ *
+ * Since the messages are formatted later, the string arguments must be
+ * string literals or otherwise outlive the ring buffer contents.
+ *
+ * Enable() and Disable() may be called while other threads log: the
+ * ring buffer they replace is not freed until the program exits, since
+ * those threads may still be writing to it.  Each call thus keeps the
+ * memory of the previous ring buffer.
+ */
+class LogRingBuffer
+{
+public:
+  /** The maximum number of arguments of a message. */
+  static const std::size_t MAX_ARGUMENTS = 6;
+
+  /** An argument of a message, with its type. */
+  struct Argument
+  {
+    /** The argument types. */
+    enum Type
+    {
+      NONE,     //!< No argument.
+      SIGNED,   //!< A signed integer.
+      UNSIGNED, //!< An unsigned integer.
+      DOUBLE,   //!< A floating point number.
+      STRING,   //!< A string literal.
+      POINTER   //!< A pointer.
+    };
+    /** The value, according to the type. */
+    union
+    {
+      int64_t i;       //!< A SIGNED value.
+      uint64_t u;      //!< An UNSIGNED value.
+      double d;        //!< A DOUBLE value.
+      const char *s;   //!< A STRING value.
+      const void *p;   //!< A POINTER value.
+    };
+    Type type;         //!< The type of the value.
+
+    /** Constructor: no argument. */
+    Argument () : u (0), type (NONE) {}
+  };
+
+  /**
+   * Function which gets the simulation time and context of a message.
+   *
+   * \param [out] time The simulation time, in time steps.
+   * \param [out] context The simulation context.
+   */
+  typedef void (*StampGetter)(int64_t *time, uint32_t *context);
+
+  /**
+   * Store the next messages into a ring buffer.
+   *
+   * \param [in] capacity The number of messages kept, rounded up to a
+   *             power of two.
+   */
+  static void Enable (std::size_t capacity);
+  /**
+   * Print the next messages immediately.  The messages held by the ring
+   * buffer are lost, and its memory is freed at exit.
+   */
+  static void Disable (void);
+  /**
+   * Check if the messages are stored into a ring buffer.
+   * \returns \c true if Enable() was called.
+   */
+  static bool IsEnabled (void);
+  /**
+   * Format the messages held by the ring buffer, in their order, and
+   * empty it.
+   *
+   * Messages stored while flushing may be skipped.
+   *
+   * \param [in,out] os The output stream.
+   * \returns The number of messages printed.
+   */
+  static std::size_t Flush (std::ostream &os);
+  /**
+   * Get the number of messages overwritten by newer ones since the
+   * ring buffer was enabled.
+   * \returns The number of lost messages.
+   */
+  static uint64_t GetOverwritten (void);
+  /**
+   * Set the function which gets the time and context of a message.
+   * The simulator sets it.
+   * \param [in] getter The function, or 0.
+   */
+  static void SetStampGetter (StampGetter getter);
+
+  /**
+   * Store a message.
+   *
+   * \param [in] component The log component.
+   * \param [in] level The log level.
+   * \param [in] format The format string literal.
+   * \param [in] args The arguments.
+   */
+  template <typename... Args>
+  static void Record (const LogComponent &component, enum LogLevel level,
+                      const char *format, Args... args);
+  /**
+   * Format a message.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] format The format string.
+   * \param [in] args The arguments.
+   */
+  template <typename... Args>
+  static void Format (std::ostream &os, const char *format, Args... args);
+
+private:
+  /**
+   * \name Argument conversions.
+   * Convert a message argument.
+   * \param [in] value The argument.
+   * \returns The Argument.
+   */
+  /**@{*/
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, Argument>::type
+  MakeArgument (T value)
+  {
+    Argument arg;
+    arg.type = Argument::SIGNED;
+    arg.i = value;
+    return arg;
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, Argument>::type
+  MakeArgument (T value)
+  {
+    Argument arg;
+    arg.type = Argument::UNSIGNED;
+    arg.u = value;
+    return arg;
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_enum<T>::value, Argument>::type
+  MakeArgument (T value)
+  {
+    Argument arg;
+    arg.type = Argument::SIGNED;
+    arg.i = static_cast<int64_t> (value);
+    return arg;
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value, Argument>::type
+  MakeArgument (T value)
+  {
+    Argument arg;
+    arg.type = Argument::DOUBLE;
+    arg.d = value;
+    return arg;
+  }
+  template <typename T>
+  static Argument
+  MakeArgument (const T *value)
+  {
+    Argument arg;
+    arg.type = Argument::POINTER;
+    arg.p = value;
+    return arg;
+  }
+  static Argument
+  MakeArgument (const char *value)
+  {
+    Argument arg;
+    arg.type = Argument::STRING;
+    arg.s = value;
+    return arg;
+  }
+  /**@}*/
+
+  /**
+   * Store a message.
+   *
+   * \param [in] component The log component.
+   * \param [in] level The log level.
+   * \param [in] format The format string literal.
+   * \param [in] args The arguments.
+   * \param [in] n The number of arguments.
+   */
+  static void DoRecord (const LogComponent &component, enum LogLevel level,
+                        const char *format, const Argument *args, std::size_t n);
+  /**
+   * Format a message.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] format The format string.
+   * \param [in] args The arguments.
+   * \param [in] n The number of arguments.
+   */
+  static void DoFormat (std::ostream &os, const char *format,
+                        const Argument *args, std::size_t n);
+};
+
+} // namespace ns3
+
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+template <typename... Args>
+void
+LogRingBuffer::Record (const LogComponent &component, enum LogLevel level,
+                       const char *format, Args... args)
+{
+  static_assert (sizeof... (Args) <= MAX_ARGUMENTS, "Too many NS_LOG_RECORD arguments");
+  const Argument arguments[sizeof... (Args) + 1] = { MakeArgument (args)..., Argument () };
+  DoRecord (component, level, format, arguments, sizeof... (Args));
+}
+
+template <typename... Args>
+void
+LogRingBuffer::Format (std::ostream &os, const char *format, Args... args)
+{
+  static_assert (sizeof... (Args) <= MAX_ARGUMENTS, "Too many NS_LOG_RECORD arguments");
+  const Argument arguments[sizeof... (Args) + 1] = { MakeArgument (args)..., Argument () };
+  DoFormat (os, format, arguments, sizeof... (Args));
+}
+
+} // namespace ns3
+
+#endif /* NS3_LOG_RING_BUFFER_H */
@@ -285,20 +285,6 @@ LogComponent::EnvVarCheck (void)
 #endif
 }
 
-
-bool 
-LogComponent::IsEnabled (const enum LogLevel level) const
-{
-  //  LogComponentEnableEnvVar ();
-  return (level & m_levels) ? 1 : 0;
-}
-
-bool
-LogComponent::IsNoneEnabled (void) const
-{
-  return m_levels == 0;
-}
-
 void
 LogComponent::SetMask (const enum LogLevel level)
 {
@@ -361,13 +361,13 @@ public:
    * \param [in] level The level to check for.
    * \return \c true if we are enabled at \c level.
    */
-  bool IsEnabled (const enum LogLevel level) const;
+  inline bool IsEnabled (const enum LogLevel level) const;
   /**
    * Check if all levels are disabled.
    *
    * \return \c true if all levels are disabled.
    */
-  bool IsNoneEnabled (void) const;
+  inline bool IsNoneEnabled (void) const;
   /**
    * Enable this LogComponent at \c level
    *
@@ -450,6 +450,18 @@ private:
  */
 LogComponent & GetLogComponent (const std::string name);
 
+bool
+LogComponent::IsEnabled (const enum LogLevel level) const
+{
+  return (level & m_levels) ? 1 : 0;
+}
+
+bool
+LogComponent::IsNoneEnabled (void) const
+{
+  return m_levels == 0;
+}
+
 /**
  * Insert `, ` when streaming function arguments.
  */
@@ -515,4 +527,7 @@ ParameterLogger::operator<< <const char *>(const char * param);
 
 /**@}*/  // \ingroup logging
 
+// Used by NS_LOG_RECORD.
+#include "log-ring-buffer.h"
+
 #endif /* NS3_LOG_H */
@@ -52,6 +52,10 @@ protected:
     {
       (*m_function)();
     }
+    virtual FunctionId GetFunctionId (void) const
+    {
+      return MakeFunctionId (m_function);
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
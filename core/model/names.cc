@@ -16,7 +16,10 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
@@ -37,75 +40,44 @@ NS_LOG_COMPONENT_DEFINE ("Names");
 /**
  * \ingroup config
  *  Node in the naming tree.
+ *
+ *  The children of the nodes are indexed by NamesPriv, with the
+ *  interned names.
  */
 class NameNode
 {
 public:
   /** Default constructor. */
   NameNode ();
-  /**
-   * Copy constructor.
-   *
-   * \param [in] nameNode The NameNode to copy from.
-   */
-  NameNode (const NameNode &nameNode);
   /**
    * Constructor.
    *
    * \param [in] parent The parent NameNode.
-   * \param [in] name The name of this NameNode
+   * \param [in] atom The interned name of this NameNode
    * \param [in] object The object corresponding to this NameNode.
    */
-  NameNode (NameNode *parent, std::string name, Ptr<Object> object);
-  /**
-   * Assignment operator.
-   *
-   * \param [in] rhs The NameNode to copy from.
-   * \returns The lhs NameNode.
-   */
-  NameNode &operator = (const NameNode &rhs);
+  NameNode (NameNode *parent, uint32_t atom, Ptr<Object> object);
 
   /** Destructor. */
   ~NameNode ();
 
   /** The parent NameNode. */
   NameNode *m_parent;
-  /** The name of this NameNode. */
-  std::string m_name;
+  /** The interned name of this NameNode. */
+  uint32_t m_atom;
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
-
-  /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_atom (0), m_object (0)
 {
 }
 
-NameNode::NameNode (const NameNode &nameNode)
+NameNode::NameNode (NameNode *parent, uint32_t atom, Ptr<Object> object)
+  : m_parent (parent), m_atom (atom), m_object (object)
 {
-  m_parent = nameNode.m_parent;
-  m_name = nameNode.m_name;
-  m_object = nameNode.m_object;
-  m_nameMap = nameNode.m_nameMap;
-}
-
-NameNode &
-NameNode::operator = (const NameNode &rhs)
-{
-  m_parent = rhs.m_parent;
-  m_name = rhs.m_name;
-  m_object = rhs.m_object;
-  m_nameMap = rhs.m_nameMap;
-  return *this;
-}
-
-NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
-  : m_parent (parent), m_name (name), m_object (object)
-{
-  NS_LOG_FUNCTION (this << parent << name << object);
+  NS_LOG_FUNCTION (this << parent << atom << object);
 }
 
 NameNode::~NameNode ()
@@ -157,6 +129,31 @@ public:
    * \return \c true if the object was named successfully.
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
+  /**
+   * Internal implementation for
+   * Names::Add(std::string,const std::vector<std::string>&,const std::vector<Ptr<Object> >&)
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves.
+   * \return \c true if all the objects were named successfully.
+   */
+  bool Add (std::string path, const std::vector<std::string> &names,
+            const std::vector<Ptr<Object> > &objects);
+  /**
+   * Internal implementation for
+   * Names::Add(Ptr<Object>,const std::vector<std::string>&,const std::vector<Ptr<Object> >&)
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves.
+   * \return \c true if all the objects were named successfully.
+   */
+  bool Add (Ptr<Object> context, const std::vector<std::string> &names,
+            const std::vector<Ptr<Object> > &objects);
 
   /**
    * Internal implementation for Names::Rename(std::string,std::string)
@@ -252,6 +249,44 @@ public:
 private:
   friend class Names;
 
+  /** The key of a child in the naming tree: its parent and its interned name. */
+  typedef std::pair<const NameNode *, uint32_t> ChildKey;
+
+  /** Hash a ChildKey. */
+  struct ChildKeyHash
+  {
+    /**
+     * \param [in] key The key to hash.
+     * \returns The hash of the key.
+     */
+    std::size_t operator () (const ChildKey &key) const
+    {
+      return std::hash<const NameNode *> () (key.first) ^ (key.second * 0x9e3779b9U);
+    }
+  };
+
+  /**
+   * Intern a name.
+   *
+   * \param [in] name The name.
+   * \returns The interned name.
+   */
+  uint32_t Intern (const std::string &name);
+  /**
+   * Get the string of an interned name.
+   *
+   * \param [in] atom The interned name.
+   * \returns The name.
+   */
+  const std::string &GetName (uint32_t atom) const;
+  /**
+   * Find a child of a NameNode.
+   *
+   * \param [in] node The parent node.
+   * \param [in] name The name of the child.
+   * \returns The child, or zero if it does not exist.
+   */
+  NameNode *FindChild (const NameNode *node, const std::string &name) const;
   /**
    * Check if an object has a name.
    *
@@ -267,12 +302,26 @@ private:
    * \returns \c true if \c name already exists as a child of \c node.
    */
   bool IsDuplicateName (NameNode *node, std::string name);
+  /**
+   * Get the NameNode of a context.
+   *
+   * \param [in] context The context object, or zero for the root.
+   * \returns The NameNode of the context, or zero if the context is
+   *          not named.
+   */
+  NameNode *GetContextNode (Ptr<Object> context);
 
   /** The root NameNode. */
   NameNode m_root;
 
+  /** Map from the names to their interned index. */
+  std::unordered_map<std::string, uint32_t> m_atoms;
+  /** The names, by interned index; they point to the keys of m_atoms. */
+  std::vector<const std::string *> m_atomNames;
+  /** Map from the parents and interned names to the NameNodes. */
+  std::unordered_map<ChildKey, NameNode *, ChildKeyHash> m_children;
   /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  std::unordered_map<const Object *, NameNode *> m_objectMap;
 };
 
 NamesPriv::NamesPriv ()
@@ -280,7 +329,7 @@ NamesPriv::NamesPriv ()
   NS_LOG_FUNCTION (this);
 
   m_root.m_parent = 0;
-  m_root.m_name = "Names";
+  m_root.m_atom = Intern ("Names");
   m_root.m_object = 0;
 }
 
@@ -288,7 +337,6 @@ NamesPriv::~NamesPriv ()
 {
   NS_LOG_FUNCTION (this);
   Clear ();
-  m_root.m_name = "";
 }
 
 void
@@ -299,18 +347,65 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_children.clear ();
+  m_atomNames.clear ();
+  m_atoms.clear ();
 
   m_root.m_parent = 0;
-  m_root.m_name = "Names";
+  m_root.m_atom = Intern ("Names");
   m_root.m_object = 0;
-  m_root.m_nameMap.clear ();
+}
+
+uint32_t
+NamesPriv::Intern (const std::string &name)
+{
+  std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> result =
+    m_atoms.insert (std::make_pair (name, m_atomNames.size ()));
+  if (result.second)
+    {
+      m_atomNames.push_back (&result.first->first);
+    }
+  return result.first->second;
+}
+
+const std::string &
+NamesPriv::GetName (uint32_t atom) const
+{
+  return *m_atomNames[atom];
+}
+
+NameNode *
+NamesPriv::FindChild (const NameNode *node, const std::string &name) const
+{
+  std::unordered_map<std::string, uint32_t>::const_iterator atom = m_atoms.find (name);
+  if (atom == m_atoms.end ())
+    {
+      return 0;
+    }
+  std::unordered_map<ChildKey, NameNode *, ChildKeyHash>::const_iterator i =
+    m_children.find (ChildKey (node, atom->second));
+  if (i == m_children.end ())
+    {
+      return 0;
+    }
+  return i->second;
+}
+
+NameNode *
+NamesPriv::GetContextNode (Ptr<Object> context)
+{
+  if (context == 0)
+    {
+      return &m_root;
+    }
+  return IsNamed (context);
 }
 
 bool
@@ -408,15 +503,80 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
       node = &m_root;
     }
 
-  if (IsDuplicateName (node, name))
+  //
+  // Reserve the name and check that it is not taken in a single lookup.
+  //
+  uint32_t atom = Intern (name);
+  std::pair<std::unordered_map<ChildKey, NameNode *, ChildKeyHash>::iterator, bool> child =
+    m_children.insert (std::make_pair (ChildKey (node, atom), (NameNode *)0));
+  if (!child.second)
     {
       NS_LOG_LOGIC ("Name is already taken");
       return false;
     }
 
-  NameNode *newNode = new NameNode (node, name, object);
-  node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  NameNode *newNode = new NameNode (node, atom, object);
+  child.first->second = newNode;
+  m_objectMap[PeekPointer (object)] = newNode;
+
+  return true;
+}
+
+bool
+NamesPriv::Add (std::string path, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << path << names.size ());
+  if (path == "/Names")
+    {
+      return Add (Ptr<Object> (0, false), names, objects);
+    }
+  return Add (Find (path), names, objects);
+}
+
+bool
+NamesPriv::Add (Ptr<Object> context, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << context << names.size ());
+
+  if (names.size () != objects.size ())
+    {
+      NS_LOG_LOGIC ("Not as many names as objects");
+      return false;
+    }
+
+  NameNode *node = GetContextNode (context);
+  NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
+
+  //
+  // Check all the associations before adding any, so that a failure
+  // leaves the name space unchanged.
+  //
+  std::unordered_set<std::string> newNames;
+  std::unordered_set<const Object *> newObjects;
+  for (uint32_t i = 0; i < names.size (); i++)
+    {
+      if (IsNamed (objects[i]) || !newObjects.insert (PeekPointer (objects[i])).second)
+        {
+          NS_LOG_LOGIC ("Object is already named");
+          return false;
+        }
+      if (IsDuplicateName (node, names[i]) || !newNames.insert (names[i]).second)
+        {
+          NS_LOG_LOGIC ("Name " << names[i] << " is already taken");
+          return false;
+        }
+    }
+
+  m_children.reserve (m_children.size () + names.size ());
+  m_objectMap.reserve (m_objectMap.size () + names.size ());
+  for (uint32_t i = 0; i < names.size (); i++)
+    {
+      NameNode *newNode = new NameNode (node, Intern (names[i]), objects[i]);
+      m_children[ChildKey (node, newNode->m_atom)] = newNode;
+      m_objectMap[PeekPointer (objects[i])] = newNode;
+    }
 
   return true;
 }
@@ -518,8 +678,8 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
-  if (i == node->m_nameMap.end ())
+  NameNode *changeNode = FindChild (node, oldname);
+  if (changeNode == 0)
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
       return false;
@@ -530,15 +690,13 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
 
       //
       // The rename process consists of:
-      // 1.  Getting the pointer to the name node from the map and remembering it;
-      // 2.  Removing the map entry corresponding to oldname from the map;
-      // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 1.  Removing the map entry corresponding to oldname from the map;
+      // 2.  Changing the interned name in the name node;
+      // 3.  Adding the name node back in the map under the newname.
       //
-      NameNode *changeNode = i->second;
-      node->m_nameMap.erase (i);
-      changeNode->m_name = newname;
-      node->m_nameMap[newname] = changeNode;
+      m_children.erase (ChildKey (node, changeNode->m_atom));
+      changeNode->m_atom = Intern (newname);
+      m_children[ChildKey (node, changeNode->m_atom)] = changeNode;
       return true;
     }
 }
@@ -548,8 +706,8 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
@@ -557,7 +715,7 @@ NamesPriv::FindName (Ptr<Object> object)
   else
     {
       NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      return GetName (node->m_atom);
     }
 }
 
@@ -566,25 +724,34 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (object);
+  if (p == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
-
+  //
+  // Collect the names up to the root, and join them from there.
+  //
+  std::vector<const std::string *> names;
+  std::string::size_type size = 0;
   do
     {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
+      names.push_back (&GetName (p->m_atom));
+      size += names.back ()->size () + 1;
     }
   while ((p = p->m_parent) != 0);
 
+  std::string path;
+  path.reserve (size);
+  for (std::vector<const std::string *>::reverse_iterator i = names.rbegin (); i != names.rend (); ++i)
+    {
+      path += "/";
+      path += **i;
+    }
+  NS_LOG_LOGIC ("path is " << path);
+
   return path;
 }
 
@@ -609,41 +776,43 @@ NamesPriv::Find (std::string path)
 
   NS_LOG_FUNCTION (this << path);
   std::string namespaceName = "/Names/";
-  std::string remaining;
+  std::string::size_type start;
 
-  std::string::size_type offset = path.find (namespaceName);
-  if (offset == 0)
+  if (path.compare (0, namespaceName.size (), namespaceName) == 0)
     {
       NS_LOG_LOGIC (path << " is a fully qualified name");
-      remaining = path.substr (namespaceName.size ());
+      start = namespaceName.size ();
     }
   else
     {
       NS_LOG_LOGIC (path << " begins with a relative name");
-      remaining = path;
+      start = 0;
     }
 
   NameNode *node = &m_root;
 
   //
-  // The string <remaining> is now composed entirely of path segments in
-  // the /Names name space and we have eaten the leading slash. e.g., 
-  // remaining = "ClientNode/eth0"
+  // The string <path> is now composed entirely of path segments in
+  // the /Names name space from <start>, where we have eaten the leading
+  // slash. e.g., path.substr (start) = "ClientNode/eth0"
   //
   // The start of the search is always at the root of the name space.
+  // Each segment is copied in the same string, to avoid allocations.
   //
+  std::string segment;
   for (;;)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
+      NS_LOG_LOGIC ("Looking for the object of name " << path.substr (start));
+      std::string::size_type offset = path.find ('/', start);
       if (offset == std::string::npos)
         {
           //
           // There are no remaining slashes so this is the last segment of the 
           // specified name.  We're done when we find it
           //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
+          segment.assign (path, start, std::string::npos);
+          NameNode *child = FindChild (node, segment);
+          if (child == 0)
             {
               NS_LOG_LOGIC ("Name does not exist in name map");
               return 0;
@@ -651,7 +820,7 @@ NamesPriv::Find (std::string path)
           else
             {
               NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
+              return child->m_object;
             }
         }
       else
@@ -660,19 +829,17 @@ NamesPriv::Find (std::string path)
           // There are more slashes so this is an intermediate segment of the 
           // specified name.  We need to "recurse" when we find this segment.
           //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
+          segment.assign (path, start, offset - start);
+          NameNode *child = FindChild (node, segment);
+          if (child == 0)
             {
               NS_LOG_LOGIC ("Name does not exist in name map");
               return 0;
             }
           else
             {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
+              node = child;
+              start = offset + 1;
               NS_LOG_LOGIC ("Intermediate segment parsed");
               continue;
             }
@@ -717,8 +884,8 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  NameNode *child = FindChild (node, name);
+  if (child == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return 0;
@@ -726,7 +893,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
   else
     {
       NS_LOG_LOGIC ("Name exists in name map");
-      return i->second->m_object;
+      return child->m_object;
     }
 }
 
@@ -735,7 +902,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -753,8 +920,7 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  if (FindChild (node, name) == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return false;
@@ -806,6 +972,24 @@ Names::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name << " under context " << &context);
 }
 
+void
+Names::Add (std::string path, const std::vector<std::string> &names,
+            const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (path << names.size ());
+  bool result = NamesPriv::Get ()->Add (path, names, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding " << names.size () << " names under " << path);
+}
+
+void
+Names::Add (Ptr<Object> context, const std::vector<std::string> &names,
+            const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (context << names.size ());
+  bool result = NamesPriv::Get ()->Add (context, names, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding " << names.size () << " names under context " << &context);
+}
+
 void
 Names::Rename (Ptr<Object> context, std::string oldname, std::string newname)
 {
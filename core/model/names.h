@@ -19,6 +19,8 @@
 #ifndef OBJECT_NAMES_H
 #define OBJECT_NAMES_H
 
+#include <string>
+#include <vector>
 #include "ptr.h"
 #include "object.h"
 
@@ -34,6 +36,10 @@ namespace ns3 {
  * \ingroup config
  * \brief A directory of name and Ptr<Object> associations that allows
  * us to give any ns3 Object a name.
+ *
+ * The names are interned, and the objects are found by hash lookups,
+ * by parent and name, and by object for the reverse lookups, so the
+ * cost of the operations does not grow with the number of names.
  */
 class Names
 {
@@ -171,6 +177,40 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Add the associations of many names and objects at once,
+   * under a path.
+   *
+   * The names are checked before any is added: either all of them are
+   * added, or the program aborts and none is. Naming the nodes and
+   * devices of a large topology this way also reserves the space of
+   * the indexes once.
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined,
+   *             or "/Names" for the root of the name space.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves, in
+   *             the same order as the names.
+   */
+  static void Add (std::string path, const std::vector<std::string> &names,
+                   const std::vector<Ptr<Object> > &objects);
+
+  /**
+   * \brief Add the associations of many names and objects at once,
+   * under a context.
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined, or zero for the root of the
+   *             name space.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves, in
+   *             the same order as the names.
+   */
+  static void Add (Ptr<Object> context, const std::vector<std::string> &names,
+                   const std::vector<Ptr<Object> > &objects);
+
   /**
    * \brief Rename a previously associated name.
    *
@@ -442,6 +442,18 @@ public:
    */
   inline static Time FromInteger (uint64_t value, enum Unit unit)
   {
+    if (IsDefaultResolution ())
+      {
+        if (unit <= NS)
+          {
+            value *= NS_FACTOR[unit];
+          }
+        else
+          {
+            value /= NS_FACTOR[unit];
+          }
+        return Time (value);
+      }
     struct Information *info = PeekInformation (unit);
     if (info->fromMul)
       {
@@ -455,6 +467,21 @@ public:
   }
   inline static Time FromDouble (double value, enum Unit unit)
   {
+    if (IsDefaultResolution () && unit <= NS)
+      {
+        // A whole number of units converts exactly with the int64x64_t
+        // path too, so this gives the same result.  When value is a
+        // constant, as in Seconds (1.0), this folds to a constant.
+        const double limit = static_cast<double> (std::numeric_limits<int64_t>::max () / NS_FACTOR[unit]);
+        if (value > -limit && value < limit)
+          {
+            const int64_t whole = static_cast<int64_t> (value);
+            if (whole == value)
+              {
+                return Time (whole * NS_FACTOR[unit]);
+              }
+          }
+      }
     return From (int64x64_t (value), unit);
   }
   inline static Time From (const int64x64_t & value, enum Unit unit)
@@ -490,6 +517,10 @@ public:
    */
   inline int64_t ToInteger (enum Unit unit) const
   {
+    if (IsDefaultResolution ())
+      {
+        return unit <= NS ? m_data / NS_FACTOR[unit] : m_data * NS_FACTOR[unit];
+      }
     struct Information *info = PeekInformation (unit);
     int64_t v = m_data;
     if (info->toMul)
@@ -583,6 +614,37 @@ private:
     return & (PeekResolution ()->info[timeUnit]);
   }
 
+  /**
+   *  Check if the current resolution is the default one, nanoseconds.
+   *
+   *  The conversions use NS_FACTOR rather than the Information records
+   *  in that case, so the compiler can fold the factor of a constant unit
+   *  and does not need the int64x64_t multipliers.
+   *
+   *  \return \c true if the current resolution is Time::NS.
+   */
+  static inline bool IsDefaultResolution (void)
+  {
+    return PeekResolution ()->unit == NS;
+  }
+  /**
+   *  Conversion factors with the default nanosecond resolution: the
+   *  number of nanoseconds per unit for the units down to Time::NS,
+   *  and the number of units per nanosecond for the finer ones.
+   */
+  static constexpr int64_t NS_FACTOR[LAST] = {
+    31536000000000000LL,  // Y
+    86400000000000LL,     // D
+    3600000000000LL,      // H
+    60000000000LL,        // MIN
+    1000000000LL,         // S
+    1000000LL,            // MS
+    1000LL,               // US
+    1LL,                  // NS
+    1000LL,               // PS
+    1000000LL             // FS
+  };
+
   /**
    *  Set the default resolution
    *
@@ -34,8 +34,11 @@
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
 #include "unused.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <mutex>
+#include <set>
 
 /**
  * \file
@@ -49,6 +52,27 @@ NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
+namespace {
+
+/** The existing streams, for RandomVariableStream::ResetAll(). */
+typedef std::set<RandomVariableStream *> StreamSet;
+
+/**
+ * Get the set of existing streams.
+ * \returns The set.
+ */
+StreamSet &
+GetStreams (void)
+{
+  static StreamSet streams;
+  return streams;
+}
+
+/** Protect the set of existing streams. */
+std::mutex g_streamsMutex;
+
+} // unnamed namespace
+
 TypeId 
 RandomVariableStream::GetTypeId (void)
 {
@@ -76,13 +100,44 @@ RandomVariableStream::RandomVariableStream()
   : m_rng (0)
 {
   NS_LOG_FUNCTION (this);
+  std::lock_guard<std::mutex> lock (g_streamsMutex);
+  GetStreams ().insert (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (g_streamsMutex);
+    GetStreams ().erase (this);
+  }
   delete m_rng;
 }
 
+void
+RandomVariableStream::ResetAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t seed = RngSeedManager::GetSeed ();
+  uint64_t run = RngSeedManager::GetRun ();
+  std::lock_guard<std::mutex> lock (g_streamsMutex);
+  for (StreamSet::const_iterator i = GetStreams ().begin (); i != GetStreams ().end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng != 0)
+        {
+          delete stream->m_rng;
+          stream->m_rng = new RngStream (seed, stream->m_rngStreamIndex, run);
+        }
+      stream->DoReset ();
+    }
+}
+
+void
+RandomVariableStream::DoReset (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
@@ -111,6 +166,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
+      m_rngStreamIndex = nextStream;
     }
   else
     {
@@ -121,6 +177,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
+      m_rngStreamIndex = target;
     }
   m_stream = stream;
 }
@@ -138,6 +195,16 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -208,6 +275,29 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  double min = m_min;
+  double max = m_max;
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; i++)
+        {
+          double v = min + values[i] * (max - min);
+          values[i] = min + (max - v);
+        }
+    }
+  else
+    {
+      for (std::size_t i = 0; i < n; i++)
+        {
+          values[i] = min + values[i] * (max - min);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -263,6 +353,12 @@ ConstantRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_constant);
 }
+void
+ConstantRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  std::fill (values, values + n, m_constant);
+}
 
 NS_OBJECT_ENSURE_REGISTERED(SequentialRandomVariable);
 
@@ -445,6 +541,33 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  // Each value needs at least one uniform number, so draw as many
+  // uniform numbers as missing values into the free end of the output,
+  // and transform them in place.  A value beyond the bound is rejected
+  // as in GetValue (double, double), and the missing ones drawn again.
+  std::size_t done = 0;
+  while (done < n)
+    {
+      Peek ()->RandU01 (values + done, n - done);
+      for (std::size_t i = done; i < n; i++)
+        {
+          double v = values[i];
+          if (IsAntithetic ())
+            {
+              v = (1 - v);
+            }
+          double r = -m_mean*std::log (v);
+          if (m_bound == 0 || r <= m_bound)
+            {
+              values[done++] = r;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -694,6 +817,13 @@ NormalRandomVariable::NormalRandomVariable ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+NormalRandomVariable::DoReset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 double 
 NormalRandomVariable::GetMean (void) const
 {
@@ -778,6 +908,62 @@ NormalRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
+void
+NormalRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  // Each pair of uniform numbers gives at most two values, so drawing
+  // one pair per two missing values never draws more uniform numbers
+  // than GetValue (double, double, double) would.
+  const std::size_t maxPairs = 64;
+  double u[2 * maxPairs];
+  std::size_t done = 0;
+  while (done < n)
+    {
+      if (m_nextValid)
+        { // use previously generated
+          m_nextValid = false;
+          values[done++] = m_next;
+          continue;
+        }
+      std::size_t pairs = std::min ((n - done + 1) / 2, maxPairs);
+      Peek ()->RandU01 (u, 2 * pairs);
+      for (std::size_t i = 0; i < pairs; i++)
+        {
+          if (m_nextValid)
+            {
+              m_nextValid = false;
+              values[done++] = m_next;
+            }
+          double u1 = u[2 * i];
+          double u2 = u[2 * i + 1];
+          if (IsAntithetic ())
+            {
+              u1 = (1 - u1);
+              u2 = (1 - u2);
+            }
+          double v1 = 2 * u1 - 1;
+          double v2 = 2 * u2 - 1;
+          double w = v1 * v1 + v2 * v2;
+          if (w <= 1.0)
+            { // Got good pair
+              double y = std::sqrt ((-2 * std::log (w)) / w);
+              m_next = m_mean + v2 * y * std::sqrt (m_variance);
+              m_nextValid = std::fabs (m_next - m_mean) <= m_bound;
+              double x1 = m_mean + v1 * y * std::sqrt (m_variance);
+              if (std::fabs (x1 - m_mean) <= m_bound)
+                {
+                  values[done++] = x1;
+                }
+              else if (m_nextValid)
+                {
+                  m_nextValid = false;
+                  values[done++] = m_next;
+                }
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
@@ -928,6 +1114,13 @@ GammaRandomVariable::GammaRandomVariable ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+GammaRandomVariable::DoReset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 double 
 GammaRandomVariable::GetAlpha (void) const
 {
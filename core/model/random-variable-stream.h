@@ -30,6 +30,7 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <cstddef>
 
 /**
  * \file
@@ -149,12 +150,50 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next random values drawn from the distribution.
+   *
+   * The values are those of \p n successive calls to GetValue(void),
+   * in the same order, and the stream is left in the same state.
+   * The default implementation just calls GetValue(void); the
+   * distributions which can draw a batch of uniform numbers at once
+   * override it.
+   *
+   * \param [out] values The random values.
+   * \param [in] n The number of values.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
+  /**
+   * \brief Restart all the existing streams with the current seed and
+   * run number.
+   *
+   * The seed and run number only apply to the streams created after
+   * they are set. This function gives every existing stream the state
+   * it would have had if it had been created with the current
+   * RngSeedManager seed and run, keeping its stream number. It lets a
+   * program build its topology once, then run several independent
+   * replications of it, as the ReplicationRunner does.
+   *
+   * The state which the streams derive from the values already drawn
+   * is discarded too, see DoReset().
+   */
+  static void ResetAll (void);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
    * \return The underlying RngStream
    */
   RngStream *Peek(void) const;
+  /**
+   * \brief Discard the state derived from the values already drawn.
+   *
+   * Called by ResetAll() for each stream. The subclasses which keep
+   * values for later calls, such as the second value of a pair, must
+   * override it, so that a restarted stream does not return them.
+   */
+  virtual void DoReset (void);
 
 private:
   /**
@@ -187,6 +226,9 @@ private:
   /** The stream number for the RngStream. */
   int64_t m_stream;
 
+  /** The index of the underlying RngStream, even if automatic. */
+  uint64_t m_rngStreamIndex;
+
 };  // class RandomVariableStream
 
   
@@ -294,6 +336,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -353,6 +396,7 @@ public:
   virtual double GetValue (void);
   /* \note This RNG always returns the same value. */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The constant value returned by this RNG stream. */
@@ -586,6 +630,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -1233,6 +1278,11 @@ public:
    * which now involves the distances \f$u1\f$ and \f$u2\f$ are from 1.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
+
+protected:
+  /** Discard the cached second value of the pair. */
+  virtual void DoReset (void);
 
 private:
   /** The mean value for the normal distribution returned by this RNG stream. */
@@ -1593,6 +1643,10 @@ public:
    */
   virtual uint32_t GetInteger (void);
 
+protected:
+  /** Discard the cached second normal value of the pair. */
+  virtual void DoReset (void);
+
 private:
   /**
    * \brief Returns a random double from a normal distribution with the specified mean, variance, and bound.
@@ -322,37 +322,36 @@ void PowerOfTwoMatrix (int n, Matrix a1p, Matrix a2p)
     }
 }
 
-} // namespace MRG32k3a
-
-
-namespace ns3 {
-
-using namespace MRG32k3a;
-  
-double RngStream::RandU01 ()
+/**
+ * Advance the MRG32k3a state by one step.
+ *
+ * \param [in,out] state The state vector.
+ * \returns The next random, uniformly distributed between 0 and 1.
+ */
+inline double NextU01 (double state[6])
 {
   int32_t k;
   double p1, p2, u;
 
   /* Component 1 */
-  p1 = a12 * m_currentState[1] - a13n * m_currentState[0];
+  p1 = a12 * state[1] - a13n * state[0];
   k = static_cast<int32_t> (p1 / m1);
   p1 -= k * m1;
   if (p1 < 0.0)
     {
       p1 += m1;
     }
-  m_currentState[0] = m_currentState[1]; m_currentState[1] = m_currentState[2]; m_currentState[2] = p1;
+  state[0] = state[1]; state[1] = state[2]; state[2] = p1;
 
   /* Component 2 */
-  p2 = a21 * m_currentState[5] - a23n * m_currentState[3];
+  p2 = a21 * state[5] - a23n * state[3];
   k = static_cast<int32_t> (p2 / m2);
   p2 -= k * m2;
   if (p2 < 0.0)
     {
       p2 += m2;
     }
-  m_currentState[3] = m_currentState[4]; m_currentState[4] = m_currentState[5]; m_currentState[5] = p2;
+  state[3] = state[4]; state[4] = state[5]; state[5] = p2;
 
   /* Combination */
   u = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
@@ -360,6 +359,37 @@ double RngStream::RandU01 ()
   return u;
 }
 
+} // namespace MRG32k3a
+
+
+namespace ns3 {
+
+using namespace MRG32k3a;
+  
+double RngStream::RandU01 ()
+{
+  return NextU01 (m_currentState);
+}
+
+void RngStream::RandU01 (double *values, std::size_t n)
+{
+  // Work on a local copy of the state, which the compiler can keep in
+  // registers for the whole block.
+  double state[6];
+  for (int i = 0; i < 6; ++i)
+    {
+      state[i] = m_currentState[i];
+    }
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = NextU01 (state);
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = state[i];
+    }
+}
+
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
 {
   if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
@@ -19,6 +19,7 @@
 
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
+#include <cstddef>
 #include <string>
 #include <stdint.h>
 
@@ -70,6 +71,14 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream, in the
+   * same order as \p n calls to RandU01(void).
+   *
+   * \param [out] values The random numbers.
+   * \param [in] n The number of random numbers.
+   */
+  void RandU01 (double *values, std::size_t n);
 
 private:
   /**
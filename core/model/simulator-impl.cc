@@ -42,4 +42,22 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+uint64_t
+SimulatorImpl::GetEventCount (void) const
+{
+  return 0;
+}
+
+uint64_t
+SimulatorImpl::GetCancelledEventCount (void) const
+{
+  return 0;
+}
+
+uint64_t
+SimulatorImpl::GetCompactionCount (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -99,6 +99,24 @@ public:
   virtual uint32_t GetSystemId () const = 0; 
   /** \copydoc Simulator::GetContext */
   virtual uint32_t GetContext (void) const = 0;
+  /**
+   * \copydoc Simulator::GetEventCount
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint64_t GetEventCount (void) const;
+  /**
+   * \copydoc Simulator::GetCancelledEventCount
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint64_t GetCancelledEventCount (void) const;
+  /**
+   * \copydoc Simulator::GetCompactionCount
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint64_t GetCompactionCount (void) const;
 };
 
 } // namespace ns3
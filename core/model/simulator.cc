@@ -132,6 +132,19 @@ NodePrinter (std::ostream &os)
     }
 }
 
+/**
+ * \ingroup logging
+ * Default time and context getter of the LogRingBuffer.
+ * \param [out] time The simulation time step.
+ * \param [out] context The simulation context.
+ */
+static void
+StampGetter (int64_t *time, uint32_t *context)
+{
+  *time = Simulator::Now ().GetTimeStep ();
+  *context = Simulator::GetContext ();
+}
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -182,6 +195,7 @@ static SimulatorImpl * GetImpl (void)
 //
       LogSetTimePrinter (&TimePrinter);
       LogSetNodePrinter (&NodePrinter);
+      LogRingBuffer::SetStampGetter (&StampGetter);
     }
   return *pimpl;
 }
@@ -203,6 +217,7 @@ Simulator::Destroy (void)
    */
   LogSetTimePrinter (0);
   LogSetNodePrinter (0);
+  LogRingBuffer::SetStampGetter (0);
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
@@ -374,6 +389,27 @@ Simulator::GetMaximumSimulationTime (void)
   return GetImpl ()->GetMaximumSimulationTime ();
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetEventCount ();
+}
+
+uint64_t
+Simulator::GetCancelledEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetCancelledEventCount ();
+}
+
+uint64_t
+Simulator::GetCompactionCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetCompactionCount ();
+}
+
 uint32_t
 Simulator::GetContext (void)
 {
@@ -419,6 +455,7 @@ Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 //
   LogSetTimePrinter (&TimePrinter);
   LogSetNodePrinter (&NodePrinter);
+  LogRingBuffer::SetStampGetter (&StampGetter);
 }
 
 Ptr<SimulatorImpl>
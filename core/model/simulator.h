@@ -1208,6 +1208,10 @@ public:
    * Note that it is not possible to remove events which were scheduled
    * for the "destroy" time. Doing so will result in a program error (crash).
    *
+   * The DefaultSimulatorImpl can be configured to remove events lazily,
+   * with its LazyRemove attribute: the event is then only cancelled,
+   * and purged later together with the other cancelled events.
+   *
    * @param [in] id The event to remove from the list of scheduled events.
    */
   static void Remove (const EventId &id);
@@ -1270,6 +1274,33 @@ public:
    */
   static Time GetMaximumSimulationTime (void);
 
+  /**
+   * Get the number of events in the event list which have not been
+   * cancelled.
+   *
+   * @return The number of live events.
+   */
+  static uint64_t GetEventCount (void);
+
+  /**
+   * Get the number of cancelled events still in the event list.
+   *
+   * Cancelled events, and removed events when the simulator
+   * implementation removes lazily, stay in the event list until they
+   * expire or until the event list is compacted.
+   *
+   * @return The number of cancelled events in the event list.
+   */
+  static uint64_t GetCancelledEventCount (void);
+
+  /**
+   * Get the number of times the cancelled events were purged from
+   * the event list.
+   *
+   * @return The number of compactions of the event list.
+   */
+  static uint64_t GetCompactionCount (void);
+
   /**
    * Schedule a future event execution (in the same context).
    *
@@ -42,6 +42,9 @@ NS_LOG_COMPONENT_DEFINE_MASK ("Time", ns3::LOG_PREFIX_TIME);
 // static
 Time::MarkedTimes * Time::g_markingTimes = 0;
 
+// static
+constexpr int64_t Time::NS_FACTOR[Time::LAST];
+
 /**
  * \internal
  * Get mutex for critical sections around modification of Time::g_markingTimes
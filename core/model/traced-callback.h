@@ -21,8 +21,10 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
+#include "ptr.h"
+#include "simple-ref-count.h"
 
 /**
  * \file
@@ -44,7 +46,14 @@ namespace ns3 {
  *
  * This is a functor: the chain of Callbacks is invoked by
  * calling one of the \c operator() forms with the appropriate
- * number of arguments.
+ * number of arguments. Firing a TracedCallback which has no
+ * Callback connected only tests a pointer; the caller can also test
+ * IsEmpty() to avoid building expensive arguments.
+ *
+ * The chain is stored contiguously and shared with the calls in
+ * progress and the copies of the TracedCallback: it is copied when it
+ * is modified while shared, so that a Callback can connect or
+ * disconnect Callbacks while the chain is invoked.
  *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
@@ -93,6 +102,15 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether any Callback is connected.
+   *
+   * Trace sources whose arguments are expensive to build can test
+   * this before building them.
+   *
+   * \return \c true if the chain of Callbacks is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -108,7 +126,7 @@ public:
    * \tparam T1 \deduced Type of the first argument to the functor.
    * \param [in] a1 The first argument to the functor.
    */
-  void operator() (T1 a1) const;
+  void operator() (T1 const &a1) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -116,7 +134,7 @@ public:
    * \param [in] a1 The first argument to the functor.
    * \param [in] a2 The second argument to the functor.
    */
-  void operator() (T1 a1, T2 a2) const;
+  void operator() (T1 const &a1, T2 const &a2) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -126,7 +144,7 @@ public:
    * \param [in] a2 The second argument to the functor.
    * \param [in] a3 The third argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -138,7 +156,7 @@ public:
    * \param [in] a3 The third argument to the functor.
    * \param [in] a4 The fourth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -152,7 +170,7 @@ public:
    * \param [in] a4 The fourth argument to the functor.
    * \param [in] a5 The fifth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -168,7 +186,7 @@ public:
    * \param [in] a5 The fifth argument to the functor.
    * \param [in] a6 The sixth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -186,7 +204,7 @@ public:
    * \param [in] a6 The sixth argument to the functor.
    * \param [in] a7 The seventh argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6, T7 const &a7) const;
   /**
    * \copybrief operator()()
    * \tparam T1 \deduced Type of the first argument to the functor.
@@ -206,7 +224,7 @@ public:
    * \param [in] a7 The seventh argument to the functor.
    * \param [in] a8 The eighth argument to the functor.
    */
-  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
+  void operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6, T7 const &a7, T8 const &a8) const;
   /**@}*/
 
   /**
@@ -234,9 +252,23 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /** The chain of Callbacks, shared by the calls in progress and the copies. */
+  class CallbackChain : public SimpleRefCount<CallbackChain>
+  {
+  public:
+    CallbackList m_callbacks;           //!< the Callbacks, in connection order
+  };
+  /**
+   * Get the chain of Callbacks, for modification.
+   *
+   * The chain is created if needed, and copied if shared.
+   *
+   * \return The Callbacks of the chain.
+   */
+  CallbackList & GetWritableCallbacks (void);
+  /** The chain of Callbacks, or zero if no Callback is connected. */
+  Ptr<CallbackChain> m_chain;
 };
 
 } // namespace ns3
@@ -253,8 +285,25 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_chain () 
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+typename TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::CallbackList &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::GetWritableCallbacks (void)
 {
+  if (m_chain == 0)
+    {
+      m_chain = Create<CallbackChain> ();
+    }
+  else if (m_chain->GetReferenceCount () > 1)
+    {
+      m_chain = Create<CallbackChain> (*m_chain);
+    }
+  return m_chain->m_callbacks;
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -266,7 +315,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  GetWritableCallbacks ().push_back (cb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -279,7 +328,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  GetWritableCallbacks ().push_back (realCb);
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -288,18 +337,27 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  if (m_chain == 0)
     {
-      if ((*i).IsEqual (callback))
-        {
-          i = m_callbackList.erase (i);
-        }
-      else
+      return;
+    }
+  CallbackList remaining;
+  for (typename CallbackList::const_iterator i = m_chain->m_callbacks.begin ();
+       i != m_chain->m_callbacks.end (); i++)
+    {
+      if (!(*i).IsEqual (callback))
         {
-          i++;
+          remaining.push_back (*i);
         }
     }
+  if (remaining.empty ())
+    {
+      m_chain = 0;
+    }
+  else if (remaining.size () != m_chain->m_callbacks.size ())
+    {
+      GetWritableCallbacks ().swap (remaining);
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -314,6 +372,15 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_chain == 0;
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
@@ -321,8 +388,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)();
     }
@@ -332,10 +404,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1);
     }
@@ -345,10 +422,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2);
     }
@@ -358,10 +440,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3);
     }
@@ -371,10 +458,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4);
     }
@@ -384,10 +476,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5);
     }
@@ -397,10 +494,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6);
     }
@@ -410,10 +512,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6, T7 const &a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6, a7);
     }
@@ -423,10 +530,15 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 const &a1, T2 const &a2, T3 const &a3, T4 const &a4, T5 const &a5, T6 const &a6, T7 const &a7, T8 const &a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  Ptr<const CallbackChain> chain = m_chain;
+  for (typename CallbackList::const_iterator i = chain->m_callbacks.begin ();
+       i != chain->m_callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
     }
@@ -24,6 +24,8 @@
 #include "trace-source-accessor.h"
 
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -53,6 +55,12 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * Information records are stored in a vector.  Name and hash lookup
  * are performed by maps to the vector index.
  *
+ * Attribute and TraceSource lookup by name use a flattened hash index
+ * per type id, which includes the inherited entries.  The indexes are
+ * built on the first lookup, and rebuilt after new attributes, trace
+ * sources or parents are registered, which usually happens only while
+ * the type ids are being registered.
+ *
  * \internal
  * <b>Hash Chaining</b>
  *
@@ -78,6 +86,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -229,6 +239,16 @@ public:
    * \returns The information associated to attribute whose index is \p i.
    */
   struct TypeId::AttributeInformation GetAttribute(uint16_t uid, uint32_t i) const;
+  /**
+   * Find an Attribute by name, including the inherited ones.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] info The information about the Attribute, if found.
+   * \returns \c true if \p uid or one of its parents has the
+   *          Attribute \p name.
+   */
+  bool FindAttribute (uint16_t uid, const std::string &name,
+                      struct TypeId::AttributeInformation *info);
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -264,6 +284,16 @@ public:
    * \returns Detailed information about the requested trace source.
    */
   struct TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
+  /**
+   * Find a TraceSource by name, including the inherited ones.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \param [out] info The information about the TraceSource, if found.
+   * \returns \c true if \p uid or one of its parents has the
+   *          TraceSource \p name.
+   */
+  bool FindTraceSource (uint16_t uid, const std::string &name,
+                        struct TypeId::TraceSourceInformation *info);
   /**
    * Check if this TypeId should not be listed in documentation.
    * \param [in] uid The id.
@@ -293,6 +323,16 @@ private:
    */
   static TypeId::hash_t Hasher (const std::string name);
 
+  /** The position of an Attribute or TraceSource in the records. */
+  struct IndexEntry {
+    /** The id which registered the entry. */
+    uint16_t uid;
+    /** The index of the entry in the container of this id. */
+    uint32_t i;
+  };
+  /** Type of the flattened Attribute and TraceSource indexes. */
+  typedef std::unordered_map<std::string, struct IndexEntry> index_t;
+
   /** The information record about a single type id. */
   struct IidInformation {
     /** The type id name. */
@@ -319,6 +359,12 @@ private:
     TypeId::SupportLevel supportLevel;
     /** Support message. */
     std::string supportMsg;
+    /** The Attributes of this type id and its parents, by name. */
+    index_t attributeIndex;
+    /** The TraceSources of this type id and its parents, by name. */
+    index_t traceSourceIndex;
+    /** The value of m_generation when the indexes were built. */
+    uint32_t indexGeneration;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -329,6 +375,13 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  /**
+   * Build the Attribute and TraceSource indexes of a type, if they
+   * are out of date.  Must be called with m_indexMutex held.
+   * \param [in] uid The id.
+   * \returns The information record.
+   */
+  struct IidManager::IidInformation *UpdateIndexes (uint16_t uid);
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
@@ -343,6 +396,15 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /**
+   * The registration generation, incremented when an Attribute, a
+   * TraceSource or a parent is registered, to invalidate the flattened
+   * indexes.
+   */
+  uint32_t m_generation;
+  /** Serialize the Attribute and TraceSource lookups. */
+  std::mutex m_indexMutex;
+
 
   /** IidManager constants. */
   enum {
@@ -378,6 +440,12 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+IidManager::IidManager ()
+  : m_generation (1)
+{
+  NS_LOG_FUNCTION (IID);
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
@@ -439,6 +507,7 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
@@ -466,6 +535,7 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  m_generation++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -675,6 +745,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  m_generation++;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void 
@@ -709,6 +780,64 @@ IidManager::GetAttribute(uint16_t uid, uint32_t i) const
   return information->attributes[i];
 }
 
+struct IidManager::IidInformation *
+IidManager::UpdateIndexes (uint16_t uid)
+{
+  NS_LOG_FUNCTION (IID << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == m_generation)
+    {
+      return information;
+    }
+  information->attributeIndex.clear ();
+  information->traceSourceIndex.clear ();
+  // Walk up from the type itself, so that the first entry found for a
+  // name, which insert () keeps, is the one LookupAttributeByName and
+  // LookupTraceSourceByName have always returned.
+  while (true)
+    {
+      struct IidInformation *current = LookupInformation (uid);
+      for (uint32_t i = 0; i < current->attributes.size (); i++)
+        {
+          struct IndexEntry entry = { uid, i };
+          information->attributeIndex.insert (std::make_pair (current->attributes[i].name, entry));
+        }
+      for (uint32_t i = 0; i < current->traceSources.size (); i++)
+        {
+          struct IndexEntry entry = { uid, i };
+          information->traceSourceIndex.insert (std::make_pair (current->traceSources[i].name, entry));
+        }
+      if (current->parent == uid)
+        {
+          // top of inheritance tree
+          break;
+        }
+      uid = current->parent;
+    }
+  information->indexGeneration = m_generation;
+  NS_LOG_LOGIC (IIDL << information->attributeIndex.size () << " attributes, "
+                << information->traceSourceIndex.size () << " trace sources");
+  return information;
+}
+
+bool
+IidManager::FindAttribute (uint16_t uid, const std::string &name,
+                           struct TypeId::AttributeInformation *info)
+{
+  NS_LOG_FUNCTION (IID << uid << name << info);
+  std::lock_guard<std::mutex> lock (m_indexMutex);
+  struct IidInformation *information = UpdateIndexes (uid);
+  index_t::const_iterator it = information->attributeIndex.find (name);
+  if (it == information->attributeIndex.end ())
+    {
+      NS_LOG_LOGIC (IIDL << false);
+      return false;
+    }
+  *info = LookupInformation (it->second.uid)->attributes[it->second.i];
+  NS_LOG_LOGIC (IIDL << true);
+  return true;
+}
+
 bool
 IidManager::HasTraceSource (uint16_t uid,
                             std::string name)
@@ -766,6 +895,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.supportLevel = supportLevel;
   source.supportMsg = supportMsg;
   information->traceSources.push_back (source);
+  m_generation++;
   NS_LOG_LOGIC (IIDL << information->traceSources.size () - 1);
 }
 uint32_t 
@@ -786,6 +916,24 @@ IidManager::GetTraceSource(uint16_t uid, uint32_t i) const
   NS_LOG_LOGIC (IIDL << information->name);
   return information->traceSources[i];
 }
+
+bool
+IidManager::FindTraceSource (uint16_t uid, const std::string &name,
+                             struct TypeId::TraceSourceInformation *info)
+{
+  NS_LOG_FUNCTION (IID << uid << name << info);
+  std::lock_guard<std::mutex> lock (m_indexMutex);
+  struct IidInformation *information = UpdateIndexes (uid);
+  index_t::const_iterator it = information->traceSourceIndex.find (name);
+  if (it == information->traceSourceIndex.end ())
+    {
+      NS_LOG_LOGIC (IIDL << false);
+      return false;
+    }
+  *info = LookupInformation (it->second.uid)->traceSources[it->second.i];
+  NS_LOG_LOGIC (IIDL << true);
+  return true;
+}
 bool 
 IidManager::MustHideFromDocumentation (uint16_t uid) const
 {
@@ -876,38 +1024,24 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  struct TypeId::AttributeInformation tmp;
+  if (!IidManager::Get ()->FindAttribute (m_tid, name, &tmp))
+    {
+      return false;
+    }
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp.supportMsg);
+    }
+  *info = tmp;
+  return true;
 }
 
 TypeId 
@@ -1136,39 +1270,24 @@ TypeId::LookupTraceSourceByName (std::string name,
                                  struct TraceSourceInformation *info) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
   struct TypeId::TraceSourceInformation tmp;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          tmp = tid.GetTraceSource (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                   return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "TraceSource '" << name << "' is deprecated: "
-                                 << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else  if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("TraceSource '" << name
-                                  << "' is obsolete, with no fallback: "
-                                  << tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  if (!IidManager::Get ()->FindTraceSource (m_tid, name, &tmp))
+    {
+      return 0;
+    }
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "TraceSource '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("TraceSource '" << name
+                      << "' is obsolete, with no fallback: "
+                      << tmp.supportMsg);
+    }
+  *info = tmp;
+  return tmp.accessor;
 }
 
 Ptr<const TraceSourceAccessor> 
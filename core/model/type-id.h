@@ -478,6 +478,9 @@ public:
   /**
    * Find an Attribute by name, retrieving the associated AttributeInformation.
    *
+   * The attributes of this TypeId and of its parents are looked up
+   * in a hash index, built once after they are registered.
+   *
    * \param [in]  name The name of the requested attribute
    * \param [in,out] info A pointer to the TypeId::AttributeInformation
    *              data structure where the result value of this method
@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/callback.h"
 #include <stdint.h>
+#include <string>
 
 using namespace ns3;
 
@@ -557,6 +558,119 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the callbacks whose implementation is stored inline, and the
+// ownership of the objects they hold
+// ===========================================================================
+class CallbackTestCounter : public SimpleRefCount<CallbackTestCounter>
+{
+public:
+  CallbackTestCounter () : m_sum (0) {}
+  int Add (int a) { m_sum += a; return m_sum; }
+  int m_sum;
+};
+
+int CallbackTestBoundAdd (Ptr<CallbackTestCounter> counter, int a)
+{
+  return counter->Add (a);
+}
+
+int CallbackTestBoundStrings (std::string a, std::string b, std::string c, int d)
+{
+  return static_cast<int> (a.size () + b.size () + c.size ()) + d;
+}
+
+class InlineCallbackTestCase : public TestCase
+{
+public:
+  InlineCallbackTestCase ();
+  virtual ~InlineCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+InlineCallbackTestCase::InlineCallbackTestCase ()
+  : TestCase ("Check the copies of inline and allocated callbacks")
+{
+}
+
+void
+InlineCallbackTestCase::DoRun (void)
+{
+  Ptr<CallbackTestCounter> counter = Create<CallbackTestCounter> ();
+  {
+    //
+    // Each copy of a member function callback holds its own reference
+    // to the object.
+    //
+    Callback<int,int> cb = MakeCallback (&CallbackTestCounter::Add, counter);
+    NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 2, "Callback does not hold the object");
+    Callback<int,int> copy = cb;
+    NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 3, "Copy does not hold the object");
+    NS_TEST_ASSERT_MSG_EQ (cb (1), 1, "Callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (copy (2), 3, "Copy did not fire");
+    NS_TEST_ASSERT_MSG_EQ (cb.IsEqual (copy), true, "Copy is not equal to its original");
+
+    //
+    // The implementation is kept when the callback is sliced and
+    // assigned back.
+    //
+    CallbackBase base = copy;
+    copy.Nullify ();
+    NS_TEST_ASSERT_MSG_EQ (copy.IsNull (), true, "Nullified Callback reports not IsNull()");
+    NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 3, "Nullify did not release the object");
+    Callback<int,int> assigned;
+    NS_TEST_ASSERT_MSG_EQ (assigned.Assign (base), true, "Assign failed");
+    NS_TEST_ASSERT_MSG_EQ (assigned (3), 6, "Assigned callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (assigned.IsEqual (cb), true, "Assigned callback is not equal to its original");
+    assigned = assigned;
+    NS_TEST_ASSERT_MSG_EQ (assigned (0), 6, "Self-assigned callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 4, "Assigned callback does not hold the object");
+
+    Callback<int,int> other = MakeCallback (&CallbackTestCounter::Add, Create<CallbackTestCounter> ());
+    NS_TEST_ASSERT_MSG_EQ (other.IsEqual (cb), false, "Callbacks to different objects are equal");
+    other = cb;
+    NS_TEST_ASSERT_MSG_EQ (other.IsEqual (cb), true, "Assigned callback is not equal to its original");
+  }
+  NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 1, "Callbacks did not release the object");
+
+  //
+  // The implementation returned by GetImpl outlives the callback.
+  //
+  Ptr<CallbackImplBase> impl;
+  {
+    Callback<int,int> cb = MakeCallback (&CallbackTestCounter::Add, counter);
+    impl = cb.GetImpl ();
+  }
+  NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 2, "Implementation does not hold the object");
+  Callback<int,int> fromImpl (DynamicCast<CallbackImpl<int,int,empty,empty,empty,empty,empty,empty,empty,empty> > (impl));
+  NS_TEST_ASSERT_MSG_EQ (fromImpl (4), 10, "Callback built from an implementation did not fire");
+  impl = 0;
+  fromImpl.Nullify ();
+  NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 1, "Implementation did not release the object");
+
+  //
+  // Bound callbacks, small and large.
+  //
+  {
+    Callback<int,int> bound = MakeBoundCallback (&CallbackTestBoundAdd, counter);
+    Callback<int,int> copy = bound;
+    NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 3, "Bound callbacks do not hold the object");
+    NS_TEST_ASSERT_MSG_EQ (copy (5), 15, "Bound callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (copy.IsEqual (bound), true, "Copy is not equal to its original");
+  }
+  NS_TEST_ASSERT_MSG_EQ (counter->GetReferenceCount (), 1, "Bound callbacks did not release the object");
+
+  Callback<int,int> large = MakeBoundCallback (&CallbackTestBoundStrings,
+                                               std::string (10, 'a'), std::string (20, 'b'), std::string (30, 'c'));
+  Callback<int,int> largeCopy = large;
+  large.Nullify ();
+  NS_TEST_ASSERT_MSG_EQ (largeCopy (4), 64, "Large bound callback did not fire");
+  CallbackBase largeBase = largeCopy;
+  NS_TEST_ASSERT_MSG_EQ (largeCopy.IsEqual (largeBase), true, "Copy is not equal to its original");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -704,6 +818,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new InlineCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
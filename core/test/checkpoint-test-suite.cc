@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/checkpoint.h"
+#include "ns3/command-line.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * ns3::Checkpoint test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ * Save a simulation in the middle of a run and restore it twice: the
+ * restored processes must execute the same events with the same random
+ * numbers as the original one. The data buffered in a registered trace
+ * stream at the checkpoint must be written once.
+ */
+class CheckpointTestCase : public TestCase
+{
+public:
+  CheckpointTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  /** An event which records a random number and schedules the next one. */
+  void Step (void);
+  /** Run the end of the simulation in a restored process. */
+  void RunRestored (void);
+  /**
+   * Get the name of the output file of a restored process.
+   * \param [in] index The index of the restored process.
+   * \returns The file name.
+   */
+  std::string GetOutputName (uint32_t index);
+
+  Ptr<UniformRandomVariable> m_random; //!< The random number stream.
+  std::ostringstream m_history;        //!< The events after the checkpoint.
+  std::string m_path;                  //!< The checkpoint socket.
+  std::ofstream m_trace;               //!< A trace opened before the checkpoint.
+};
+
+CheckpointTestCase::CheckpointTestCase ()
+  : TestCase ("Check Checkpoint::Save and Checkpoint::Restore")
+{}
+
+void
+CheckpointTestCase::Step (void)
+{
+  double value = m_random->GetValue ();
+  m_history << Simulator::Now ().GetTimeStep () << " " << value << std::endl;
+  Simulator::Schedule (MicroSeconds (500 + static_cast<uint32_t> (value * 1000)),
+                       &CheckpointTestCase::Step, this);
+}
+
+void
+CheckpointTestCase::RunRestored (void)
+{
+  uint32_t index = 0;
+  CommandLine cmd;
+  cmd.AddValue ("index", "The index of the restored process", index);
+  cmd.Parse (Checkpoint::GetArguments ());
+  Simulator::Stop (MilliSeconds (50));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_trace << "restored " << index << std::endl;
+  std::ofstream file (GetOutputName (index).c_str ());
+  file << m_history.str ();
+  file.close ();
+  // Do not return to the test runner.
+  _exit (file.fail () ? 1 : 3);
+}
+
+std::string
+CheckpointTestCase::GetOutputName (uint32_t index)
+{
+  std::ostringstream oss;
+  oss << "restored-" << index;
+  return CreateTempDirFilename (oss.str ());
+}
+
+void
+CheckpointTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_path = CreateTempDirFilename ("checkpoint");
+  Simulator::Schedule (Seconds (0), &CheckpointTestCase::Step, this);
+  Simulator::Stop (MilliSeconds (50));
+  Simulator::Run ();
+  m_history.str ("");
+  std::string traceName = CreateTempDirFilename ("trace");
+  m_trace.open (traceName.c_str ());
+  FatalImpl::RegisterStream (&m_trace);
+  m_trace << "saved\n";
+
+  Checkpoint::Save (m_path);
+  if (Checkpoint::IsRestored ())
+    {
+      RunRestored ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (Checkpoint::IsAvailable (m_path), true, "No checkpoint process");
+  Simulator::Stop (MilliSeconds (50));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::string reference = m_history.str ();
+  NS_TEST_ASSERT_MSG_EQ (reference.empty (), false, "No events after the checkpoint");
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      std::ostringstream index;
+      index << "--index=" << i;
+      std::vector<std::string> args;
+      args.push_back ("checkpoint-test");
+      args.push_back (index.str ());
+      int status = Checkpoint::Restore (m_path, args);
+      NS_TEST_EXPECT_MSG_EQ (status, 3, "Wrong exit status of the restored process");
+      std::ifstream file (GetOutputName (i).c_str ());
+      std::ostringstream history;
+      history << file.rdbuf ();
+      NS_TEST_EXPECT_MSG_EQ (history.str (), reference, "Restored process " << i << " diverged");
+    }
+
+  Checkpoint::Close (m_path);
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::IsAvailable (m_path), false, "Checkpoint process not closed");
+
+  // The restored processes share the offset of the trace file.
+  m_trace << "original" << std::endl;
+  std::ifstream trace (traceName.c_str ());
+  std::ostringstream traced;
+  traced << trace.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (traced.str (), "saved\nrestored 0\nrestored 1\noriginal\n",
+                         "Buffered trace data written more than once");
+}
+
+void
+CheckpointTestCase::DoTeardown (void)
+{
+  Checkpoint::Close (m_path);
+  FatalImpl::UnregisterStream (&m_trace);
+  m_trace.close ();
+  m_random = 0;
+}
+
+/**
+ * \ingroup core-tests
+ * The checkpoint test suite.
+ */
+class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ();
+};
+
+CheckpointTestSuite::CheckpointTestSuite ()
+  : TestSuite ("checkpoint", UNIT)
+{
+  AddTestCase (new CheckpointTestCase, TestCase::QUICK);
+}
+
+static CheckpointTestSuite g_checkpointTestSuite; //!< Static variable for test initialization
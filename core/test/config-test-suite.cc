@@ -821,6 +821,133 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test the index lookups through vectors of objects, and the
+ * connection of a different sink to each matching trace source.
+ */
+class ConnectEachConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ConnectEachConfigTestCase ();
+  /** Destructor. */
+  virtual ~ConnectEachConfigTestCase () {}
+
+  /**
+   * Make the sink of one trace source.
+   * \param object The object holding the trace source.
+   * \param context The context of the trace source.
+   * \returns The sink.
+   */
+  CallbackBase MakeSink (Ptr<Object> object, std::string context);
+  /**
+   * Make no sink for a trace source.
+   * \param object The object holding the trace source.
+   * \param context The context of the trace source.
+   * \returns A null callback.
+   */
+  CallbackBase MakeNullSink (Ptr<Object> object, std::string context);
+  /**
+   * Trace callback of the object number \p i.
+   * \param i The object number.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void Trace (uint32_t i, int16_t oldValue, int16_t newValue) { m_values[i] = newValue; }
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<std::string> m_contexts; //!< The contexts of the sinks made.
+  std::vector<int16_t> m_values;       //!< The last value of each sink.
+};
+
+ConnectEachConfigTestCase::ConnectEachConfigTestCase ()
+  : TestCase ("Check index lookups and Config::ConnectEach through vectors of Object")
+{
+}
+
+CallbackBase
+ConnectEachConfigTestCase::MakeSink (Ptr<Object> object, std::string context)
+{
+  uint32_t i = m_contexts.size ();
+  m_contexts.push_back (context);
+  m_values.push_back (0);
+  return MakeCallback (&ConnectEachConfigTestCase::Trace, this).Bind (i);
+}
+
+CallbackBase
+ConnectEachConfigTestCase::MakeNullSink (Ptr<Object> object, std::string context)
+{
+  return CallbackBase ();
+}
+
+void
+ConnectEachConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  //
+  // Name a root object holding a vector of objects.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("ConnectEachRoot", root);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (objects[i]);
+    }
+
+  //
+  // A single index, in and out of the vector.
+  //
+  Config::Set ("/Names/ConnectEachRoot/NodesA/3/A", IntegerValue (-3));
+  objects[3]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"A\" not set through index 3");
+  objects[2]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/ConnectEachRoot/NodesA/5");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "Index out of the vector unexpectedly matched");
+
+  //
+  // Alternatives are matched in the order of the indices.
+  //
+  matches = Config::LookupMatches ("/Names/ConnectEachRoot/NodesA/4|[0-1]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/Names/ConnectEachRoot/NodesA/0/", "Wrong first match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/Names/ConnectEachRoot/NodesA/4/", "Wrong last match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (2), objects[4], "Wrong object matched");
+
+  //
+  // Connect a sink to each of the trace sources.
+  //
+  uint32_t connected = Config::ConnectEach ("/Names/ConnectEachRoot/NodesA/*/Source",
+                                            MakeCallback (&ConnectEachConfigTestCase::MakeSink, this));
+  NS_TEST_ASSERT_MSG_EQ (connected, 5, "Wrong number of trace sources connected");
+  NS_TEST_ASSERT_MSG_EQ (m_contexts[1], "/Names/ConnectEachRoot/NodesA/1/Source", "Wrong context");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      int16_t value = -10 - i;
+      objects[i]->SetAttribute ("Source", IntegerValue (value));
+    }
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      int16_t value = -10 - i;
+      NS_TEST_EXPECT_MSG_EQ (m_values[i], value, "Sink " << i << " did not see its own trace source");
+    }
+
+  //
+  // The trace sources without a sink are skipped.
+  //
+  connected = Config::ConnectEach ("/Names/ConnectEachRoot/NodesA/*/Source",
+                                   MakeCallback (&ConnectEachConfigTestCase::MakeNullSink, this));
+  NS_TEST_ASSERT_MSG_EQ (connected, 0, "Null sinks connected");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -839,6 +966,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new ConnectEachConfigTestCase);
 }
 
 /**
@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/log-ring-buffer.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/system-thread.h"
+#include "ns3/test.h"
+
+#include <list>
+#include <sstream>
+#include <string>
+
+// Compile out the function and logic messages of this file.
+#undef NS_LOG_COMPONENT_MAX_LEVEL
+#define NS_LOG_COMPONENT_MAX_LEVEL ns3::LOG_LEVEL_INFO
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logging
+ * ns3::LogRingBuffer and NS_LOG_RECORD test suite.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LogRingBufferTest");
+
+/**
+ * \ingroup core-tests
+ * Check the formatting of the NS_LOG_RECORD messages.
+ */
+class LogRingBufferFormatTestCase : public TestCase
+{
+public:
+  LogRingBufferFormatTestCase ();
+  virtual void DoRun (void);
+};
+
+LogRingBufferFormatTestCase::LogRingBufferFormatTestCase ()
+  : TestCase ("Check the lazy formatting of the messages")
+{}
+
+void
+LogRingBufferFormatTestCase::DoRun (void)
+{
+  std::ostringstream oss;
+  LogRingBuffer::Format (oss, "a {} b {} c {} d {}", -3, 4u, 0.5, "str");
+  NS_TEST_EXPECT_MSG_EQ (oss.str (), "a -3 b 4 c 0.5 d str", "Wrong formatting");
+
+  oss.str ("");
+  LogRingBuffer::Format (oss, "no argument {}, {", true);
+  NS_TEST_EXPECT_MSG_EQ (oss.str (), "no argument 1, {", "Wrong formatting");
+
+  oss.str ("");
+  LogRingBuffer::Format (oss, "missing {} {}", 1);
+  NS_TEST_EXPECT_MSG_EQ (oss.str (), "missing 1 {}", "Wrong formatting");
+}
+
+/**
+ * \ingroup core-tests
+ * Store messages into a small ring buffer during a simulation, and
+ * check that the latest ones are flushed with their time and context.
+ */
+class LogRingBufferRecordTestCase : public TestCase
+{
+public:
+  LogRingBufferRecordTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  /**
+   * Log a message.
+   * \param [in] i The message number.
+   */
+  void Log (uint32_t i);
+  /**
+   * Count the evaluations of the logging arguments.
+   * \returns The number of evaluations.
+   */
+  uint32_t Count (void);
+
+  uint32_t m_count;  //!< The number of evaluations.
+};
+
+LogRingBufferRecordTestCase::LogRingBufferRecordTestCase ()
+  : TestCase ("Check the ring buffer and the compile time log levels"),
+    m_count (0)
+{}
+
+void
+LogRingBufferRecordTestCase::Log (uint32_t i)
+{
+  NS_LOG_RECORD (LOG_INFO, "message {} of {}", i, "test");
+  // Compiled out: neither stored nor evaluated.
+  NS_LOG_RECORD (LOG_LOGIC, "logic {}", Count ());
+  NS_LOG_LOGIC ("logic " << Count ());
+  NS_LOG_FUNCTION (this << Count ());
+}
+
+uint32_t
+LogRingBufferRecordTestCase::Count (void)
+{
+  return ++m_count;
+}
+
+void
+LogRingBufferRecordTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogRingBufferTest", LOG_LEVEL_ALL);
+  LogRingBuffer::Enable (3);
+  NS_TEST_ASSERT_MSG_EQ (LogRingBuffer::IsEnabled (), true, "Ring buffer not enabled");
+
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Simulator::ScheduleWithContext (7, NanoSeconds (i + 1), &LogRingBufferRecordTestCase::Log, this, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // The capacity is rounded up to 4.
+  std::ostringstream oss;
+  std::size_t printed = LogRingBuffer::Flush (oss);
+  NS_TEST_EXPECT_MSG_EQ (printed, 4, "Wrong number of messages kept");
+  uint64_t overwritten = LogRingBuffer::GetOverwritten ();
+  NS_TEST_EXPECT_MSG_EQ (overwritten, 2, "Wrong number of messages lost");
+  NS_TEST_EXPECT_MSG_EQ (m_count, 0, "Compiled out arguments evaluated");
+
+  std::istringstream lines (oss.str ());
+  std::string line;
+  std::getline (lines, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "+0.000000003s 7 LogRingBufferTest:[INFO ] message 2 of test",
+                         "Wrong first message");
+  std::getline (lines, line);
+  std::getline (lines, line);
+  std::getline (lines, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "+0.000000006s 7 LogRingBufferTest:[INFO ] message 5 of test",
+                         "Wrong last message");
+
+  oss.str ("");
+  printed = LogRingBuffer::Flush (oss);
+  NS_TEST_EXPECT_MSG_EQ (printed, 0, "Messages flushed twice");
+}
+
+void
+LogRingBufferRecordTestCase::DoTeardown (void)
+{
+  LogRingBuffer::Disable ();
+  LogComponentDisable ("LogRingBufferTest", LOG_LEVEL_ALL);
+}
+
+/**
+ * \ingroup core-tests
+ * Check that the ring buffer can be replaced while other threads log.
+ */
+class LogRingBufferConcurrentTestCase : public TestCase
+{
+public:
+  LogRingBufferConcurrentTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  /** Log messages from a thread. */
+  void Log (void);
+};
+
+LogRingBufferConcurrentTestCase::LogRingBufferConcurrentTestCase ()
+  : TestCase ("Check that the ring buffer can be replaced while logging")
+{}
+
+void
+LogRingBufferConcurrentTestCase::Log (void)
+{
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      NS_LOG_RECORD (LOG_INFO, "thread message {}", i);
+    }
+}
+
+void
+LogRingBufferConcurrentTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogRingBufferTest", LOG_LEVEL_INFO);
+  LogRingBuffer::Enable (64);
+
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&LogRingBufferConcurrentTestCase::Log, this));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  // Each replaced ring buffer may still be written by the threads.
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      LogRingBuffer::Enable (64);
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  std::ostringstream oss;
+  std::size_t printed = LogRingBuffer::Flush (oss);
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (printed, 64, "More messages than the capacity");
+}
+
+void
+LogRingBufferConcurrentTestCase::DoTeardown (void)
+{
+  LogRingBuffer::Disable ();
+  LogComponentDisable ("LogRingBufferTest", LOG_LEVEL_ALL);
+}
+
+/**
+ * \ingroup core-tests
+ * The log ring buffer test suite.
+ */
+class LogRingBufferTestSuite : public TestSuite
+{
+public:
+  LogRingBufferTestSuite ();
+};
+
+LogRingBufferTestSuite::LogRingBufferTestSuite ()
+  : TestSuite ("log-ring-buffer", UNIT)
+{
+  AddTestCase (new LogRingBufferFormatTestCase, TestCase::QUICK);
+#ifdef NS3_LOG_ENABLE
+  AddTestCase (new LogRingBufferRecordTestCase, TestCase::QUICK);
+  AddTestCase (new LogRingBufferConcurrentTestCase, TestCase::QUICK);
+#endif /* NS3_LOG_ENABLE */
+}
+
+static LogRingBufferTestSuite g_logRingBufferTestSuite; //!< Static variable for test initialization
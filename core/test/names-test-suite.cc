@@ -17,6 +17,11 @@
 #include "ns3/test.h"
 #include "ns3/names.h"
 
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
 
 /**
  * \file
@@ -1001,6 +1006,94 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+/**
+ * \ingroup names-tests
+ * Test the Object Name Service can add many names at once.
+ *
+ *     Add (std::string path, const std::vector<std::string> &names, const std::vector<Ptr<Object> > &objects);
+ *     Add (Ptr<Object> context, const std::vector<std::string> &names, const std::vector<Ptr<Object> > &objects);
+ *
+ */
+class BulkAddTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  BulkAddTestCase ();
+  /** Destructor. */
+  virtual ~BulkAddTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+BulkAddTestCase::BulkAddTestCase ()
+  : TestCase ("Check bulk Names::Add functionality")
+{
+}
+
+BulkAddTestCase::~BulkAddTestCase ()
+{
+}
+
+void
+BulkAddTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+BulkAddTestCase::DoRun (void)
+{
+  std::vector<std::string> names;
+  std::vector<Ptr<Object> > nodes;
+  std::vector<Ptr<Object> > devices;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      std::ostringstream oss;
+      oss << "Node " << i;
+      names.push_back (oss.str ());
+      nodes.push_back (CreateObject<TestObject> ());
+    }
+  Names::Add ("/Names", names, nodes);
+
+  std::vector<std::string> deviceNames;
+  deviceNames.push_back ("eth0");
+  deviceNames.push_back ("eth1");
+  devices.push_back (CreateObject<TestObject> ());
+  devices.push_back (CreateObject<TestObject> ());
+  Names::Add (nodes[3], deviceNames, devices);
+
+  std::vector<std::string> moreNames;
+  std::vector<Ptr<Object> > moreDevices;
+  moreNames.push_back ("eth0");
+  moreDevices.push_back (CreateObject<TestObject> ());
+  Names::Add ("/Names/Node 4", moreNames, moreDevices);
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Names::FindName (nodes[i]), names[i], "Could not bulk Names::Add an Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<Object> (names[i]), nodes[i], "Could not bulk Names::Add an Object");
+    }
+
+  std::string found = Names::FindPath (devices[1]);
+  NS_TEST_ASSERT_MSG_EQ (found, "/Names/Node 3/eth1", "Could not bulk Names::Add a child Object");
+
+  Ptr<Object> device = Names::Find<Object> ("/Names/Node 4/eth0");
+  NS_TEST_ASSERT_MSG_EQ (device, moreDevices[0], "Could not bulk Names::Add a child Object by path");
+
+  device = Names::Find<Object> (nodes[3], "eth0");
+  NS_TEST_ASSERT_MSG_EQ (device, devices[0], "Could not bulk Names::Add a child Object by context");
+
+  Names::Rename (nodes[3], "eth0", "eth2");
+  device = Names::Find<Object> ("Node 3/eth2");
+  NS_TEST_ASSERT_MSG_EQ (device, devices[0], "Could not Names::Rename a bulk added Object");
+  device = Names::Find<Object> ("Node 3/eth0");
+  NS_TEST_ASSERT_MSG_EQ (device, 0, "Unexpectedly found a renamed Object");
+  device = Names::Find<Object> ("Node 4/eth0");
+  NS_TEST_ASSERT_MSG_EQ (device, moreDevices[0], "Renaming changed another Object");
+}
+
 /**
  * \ingroup names-tests
  * Names Test Suite 
@@ -1029,6 +1122,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase);
   AddTestCase (new RelativeFindTestCase);
   AddTestCase (new AlternateFindTestCase);
+  AddTestCase (new BulkAddTestCase);
 }
 
 /**
@@ -1037,6 +1131,158 @@ NamesTestSuite::NamesTestSuite ()
  */
 static NamesTestSuite g_namesTestSuite;
 
+/**
+ * \ingroup names-tests
+ * Measure the time to name and look up the objects of a large topology.
+ *
+ * Each node is named in the root name space, and its device is named
+ * under the node, as a helper would.
+ */
+class LargeTopologyTimeTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  LargeTopologyTimeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Print the time per operation.
+   * \param [in] what The operation.
+   * \param [in] ticks The clock ticks taken by NODES operations.
+   */
+  void Report (std::string what, std::clock_t ticks) const;
+
+  /** The number of nodes named. */
+  enum { NODES = 100000 };
+};
+
+LargeTopologyTimeTestCase::LargeTopologyTimeTestCase ()
+  : TestCase ("Measure the Names operations on a large topology")
+{
+}
+
+void
+LargeTopologyTimeTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+LargeTopologyTimeTestCase::Report (std::string what, std::clock_t ticks) const
+{
+  double per = 1E9 * double (ticks) / (double (NODES) * CLOCKS_PER_SEC);
+  std::cout << "  " << what << ": " << per << " ns" << std::endl;
+}
+
+void
+LargeTopologyTimeTestCase::DoRun (void)
+{
+  std::vector<Ptr<Object> > nodes;
+  std::vector<Ptr<Object> > devices;
+  std::vector<std::string> names;
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      nodes.push_back (CreateObject<TestObject> ());
+      devices.push_back (CreateObject<TestObject> ());
+      std::ostringstream oss;
+      oss << "node" << i;
+      names.push_back (oss.str ());
+      paths.push_back ("/Names/" + oss.str () + "/eth0");
+    }
+  Ptr<Object> unnamed = CreateObject<TestObject> ();
+  // Look the objects up in a scattered order, as Config would.
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0, j = 0; i < NODES; i++, j = (j + 7919) % NODES)
+    {
+      order.push_back (j);
+    }
+  std::cout << GetName () << ": " << NODES << " nodes" << std::endl;
+
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Names::Add (names[i], nodes[i]);
+      Names::Add (nodes[i], "eth0", devices[i]);
+    }
+  Report ("Add", std::clock () - start);
+  Names::Clear ();
+
+  start = std::clock ();
+  Names::Add ("/Names", names, nodes);
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Names::Add (nodes[i], "eth0", devices[i]);
+    }
+  Report ("Add (bulk nodes)", std::clock () - start);
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Ptr<Object> found = Names::Find<Object> (paths[order[i]]);
+      NS_ASSERT (found == devices[order[i]]);
+    }
+  Report ("Find (path)", std::clock () - start);
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Ptr<Object> found = Names::Find<Object> (nodes[order[i]], "eth0");
+      NS_ASSERT (found == devices[order[i]]);
+    }
+  Report ("Find (context, name)", std::clock () - start);
+
+  // Config looks up every path segment under every object it visits.
+  start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      Ptr<Object> found = Names::Find<Object> (unnamed, "DeviceList");
+      NS_ASSERT (found == 0);
+    }
+  Report ("Find (unnamed context, name)", std::clock () - start);
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      std::string name = Names::FindName (devices[order[i]]);
+      NS_ASSERT (name == "eth0");
+    }
+  Report ("FindName", std::clock () - start);
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < NODES; i++)
+    {
+      std::string path = Names::FindPath (devices[order[i]]);
+      NS_ASSERT (path == paths[order[i]]);
+    }
+  Report ("FindPath", std::clock () - start);
+}
+
+/**
+ * \ingroup names-tests
+ * Names performance test suite.
+ */
+class NamesPerformanceTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  NamesPerformanceTestSuite ();
+};
+
+NamesPerformanceTestSuite::NamesPerformanceTestSuite ()
+  : TestSuite ("object-name-service-perf", PERFORMANCE)
+{
+  AddTestCase (new LargeTopologyTimeTestCase);
+}
+
+/**
+ * \ingroup names-tests
+ *  NamesPerformanceTestSuite instance variable.
+ */
+static NamesPerformanceTestSuite g_namesPerformanceTestSuite;
+
 
   }  // namespace tests
 
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that RandomVariableStream::GetValues draws the same values as
+ * successive calls to GetValue, and leaves the stream in the same state.
+ */
+class RandomVariableStreamGetValuesTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] factory The factory of the random variables to compare.
+   * \param [in] description The description of the random variables.
+   */
+  RandomVariableStreamGetValuesTestCase (ObjectFactory factory, std::string description);
+  /** Destructor. */
+  virtual ~RandomVariableStreamGetValuesTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The factory of the random variables. */
+  ObjectFactory m_factory;
+};
+
+RandomVariableStreamGetValuesTestCase::RandomVariableStreamGetValuesTestCase (ObjectFactory factory,
+                                                                              std::string description)
+  : TestCase ("Check GetValues of " + description),
+    m_factory (factory)
+{
+}
+
+RandomVariableStreamGetValuesTestCase::~RandomVariableStreamGetValuesTestCase ()
+{
+}
+
+void
+RandomVariableStreamGetValuesTestCase::DoRun (void)
+{
+  // Two variables on the same stream draw the same numbers.
+  Ptr<RandomVariableStream> scalar = m_factory.Create<RandomVariableStream> ();
+  Ptr<RandomVariableStream> batch = m_factory.Create<RandomVariableStream> ();
+  scalar->SetStream (11);
+  batch->SetStream (11);
+
+  const std::size_t sizes[] = { 0, 1, 2, 3, 7, 64, 129, 1000 };
+  for (std::size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      std::vector<double> values (sizes[i] + 1);
+      batch->GetValues (&values[0], sizes[i]);
+      for (std::size_t j = 0; j < sizes[i]; j++)
+        {
+          double expected = scalar->GetValue ();
+          NS_TEST_ASSERT_MSG_EQ (values[j], expected,
+                                 "Value " << j << " of a batch of " << sizes[i] << " differs");
+        }
+      // Interleave a single value, from the state left by the batch.
+      double expected = scalar->GetValue ();
+      double value = batch->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (value, expected,
+                             "Value after a batch of " << sizes[i] << " differs");
+    }
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStream::GetValues test suite.
+ */
+class RandomVariableStreamGetValuesTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamGetValuesTestSuite ();
+private:
+  /**
+   * Add a test case for a random variable.
+   * \param [in] factory The factory of the random variable.
+   * \param [in] description The description of the random variable.
+   */
+  void AddVariable (ObjectFactory factory, std::string description);
+};
+
+RandomVariableStreamGetValuesTestSuite::RandomVariableStreamGetValuesTestSuite ()
+  : TestSuite ("random-variable-stream-get-values", UNIT)
+{
+  ObjectFactory factory ("ns3::UniformRandomVariable");
+  factory.Set ("Min", DoubleValue (2));
+  factory.Set ("Max", DoubleValue (5));
+  AddVariable (factory, "a uniform random variable");
+  factory.Set ("Antithetic", BooleanValue (true));
+  AddVariable (factory, "an antithetic uniform random variable");
+
+  factory = ObjectFactory ("ns3::ConstantRandomVariable");
+  factory.Set ("Constant", DoubleValue (3));
+  AddVariable (factory, "a constant random variable");
+
+  // A bound close to the mean rejects many values.
+  factory = ObjectFactory ("ns3::ExponentialRandomVariable");
+  factory.Set ("Mean", DoubleValue (2));
+  factory.Set ("Bound", DoubleValue (1));
+  AddVariable (factory, "a bounded exponential random variable");
+  factory.Set ("Antithetic", BooleanValue (true));
+  AddVariable (factory, "an antithetic exponential random variable");
+
+  factory = ObjectFactory ("ns3::NormalRandomVariable");
+  factory.Set ("Mean", DoubleValue (1));
+  factory.Set ("Variance", DoubleValue (4));
+  AddVariable (factory, "a normal random variable");
+  factory.Set ("Bound", DoubleValue (1));
+  AddVariable (factory, "a bounded normal random variable");
+  factory.Set ("Antithetic", BooleanValue (true));
+  AddVariable (factory, "an antithetic normal random variable");
+
+  // The default implementation.
+  factory = ObjectFactory ("ns3::ParetoRandomVariable");
+  AddVariable (factory, "a Pareto random variable");
+}
+
+void
+RandomVariableStreamGetValuesTestSuite::AddVariable (ObjectFactory factory, std::string description)
+{
+  AddTestCase (new RandomVariableStreamGetValuesTestCase (factory, description), TestCase::QUICK);
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableStreamGetValuesTestSuite instance variable.
+ */
+static RandomVariableStreamGetValuesTestSuite g_randomVariableStreamGetValuesTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
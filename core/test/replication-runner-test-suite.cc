@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * ns3::ReplicationRunner test suite.
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** The stream number of the test variables. */
+const int64_t STREAM = 7;
+/** The number of values printed by each replication. */
+const int VALUES = 3;
+
+/**
+ * Print the next values of a random variable.
+ * \param [in,out] os The output stream.
+ * \param [in] variable The random variable.
+ */
+void
+PrintValues (std::ostream &os, Ptr<RandomVariableStream> variable)
+{
+  for (int i = 0; i < VALUES; i++)
+    {
+      os << variable->GetValue () << " ";
+    }
+  os << std::endl;
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup core-tests
+ * Fork replications after drawing random numbers, and check that each
+ * of them draws the numbers of fresh variables with its run number.
+ * The normal variable has a cached value when the replications start.
+ */
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  uint64_t m_run;  //!< The run number before the test.
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Check the run numbers and outputs of the replications"),
+    m_run (RngSeedManager::GetRun ())
+{}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  m_run = RngSeedManager::GetRun ();
+  RngSeedManager::SetRun (5);
+  Ptr<UniformRandomVariable> variable = CreateObject<UniformRandomVariable> ();
+  variable->SetStream (STREAM);
+  Ptr<NormalRandomVariable> normal = CreateObject<NormalRandomVariable> ();
+  normal->SetStream (STREAM + 1);
+  // Random numbers drawn during the setup, common to all replications.
+  variable->GetValue ();
+  normal->GetValue ();
+
+  ReplicationRunner runner;
+  runner.SetReplications (4);
+  runner.SetJobs (2);
+  runner.SetOutputPrefix (CreateTempDirFilename ("replication"));
+  if (runner.Fork ())
+    {
+      PrintValues (std::cout, variable);
+      PrintValues (std::cout, normal);
+      std::cout.flush ();
+      // Do not return to the test runner.
+      _exit (runner.GetRun () == 7 ? 2 : 0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (runner.IsReplication (), false, "Not the original process");
+  NS_TEST_EXPECT_MSG_EQ (runner.GetExitStatus (), 2, "Wrong exit status");
+
+  std::string first;
+  for (uint64_t run = 5; run < 9; run++)
+    {
+      RngSeedManager::SetRun (run);
+      Ptr<UniformRandomVariable> fresh = CreateObject<UniformRandomVariable> ();
+      fresh->SetStream (STREAM);
+      Ptr<NormalRandomVariable> freshNormal = CreateObject<NormalRandomVariable> ();
+      freshNormal->SetStream (STREAM + 1);
+      std::ostringstream expected;
+      PrintValues (expected, fresh);
+      PrintValues (expected, freshNormal);
+
+      std::ifstream file (runner.GetOutputFileName (run).c_str ());
+      std::ostringstream output;
+      output << file.rdbuf ();
+      NS_TEST_EXPECT_MSG_EQ (output.str (), expected.str (), "Wrong random numbers in run " << run);
+      if (run == 5)
+        {
+          first = output.str ();
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_NE (output.str (), first, "Run " << run << " is not independent");
+        }
+    }
+}
+
+void
+ReplicationRunnerTestCase::DoTeardown (void)
+{
+  RngSeedManager::SetRun (m_run);
+}
+
+/**
+ * \ingroup core-tests
+ * The replication runner test suite.
+ */
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ();
+};
+
+ReplicationRunnerTestSuite::ReplicationRunnerTestSuite ()
+  : TestSuite ("replication-runner", UNIT)
+{
+  AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+}
+
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite; //!< Static variable for test initialization
@@ -23,6 +23,17 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/free-list-allocator.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <vector>
 
 using namespace ns3;
 
@@ -168,6 +179,366 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that events are dequeued in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  // the schedulers never dereference the event implementation, so
+  // a single dummy pointer is good enough here.
+  EventImpl *impl = reinterpret_cast<EventImpl *> (0x1);
+
+  // a cheap deterministic generator, with many duplicate time stamps
+  uint32_t state = 12345;
+  std::vector<Scheduler::Event> inserted;
+  for (uint32_t uid = 4; uid < 2004; uid++)
+    {
+      state = state * 1103515245 + 12345;
+      Scheduler::Event ev;
+      ev.impl = impl;
+      ev.key.m_ts = (state >> 16) % 500;
+      ev.key.m_uid = uid;
+      ev.key.m_context = uid % 7;
+      scheduler->Insert (ev);
+      inserted.push_back (ev);
+    }
+  // remove every third event from the middle of the queue.
+  uint32_t expected = inserted.size ();
+  std::set<uint32_t> removed;
+  for (uint32_t i = 0; i < inserted.size (); i += 3)
+    {
+      scheduler->Remove (inserted[i]);
+      removed.insert (inserted[i].key.m_uid);
+      expected--;
+    }
+
+  // while draining, keep scheduling new events in the future of the
+  // dequeued ones, as a simulation would.
+  uint32_t uid = 100000;
+  uint32_t count = 0;
+  Scheduler::Event prev = scheduler->PeekNext ();
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event peek = scheduler->PeekNext ();
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (peek.key.m_uid, next.key.m_uid, "PeekNext and RemoveNext disagree");
+      bool wasRemoved = removed.find (next.key.m_uid) != removed.end ();
+      NS_TEST_ASSERT_MSG_EQ (wasRemoved, false, "Removed event was dequeued");
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_context, next.key.m_uid % 7, "Event context was lost");
+      bool outOfOrder = next.key < prev.key;
+      NS_TEST_ASSERT_MSG_EQ (outOfOrder, false, "Events dequeued out of order");
+      prev = next;
+      count++;
+      if (uid < 104000)
+        {
+          state = state * 1103515245 + 12345;
+          Scheduler::Event ev;
+          ev.impl = impl;
+          ev.key.m_ts = next.key.m_ts + (state >> 16) % 1000;
+          ev.key.m_uid = uid;
+          ev.key.m_context = uid % 7;
+          scheduler->Insert (ev);
+          expected++;
+          if (uid % 5 == 0)
+            {
+              scheduler->Remove (ev);
+              removed.insert (uid);
+              expected--;
+            }
+          uid++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, expected, "Wrong number of events dequeued");
+}
+
+class EventAllocationTestCase : public TestCase
+{
+public:
+  EventAllocationTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Reschedule (uint32_t n);
+  ObjectFactory m_schedulerFactory;
+};
+
+EventAllocationTestCase::EventAllocationTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that events are recycled in steady state with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+EventAllocationTestCase::Reschedule (uint32_t n)
+{
+  if (n > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &EventAllocationTestCase::Reschedule, this, n - 1);
+    }
+}
+
+void
+EventAllocationTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  // warm up the free lists.
+  Simulator::Schedule (MicroSeconds (1), &EventAllocationTestCase::Reschedule, this, 10);
+  Simulator::Run ();
+
+  FreeListAllocator::Stats before = FreeListAllocator::GetStats ();
+  Simulator::Schedule (MicroSeconds (1), &EventAllocationTestCase::Reschedule, this, 1000);
+  Simulator::Run ();
+  FreeListAllocator::Stats after = FreeListAllocator::GetStats ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (after.misses, before.misses, "Events were not recycled");
+  NS_TEST_EXPECT_MSG_GT (after.hits - before.hits, 1000, "Events were not allocated from the free lists");
+}
+
+class FreeListCapTestCase : public TestCase
+{
+public:
+  FreeListCapTestCase ();
+  virtual void DoRun (void);
+  void Churn (uint32_t n);
+};
+
+FreeListCapTestCase::FreeListCapTestCase ()
+  : TestCase ("Check that the free lists keep at most MAX_CACHED blocks")
+{
+}
+
+void
+FreeListCapTestCase::Churn (uint32_t n)
+{
+  std::vector<void *> blocks;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      blocks.push_back (FreeListAllocator::Allocate (40));
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      FreeListAllocator::Deallocate (blocks[i], 40);
+    }
+}
+
+void
+FreeListCapTestCase::DoRun (void)
+{
+  uint32_t n = FreeListAllocator::MAX_CACHED + 10;
+  // Leaves exactly MAX_CACHED blocks in the free list of the size class.
+  Churn (n);
+  FreeListAllocator::Stats before = FreeListAllocator::GetStats ();
+  Churn (n);
+  FreeListAllocator::Stats after = FreeListAllocator::GetStats ();
+
+  NS_TEST_EXPECT_MSG_EQ (after.misses - before.misses, 10, "Too many blocks were cached");
+  NS_TEST_EXPECT_MSG_EQ (after.cached, before.cached, "The free list grew past its limit");
+}
+
+class EventCancellationTestCase : public TestCase
+{
+public:
+  EventCancellationTestCase (ObjectFactory schedulerFactory, bool lazyRemove);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  void Count (void);
+  ObjectFactory m_schedulerFactory;
+  bool m_lazyRemove;
+  uint32_t m_count;
+};
+
+EventCancellationTestCase::EventCancellationTestCase (ObjectFactory schedulerFactory, bool lazyRemove)
+  : TestCase ("Check the compaction of cancelled events with " +
+              schedulerFactory.GetTypeId ().GetName () +
+              (lazyRemove ? " and lazy removal" : "")),
+    m_schedulerFactory (schedulerFactory),
+    m_lazyRemove (lazyRemove)
+{
+}
+
+void
+EventCancellationTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+EventCancellationTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::LazyRemove", BooleanValue (m_lazyRemove));
+  Simulator::SetScheduler (m_schedulerFactory);
+  m_count = 0;
+
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ids.push_back (Simulator::Schedule (MicroSeconds (i + 1), &EventCancellationTestCase::Count, this));
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 1000, "Wrong number of live events");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Wrong number of cancelled events");
+
+  for (uint32_t i = 0; i < 1000; i += 25)
+    {
+      ids[i].Cancel ();
+      Simulator::Remove (ids[i + 1]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 920, "Wrong number of live events");
+  uint64_t cancelled = m_lazyRemove ? 80 : 40;
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), cancelled, "Wrong number of cancelled events");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCompactionCount (), 0, "Unexpected compaction");
+
+  // cancel enough events to trigger a compaction.
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      if (i % 25 >= 2 && i % 25 < 17)
+        {
+          ids[i].Cancel ();
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 320, "Wrong number of live events");
+  NS_TEST_EXPECT_MSG_GT (Simulator::GetCompactionCount (), 0, "No compaction");
+  NS_TEST_EXPECT_MSG_LT (Simulator::GetCancelledEventCount (), 320, "Cancelled events not purged");
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      bool expired = i % 25 < 17;
+      NS_TEST_EXPECT_MSG_EQ (ids[i].IsExpired (), expired, "Wrong expiration of event " << i);
+    }
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 320, "Wrong number of events executed");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 0, "Events left");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Cancelled events left");
+  Simulator::Destroy ();
+}
+
+void
+EventCancellationTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::LazyRemove", BooleanValue (false));
+}
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  void Parent (uint32_t n);
+  void Child (void);
+  void Sibling (void);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the event profiler")
+{
+}
+
+void
+EventProfilerTestCase::Parent (uint32_t n)
+{
+  Simulator::ScheduleWithContext (1, MicroSeconds (1), &EventProfilerTestCase::Child, this);
+  Simulator::ScheduleWithContext (2, MicroSeconds (1), &EventProfilerTestCase::Child, this);
+  Simulator::Schedule (MicroSeconds (1), &EventProfilerTestCase::Sibling, this);
+  if (n > 1)
+    {
+      Simulator::Schedule (MicroSeconds (10), &EventProfilerTestCase::Parent, this, n - 1);
+    }
+}
+
+void
+EventProfilerTestCase::Child (void)
+{
+}
+
+void
+EventProfilerTestCase::Sibling (void)
+{
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  std::string prefix = CreateTempDirFilename ("profile");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::Profile", BooleanValue (true));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileOutput", StringValue (prefix));
+
+  Simulator::ScheduleWithContext (0, MicroSeconds (1), &EventProfilerTestCase::Parent, this, uint32_t (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream report ((prefix + ".txt").c_str ());
+  NS_TEST_ASSERT_MSG_EQ (report.is_open (), true, "No profile report");
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_EXPECT_MSG_EQ (line.find ("Simulator profile: 40 events"), 0, "Wrong event count");
+  uint32_t parents = 0;
+  uint32_t children = 0;
+  uint32_t siblings = 0;
+  while (std::getline (report, line))
+    {
+      std::istringstream iss (line);
+      double ms, percent, nsPerEvent, fanOut;
+      uint64_t count;
+      iss >> ms >> percent >> count >> nsPerEvent >> fanOut;
+      if (line.find ("EventProfilerTestCase::*)(unsigned int)") != std::string::npos)
+        {
+          parents++;
+          NS_TEST_EXPECT_MSG_EQ (count, 10, "Wrong count: " << line);
+          NS_TEST_EXPECT_MSG_EQ_TOL (fanOut, 3.9, 0.001, "Wrong fan-out: " << line);
+        }
+      else if (line.find ("EventProfilerTestCase::*)()") != std::string::npos)
+        {
+          // Child and Sibling have the same signature.
+          if (count == 20)
+            {
+              children++;
+            }
+          else
+            {
+              siblings++;
+              NS_TEST_EXPECT_MSG_EQ (count, 10, "Wrong count: " << line);
+            }
+          NS_TEST_EXPECT_MSG_EQ_TOL (fanOut, 0, 0.001, "Wrong fan-out: " << line);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (parents, 1, "Parent events not reported");
+  NS_TEST_EXPECT_MSG_EQ (children, 1, "Child events not reported");
+  NS_TEST_EXPECT_MSG_EQ (siblings, 1, "Sibling events not reported separately");
+
+  std::ifstream folded ((prefix + ".folded").c_str ());
+  NS_TEST_ASSERT_MSG_EQ (folded.is_open (), true, "No folded stacks");
+  std::set<std::string> contexts;
+  uint32_t stacks = 0;
+  while (std::getline (folded, line))
+    {
+      contexts.insert (line.substr (0, line.find (';')));
+      stacks++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (stacks, 4, "Wrong folded stacks");
+  NS_TEST_EXPECT_MSG_EQ (contexts.count ("context 0"), 1, "Wrong folded stacks");
+  NS_TEST_EXPECT_MSG_EQ (contexts.count ("context 2"), 1, "Wrong folded stacks");
+}
+
+void
+EventProfilerTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::Profile", BooleanValue (false));
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,5 +846,44 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new EventAllocationTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new EventAllocationTestCase (factory), TestCase::QUICK);
+    AddTestCase (new FreeListCapTestCase (), TestCase::QUICK);
+
+    TypeId schedulers[] = {
+      ListScheduler::GetTypeId (),
+      MapScheduler::GetTypeId (),
+      HeapScheduler::GetTypeId (),
+      CalendarScheduler::GetTypeId (),
+      DaryHeapScheduler::GetTypeId (),
+      LadderScheduler::GetTypeId ()
+    };
+    for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+      {
+        factory.SetTypeId (schedulers[i]);
+        AddTestCase (new EventCancellationTestCase (factory, false), TestCase::QUICK);
+        AddTestCase (new EventCancellationTestCase (factory, true), TestCase::QUICK);
+      }
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -20,13 +20,18 @@
  * TimeStep support by Emmanuelle Laprise <emmanuelle.laprise@bluekazoo.ca>
  */
 
+#include <cstdlib>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/int64x64.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 
 using namespace ns3;
@@ -229,6 +234,262 @@ TimeInputOutputTestCase::DoRun (void)
 
   std::cout << std::endl;
 }
+
+/**
+ * The unit conversions of Time, as implemented before the integer
+ * fast path of the default resolution, to check it against.
+ */
+class TimeReference
+{
+public:
+  /**
+   * Get the conversion factor between a unit and the current resolution.
+   * \param [in] unit The unit.
+   * \param [out] coarser Set if \p unit is coarser than the resolution.
+   * \returns The ratio of the coarser to the finer unit.
+   */
+  static int64_t Factor (Time::Unit unit, bool &coarser)
+  {
+    // Y, D, H, MIN, S, MS, US, NS, PS, FS, as in Time::SetResolution
+    const int power[Time::LAST] = { 17, 17, 17, 16, 15, 12, 9, 6, 3, 0 };
+    const int64_t coefficient[Time::LAST] = { 315360, 864, 36, 6, 1, 1, 1, 1, 1, 1 };
+    Time::Unit resolution = Time::GetResolution ();
+    int shift = power[unit] - power[resolution];
+    int64_t factor = 1;
+    for (int i = 0; i < std::abs (shift); i++)
+      {
+        factor *= 10;
+      }
+    if (coefficient[unit] >= coefficient[resolution])
+      {
+        factor *= coefficient[unit] / coefficient[resolution];
+      }
+    else
+      {
+        factor *= coefficient[resolution] / coefficient[unit];
+      }
+    coarser = unit <= resolution;
+    return factor;
+  }
+  /**
+   * Time::FromInteger.
+   * \param [in] value The value.
+   * \param [in] unit The unit of \p value.
+   * \returns The Time.
+   */
+  static Time FromInteger (uint64_t value, Time::Unit unit)
+  {
+    bool coarser;
+    int64_t factor = Factor (unit, coarser);
+    if (coarser)
+      {
+        value *= factor;
+      }
+    else
+      {
+        value /= factor;
+      }
+    return Time (value);
+  }
+  /**
+   * Time::FromDouble.
+   * \param [in] value The value.
+   * \param [in] unit The unit of \p value.
+   * \returns The Time.
+   */
+  static Time FromDouble (double value, Time::Unit unit)
+  {
+    return Time::From (int64x64_t (value), unit);
+  }
+  /**
+   * Time::ToInteger.
+   * \param [in] time The Time.
+   * \param [in] unit The unit to convert to.
+   * \returns The value of \p time in \p unit.
+   */
+  static int64_t ToInteger (const Time &time, Time::Unit unit)
+  {
+    bool coarser;
+    int64_t factor = Factor (unit, coarser);
+    int64_t v = time.GetTimeStep ();
+    if (coarser)
+      {
+        v /= factor;
+      }
+    else
+      {
+        v *= factor;
+      }
+    return v;
+  }
+  /**
+   * Get values to convert: small and large, whole and fractional,
+   * positive and negative.
+   * \returns The values.
+   */
+  static std::vector<double> GetValues (void)
+  {
+    const double fixed[] = {
+      0, 1, -1, 0.5, -0.5, 0.1, -0.1, 0.25, 1e-3, 1e-6, 1e-9, 1e-12,
+      1.5, 2.5, -3.75, 7, 10, 59, 60, 100, 999, 1000, 1001, 3600, 86400,
+      123456789, -123456789, 0.999999999, 1.000000001, 1e9, 1e12, 1e15,
+      292, 293, 9223372035, 9223372036, -9223372036, 9223372036854775.0,
+      4611686018427387904.0, -4611686018427387904.0
+    };
+    std::vector<double> values (fixed, fixed + sizeof (fixed) / sizeof (fixed[0]));
+    // A deterministic linear congruential sequence.
+    uint64_t x = 12345;
+    for (int i = 0; i < 2000; i++)
+      {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        int64_t whole = static_cast<int64_t> (x >> 40) - (1 << 23);
+        values.push_back (static_cast<double> (whole));
+        values.push_back (whole / 1024.0);
+        values.push_back (whole * 1e-7);
+      }
+    return values;
+  }
+};
+
+/**
+ * Check that the integer conversions of the default resolution give
+ * exactly the same results as the general ones.
+ */
+class TimeFastPathTestCase : public TestCase
+{
+public:
+  TimeFastPathTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeFastPathTestCase::TimeFastPathTestCase ()
+  : TestCase ("Check the conversions of the default resolution bit for bit")
+{
+}
+
+void
+TimeFastPathTestCase::DoRun (void)
+{
+  std::vector<double> values = TimeReference::GetValues ();
+  for (int u = Time::Y; u < Time::LAST; u++)
+    {
+      Time::Unit unit = static_cast<Time::Unit> (u);
+      bool coarser;
+      int64_t factor = TimeReference::Factor (unit, coarser);
+      int64_t limit = coarser ? std::numeric_limits<int64_t>::max () / factor
+                              : std::numeric_limits<int64_t>::max ();
+      for (std::vector<double>::const_iterator i = values.begin (); i != values.end (); ++i)
+        {
+          double value = *i;
+          if (value > -limit && value < limit)
+            {
+              NS_TEST_ASSERT_MSG_EQ (Time::FromDouble (value, unit).GetTimeStep (),
+                                     TimeReference::FromDouble (value, unit).GetTimeStep (),
+                                     "FromDouble (" << value << ", " << u << ")");
+            }
+          int64_t whole = static_cast<int64_t> (value);
+          if (value != whole || whole <= -limit || whole >= limit)
+            {
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ (Time::FromInteger (whole, unit).GetTimeStep (),
+                                 TimeReference::FromInteger (whole, unit).GetTimeStep (),
+                                 "FromInteger (" << whole << ", " << u << ")");
+          Time t = TimeStep (whole);
+          NS_TEST_ASSERT_MSG_EQ (t.ToInteger (unit), TimeReference::ToInteger (t, unit),
+                                 "ToInteger (" << whole << ", " << u << ")");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (Seconds (1).GetTimeStep (),
+                         TimeReference::FromDouble (1, Time::S).GetTimeStep (),
+                         "Seconds (1)");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (-2.0).GetTimeStep (),
+                         TimeReference::FromDouble (-2.0, Time::S).GetTimeStep (),
+                         "Seconds (-2.0)");
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (-5).GetTimeStep (),
+                         TimeReference::FromInteger (-5, Time::MS).GetTimeStep (),
+                         "MilliSeconds (-5)");
+}
+
+/**
+ * Compare the speed of the conversions with the general ones.
+ */
+class TimeConversionSpeedTestCase : public TestCase
+{
+public:
+  TimeConversionSpeedTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Print the time per operation.
+   * \param [in] how The operation.
+   * \param [in] delta The number of clock ticks.
+   */
+  void Report (const std::string &how, clock_t delta) const;
+  /** Number of conversions of each kind. */
+  static const int REPETITIONS = 10000000;
+};
+
+TimeConversionSpeedTestCase::TimeConversionSpeedTestCase ()
+  : TestCase ("Time conversion speed")
+{
+}
+
+void
+TimeConversionSpeedTestCase::Report (const std::string &how, clock_t delta) const
+{
+  double per = 1e9 * double (delta) / (double (REPETITIONS) * CLOCKS_PER_SEC);
+  std::cout << GetParent ()->GetName () << " " << how << ": "
+            << "ticks: " << delta
+            << "\tper: " << per << " ns/conversion"
+            << std::endl;
+}
+
+void
+TimeConversionSpeedTestCase::DoRun (void)
+{
+  // Stop recording the Time instances, as during a simulation.
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // Volatile, so the loops cannot be folded.
+  volatile double seconds = 1.0;
+  volatile uint64_t milliseconds = 1;
+  int64_t fast = 0;
+  int64_t reference = 0;
+
+  clock_t start = clock ();
+  for (int i = 0; i < REPETITIONS; i++)
+    {
+      fast += Seconds (seconds).GetTimeStep ();
+    }
+  Report ("Seconds (double)", clock () - start);
+  start = clock ();
+  for (int i = 0; i < REPETITIONS; i++)
+    {
+      reference += TimeReference::FromDouble (seconds, Time::S).GetTimeStep ();
+    }
+  Report ("int64x64_t from seconds", clock () - start);
+  NS_TEST_ASSERT_MSG_EQ (fast, reference, "Seconds (double)");
+
+  fast = 0;
+  reference = 0;
+  start = clock ();
+  for (int i = 0; i < REPETITIONS; i++)
+    {
+      fast += MilliSeconds (milliseconds).GetMilliSeconds ();
+    }
+  Report ("MilliSeconds (uint64_t).GetMilliSeconds ()", clock () - start);
+  start = clock ();
+  for (int i = 0; i < REPETITIONS; i++)
+    {
+      Time t = TimeReference::FromInteger (milliseconds, Time::MS);
+      reference += TimeReference::ToInteger (t, Time::MS);
+    }
+  Report ("general milliseconds round trip", clock () - start);
+  NS_TEST_ASSERT_MSG_EQ (fast, reference, "MilliSeconds (uint64_t)");
+}
     
 static class TimeTestSuite : public TestSuite
 {
@@ -238,9 +499,21 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeFastPathTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
 } g_timeTestSuite;
 
-
+/**
+ * The Time conversion speed test suite.
+ */
+static class TimePerformanceTestSuite : public TestSuite
+{
+public:
+  TimePerformanceTestSuite ()
+    : TestSuite ("time-perf", PERFORMANCE)
+  {
+    AddTestCase (new TimeConversionSpeedTestCase (), TestCase::QUICK);
+  }
+} g_timePerformanceTestSuite;
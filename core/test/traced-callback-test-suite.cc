@@ -18,6 +18,10 @@
 
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
 
 using namespace ns3;
 
@@ -108,6 +112,73 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ReentrantTracedCallbackTestCase : public TestCase
+{
+public:
+  ReentrantTracedCallbackTestCase ();
+  virtual ~ReentrantTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbOnce (int a);
+  void CbAdded (int a);
+
+  TracedCallback<int> m_trace;
+  std::string m_calls;
+};
+
+ReentrantTracedCallbackTestCase::ReentrantTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback changes while the chain is invoked")
+{
+}
+
+void
+ReentrantTracedCallbackTestCase::CbOnce (int a)
+{
+  m_calls += "once ";
+  // Replace this callback by another one: the current invocation of
+  // the chain is not affected.
+  m_trace.DisconnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbOnce, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbAdded, this));
+}
+
+void
+ReentrantTracedCallbackTestCase::CbAdded (int a)
+{
+  m_calls += "added ";
+}
+
+void
+ReentrantTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New TracedCallback is not empty");
+  m_trace.ConnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbOnce, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Connected TracedCallback is empty");
+
+  //
+  // A copy of a TracedCallback has its own chain.
+  //
+  TracedCallback<int> copy = m_trace;
+
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "once ", "Callbacks connected while invoking were called");
+  m_trace (2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "once added ", "Callbacks not updated after invoking");
+
+  m_calls = "";
+  copy.DisconnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbAdded, this));
+  NS_TEST_ASSERT_MSG_EQ (copy.IsEmpty (), false, "Disconnecting an unknown callback emptied the chain");
+  m_trace (3);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "added ", "Copy shares the changes of its original");
+
+  m_trace.DisconnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbAdded, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback is not empty");
+  m_calls = "";
+  m_trace (4);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "", "Disconnected callback called");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +189,112 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ReentrantTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
+
+
+// A packet-like trace argument, passed by Ptr as the packet trace
+// sources do.
+class TracedCallbackTestPayload : public SimpleRefCount<TracedCallbackTestPayload>
+{
+public:
+  TracedCallbackTestPayload () : m_size (0) {}
+  uint32_t m_size;
+};
+
+class TracedCallbackTimeTestCase : public TestCase
+{
+public:
+  TracedCallbackTimeTestCase ();
+  virtual ~TracedCallbackTimeTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void Sink (Ptr<const TracedCallbackTestPayload> payload);
+  void Report (std::string what, std::clock_t ticks) const;
+
+  enum { CALLS = 10000000 };
+  uint32_t m_received;
+};
+
+TracedCallbackTimeTestCase::TracedCallbackTimeTestCase ()
+  : TestCase ("Measure the cost of a packet trace source with 0, 1 and 8 sinks")
+{
+}
+
+void
+TracedCallbackTimeTestCase::Sink (Ptr<const TracedCallbackTestPayload> payload)
+{
+  m_received += payload->m_size;
+}
+
+void
+TracedCallbackTimeTestCase::Report (std::string what, std::clock_t ticks) const
+{
+  double per = 1E9 * double (ticks) / (double (CALLS) * CLOCKS_PER_SEC);
+  std::cout << "  " << what << ": " << per << " ns" << std::endl;
+}
+
+void
+TracedCallbackTimeTestCase::DoRun (void)
+{
+  TracedCallback<Ptr<const TracedCallbackTestPayload> > trace;
+  Ptr<TracedCallbackTestPayload> payload = Create<TracedCallbackTestPayload> ();
+  payload->m_size = 1;
+  std::cout << GetName () << ", time per call:" << std::endl;
+
+  m_received = 0;
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < CALLS; i++)
+    {
+      trace (payload);
+    }
+  Report ("0 sinks", std::clock () - start);
+
+  start = std::clock ();
+  for (uint32_t i = 0; i < CALLS; i++)
+    {
+      if (!trace.IsEmpty ())
+        {
+          trace (payload);
+        }
+    }
+  Report ("0 sinks, IsEmpty () tested", std::clock () - start);
+
+  uint32_t connected = 0;
+  for (uint32_t sinks = 1; sinks <= 8; sinks *= 8)
+    {
+      for (; connected < sinks; connected++)
+        {
+          trace.ConnectWithoutContext (MakeCallback (&TracedCallbackTimeTestCase::Sink, this));
+        }
+      m_received = 0;
+      start = std::clock ();
+      for (uint32_t i = 0; i < CALLS; i++)
+        {
+          trace (payload);
+        }
+      std::clock_t ticks = std::clock () - start;
+      std::ostringstream oss;
+      oss << sinks << " sinks";
+      Report (oss.str (), ticks);
+      NS_TEST_ASSERT_MSG_EQ (m_received, sinks * CALLS, "Sinks not called");
+    }
+}
+
+class TracedCallbackPerformanceTestSuite : public TestSuite
+{
+public:
+  TracedCallbackPerformanceTestSuite ();
+};
+
+TracedCallbackPerformanceTestSuite::TracedCallbackPerformanceTestSuite ()
+  : TestSuite ("traced-callback-perf", PERFORMANCE)
+{
+  AddTestCase (new TracedCallbackTimeTestCase, TestCase::QUICK);
+}
+
+static TracedCallbackPerformanceTestSuite tracedCallbackPerformanceTestSuite;
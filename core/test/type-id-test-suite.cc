@@ -25,6 +25,7 @@
 #include "ns3/integer.h"
 #include "ns3/double.h"
 #include "ns3/object.h"
+#include "ns3/object-factory.h"
 #include "ns3/traced-value.h"
 #include "ns3/type-id.h"
 #include "ns3/test.h"
@@ -325,6 +326,119 @@ DeprecatedAttributeTestCase::DoRun (void)
        << endl;
 }
 
+
+//----------------------------
+//
+// Inherited Attribute and TraceSource lookup test
+
+// Registered only for this test, since the test adds an Attribute to it
+class LookupIndexParent : public Object
+{
+private:
+  int m_attr;
+  TracedValue<double> m_trace;
+
+public:
+  LookupIndexParent () : m_attr (0) { NS_UNUSED (m_attr); };
+  virtual ~LookupIndexParent () { };
+
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("LookupIndexParent")
+      .SetParent<Object> ()
+      .AddAttribute ("attribute",
+                     "the Attribute",
+                     IntegerValue (1),
+                     MakeIntegerAccessor (&LookupIndexParent::m_attr),
+                     MakeIntegerChecker<int> ())
+      .AddTraceSource ("trace",
+                       "the TraceSource",
+                       MakeTraceSourceAccessor (&LookupIndexParent::m_trace),
+                       "ns3::TracedValueCallback::Double")
+      ;
+    return tid;
+  }
+};
+
+class LookupIndexChild : public LookupIndexParent
+{
+private:
+  int m_childAttr;
+
+public:
+  LookupIndexChild () : m_childAttr (0) { NS_UNUSED (m_childAttr); };
+  virtual ~LookupIndexChild () { };
+
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("LookupIndexChild")
+      .SetParent<LookupIndexParent> ()
+      .AddAttribute ("childAttribute",
+                     "the child Attribute",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&LookupIndexChild::m_childAttr),
+                     MakeIntegerChecker<int> ())
+      ;
+    return tid;
+  }
+};
+
+
+class LookupIndexTestCase : public TestCase
+{
+public:
+  LookupIndexTestCase ();
+  virtual ~LookupIndexTestCase ();
+private:
+  virtual void DoRun (void);
+
+};
+
+LookupIndexTestCase::LookupIndexTestCase ()
+  : TestCase ("Check inherited and late registered Attributes and TraceSources")
+{
+}
+
+LookupIndexTestCase::~LookupIndexTestCase ()
+{
+}
+
+void
+LookupIndexTestCase::DoRun (void)
+{
+  TypeId tid = LookupIndexChild::GetTypeId ();
+
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("childAttribute", &ainfo), true,
+                         "lookup own attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "childAttribute", "wrong own attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("attribute", &ainfo), true,
+                         "lookup inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the Attribute", "wrong inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("missing", &ainfo), false,
+                         "lookup missing attribute");
+
+  struct TypeId::TraceSourceInformation tinfo;
+  Ptr<const TraceSourceAccessor> acc = tid.LookupTraceSourceByName ("trace", &tinfo);
+  NS_TEST_ASSERT_MSG_NE (acc, 0, "lookup inherited trace source");
+  acc = tid.LookupTraceSourceByName ("missing", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (acc, 0, "lookup missing trace source");
+
+  // Attributes registered after a lookup are found too.
+  TypeId parent = LookupIndexParent::GetTypeId ();
+  if (!parent.LookupAttributeByName ("lateAttribute", &ainfo))
+    {
+      parent.AddAttribute ("lateAttribute",
+                           "the late Attribute",
+                           EmptyAttributeValue (),
+                           MakeEmptyAttributeAccessor (),
+                           MakeEmptyAttributeChecker ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("lateAttribute", &ainfo), true,
+                         "lookup late attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the late Attribute", "wrong late attribute");
+}
+
   
 //----------------------------
 //
@@ -414,6 +528,135 @@ LookupTimeTestCase::Report (const std::string how,
 }
 
 
+//----------------------------
+//
+// Object construction performance test
+
+class ConstructionTimeTestCase : public TestCase
+{
+public:
+  ConstructionTimeTestCase ();
+  virtual ~ConstructionTimeTestCase ();
+private:
+  void DoRun (void);
+  void Construct (const TypeId tid);
+  void Report (const TypeId tid, const std::string what,
+               const uint32_t reps, const uint32_t delta) const;
+
+  enum { REPETITIONS = 100000 };
+};
+
+ConstructionTimeTestCase::ConstructionTimeTestCase ()
+  : TestCase ("Measure object construction and lookup time")
+{
+}
+
+ConstructionTimeTestCase::~ConstructionTimeTestCase ()
+{
+}
+
+void
+ConstructionTimeTestCase::DoRun (void)
+{
+  cout << suite << endl;
+  cout << suite << GetName () << endl;
+
+  // The core module types are always there; the others only when
+  // their modules are linked in.
+  const char *names[] = {
+    "ns3::WifiNetDevice",
+    "ns3::Ipv4L3Protocol",
+    "ns3::UniformRandomVariable"
+  };
+  for (uint32_t i = 0; i < sizeof (names) / sizeof (names[0]); ++i)
+    {
+      TypeId tid;
+      if (!TypeId::LookupByNameFailSafe (names[i], &tid))
+        {
+          cout << suite << names[i] << ": not registered, skipped" << endl;
+          continue;
+        }
+      Construct (tid);
+    }
+}
+
+void
+ConstructionTimeTestCase::Construct (const TypeId tid)
+{
+  // Collect the names of all the attributes and trace sources,
+  // inherited ones included, as the topology helpers use them.
+  std::vector<std::string> attributes;
+  std::vector<std::string> traceSources;
+  TypeId next = tid;
+  TypeId current;
+  do
+    {
+      current = next;
+      for (uint32_t i = 0; i < current.GetAttributeN (); ++i)
+        {
+          if (current.GetAttribute (i).supportLevel == TypeId::SUPPORTED)
+            {
+              attributes.push_back (current.GetAttribute (i).name);
+            }
+        }
+      for (uint32_t i = 0; i < current.GetTraceSourceN (); ++i)
+        {
+          if (current.GetTraceSource (i).supportLevel == TypeId::SUPPORTED)
+            {
+              traceSources.push_back (current.GetTraceSource (i).name);
+            }
+        }
+      next = current.GetParent ();
+    } while (next != current);
+
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  int start = clock ();
+  for (uint32_t j = 0; j < REPETITIONS; ++j)
+    {
+      Ptr<Object> object = factory.Create ();
+    }
+  int stop = clock ();
+  Report (tid, "construction", REPETITIONS, stop - start);
+
+  uint32_t found = 0;
+  struct TypeId::AttributeInformation ainfo;
+  start = clock ();
+  for (uint32_t j = 0; j < REPETITIONS; ++j)
+    {
+      for (uint32_t i = 0; i < attributes.size (); ++i)
+        {
+          found += tid.LookupAttributeByName (attributes[i], &ainfo);
+        }
+      for (uint32_t i = 0; i < traceSources.size (); ++i)
+        {
+          found += (tid.LookupTraceSourceByName (traceSources[i]) != 0);
+        }
+    }
+  stop = clock ();
+  uint32_t lookups = attributes.size () + traceSources.size ();
+  NS_TEST_ASSERT_MSG_EQ (found, REPETITIONS * lookups,
+                         "missing attributes or trace sources");
+  Report (tid, "lookup", REPETITIONS * lookups, stop - start);
+}
+
+void
+ConstructionTimeTestCase::Report (const TypeId tid,
+                                  const std::string what,
+                                  const uint32_t reps,
+                                  const uint32_t delta) const
+{
+  double per = 1E6 * double (delta) / (double (reps) * double (CLOCKS_PER_SEC));
+
+  cout << suite << tid.GetName () << ": " << what << ": "
+       << "reps: " << reps
+       << "\tticks: " << delta
+       << "\tper: " << per
+       << " microsec"
+       << endl;
+}
+
+
 //----------------------------
 //
 // TypeId test suites
@@ -437,6 +680,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new LookupIndexTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
@@ -452,6 +696,7 @@ TypeIdPerformanceSuite::TypeIdPerformanceSuite ()
   : TestSuite ("type-id-perf", PERFORMANCE)
 {
   AddTestCase (new LookupTimeTestCase, QUICK);
+  AddTestCase (new ConstructionTimeTestCase, QUICK);
 }
 
 static TypeIdPerformanceSuite g_TypeIdPerformanceSuite;
@@ -0,0 +1,851 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/free-list-allocator.h"
+#include "ns3/uinteger.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** Time stamp of an empty event list. */
+const uint64_t NEVER = ~static_cast<uint64_t> (0);
+
+/** Number of polls of the barrier before yielding the processor. */
+const uint32_t BARRIER_SPINS = 128;
+
+} // unnamed namespace
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mtp")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of threads executing events, "
+                   "0 to use one thread per processor.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LookAhead",
+                   "The smallest delay of the events scheduled in another context, "
+                   "0 to compute it from the delay of the point-to-point channels.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookAhead),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_global = new Partition;
+  m_global->m_currentTs = 0;
+  // before ::Run is entered, the m_currentUid will be zero
+  m_global->m_currentUid = 0;
+  m_global->m_context = Simulator::NO_CONTEXT;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  m_global->m_uid = 4;
+  m_global->m_sent = 0;
+  m_global->m_unscheduledEvents = 0;
+  m_global->m_inbox = 0;
+  m_orphans = 0;
+  m_stop = false;
+  m_done = false;
+  m_windowEnd = 0;
+  m_lookAheadTs = NEVER;
+  m_nThreads = 1;
+  m_nextWorker = 1;
+  m_barrierCount = 0;
+  m_barrierGeneration = 0;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Message *message = m_orphans.exchange (0);
+  while (message != 0)
+    {
+      Message *next = message->m_next;
+      message->m_event->Unref ();
+      FreeListAllocator::Deallocate (message, sizeof (Message));
+      message = next;
+    }
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      if (partition == 0)
+        {
+          continue;
+        }
+      Drain (partition);
+      while (!partition->m_events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->m_events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        CriticalSection cs (m_destroyMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      if (*i == 0)
+        {
+          continue;
+        }
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      Ptr<Scheduler> events = (*i)->m_events;
+      if (events != 0)
+        {
+          while (!events->IsEmpty ())
+            {
+              scheduler->Insert (events->RemoveNext ());
+            }
+        }
+      (*i)->m_events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Current (void) const
+{
+  return m_current != 0 ? m_current : m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Find (uint32_t context) const
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_global;
+    }
+  return context < m_partitions.size () ? m_partitions[context] : 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::CreatePartition (uint32_t context)
+{
+  NS_LOG_FUNCTION (this << context);
+  NS_ASSERT (context != Simulator::NO_CONTEXT && Find (context) == 0);
+  Partition *partition = new Partition;
+  partition->m_events = m_schedulerFactory.Create<Scheduler> ();
+  partition->m_currentTs = 0;
+  partition->m_currentUid = 0;
+  partition->m_context = context;
+  partition->m_uid = 4;
+  partition->m_sent = 0;
+  partition->m_unscheduledEvents = 0;
+  partition->m_inbox = 0;
+  if (context >= m_partitions.size ())
+    {
+      m_partitions.resize (context + 1, 0);
+    }
+  m_partitions[context] = partition;
+  if (!m_threadPartitions.empty ())
+    {
+      m_threadPartitions[context % m_nThreads].push_back (partition);
+    }
+  return partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = partition->m_context;
+  ev.key.m_uid = partition->m_uid;
+  partition->m_uid++;
+  partition->m_unscheduledEvents++;
+  partition->m_events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Post (Partition *source, Partition *destination,
+                                  uint32_t context, uint64_t ts, EventImpl *event)
+{
+  Message *message = static_cast<Message *> (FreeListAllocator::Allocate (sizeof (Message)));
+  message->m_ts = ts;
+  message->m_context = context;
+  message->m_source = source->m_context;
+  message->m_seq = source->m_sent;
+  message->m_event = event;
+  source->m_sent++;
+
+  std::atomic<Message *> &inbox = destination != 0 ? destination->m_inbox : m_orphans;
+  message->m_next = inbox.load (std::memory_order_relaxed);
+  while (!inbox.compare_exchange_weak (message->m_next, message,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed))
+    {
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::MessageLess (const Message *a, const Message *b)
+{
+  if (a->m_ts != b->m_ts)
+    {
+      return a->m_ts < b->m_ts;
+    }
+  if (a->m_source != b->m_source)
+    {
+      return a->m_source < b->m_source;
+    }
+  return a->m_seq < b->m_seq;
+}
+
+void
+MultithreadedSimulatorImpl::Drain (Partition *partition)
+{
+  Message *message = partition->m_inbox.exchange (0, std::memory_order_acquire);
+  if (message == 0)
+    {
+      return;
+    }
+  // The inbox is in reverse order of arrival, which depends on the
+  // thread timings: sort it to assign the uids deterministically.
+  std::vector<Message *> messages;
+  for (; message != 0; message = message->m_next)
+    {
+      messages.push_back (message);
+    }
+  std::sort (messages.begin (), messages.end (), &MultithreadedSimulatorImpl::MessageLess);
+  for (std::vector<Message *>::const_iterator i = messages.begin (); i != messages.end (); ++i)
+    {
+      NS_ASSERT ((*i)->m_ts >= partition->m_currentTs);
+      Insert (partition, (*i)->m_ts, (*i)->m_event);
+      FreeListAllocator::Deallocate (*i, sizeof (Message));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DrainOrphans (void)
+{
+  Message *message = m_orphans.exchange (0, std::memory_order_acquire);
+  std::vector<Message *> messages;
+  for (; message != 0; message = message->m_next)
+    {
+      messages.push_back (message);
+    }
+  std::sort (messages.begin (), messages.end (), &MultithreadedSimulatorImpl::MessageLess);
+  for (std::vector<Message *>::const_iterator i = messages.begin (); i != messages.end (); ++i)
+    {
+      uint32_t context = (*i)->m_context;
+      Partition *partition = Find (context);
+      if (partition == 0)
+        {
+          partition = CreatePartition (context);
+        }
+      Insert (partition, (*i)->m_ts, (*i)->m_event);
+      uint64_t &next = m_threadNextTs[context % m_nThreads];
+      next = std::min (next, (*i)->m_ts);
+      FreeListAllocator::Deallocate (*i, sizeof (Message));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->m_events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->m_currentTs);
+  partition->m_unscheduledEvents--;
+
+  partition->m_currentTs = next.key.m_ts;
+  partition->m_currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (Partition *partition, uint64_t end)
+{
+  m_current = partition;
+  while (!partition->m_events->IsEmpty ()
+         && partition->m_events->PeekNext ().key.m_ts < end)
+    {
+      ProcessOneEvent (partition);
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == m_nThreads)
+    {
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+    {
+      if (++spins > BARRIER_SPINS)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Coordinate (void)
+{
+  Drain (m_global);
+  DrainOrphans ();
+
+  uint64_t next = NEVER;
+  for (uint32_t i = 0; i < m_nThreads; i++)
+    {
+      next = std::min (next, m_threadNextTs[i]);
+    }
+  uint64_t global = NEVER;
+  if (!m_global->m_events->IsEmpty ())
+    {
+      global = m_global->m_events->PeekNext ().key.m_ts;
+    }
+
+  if (m_stop || (next == NEVER && global == NEVER))
+    {
+      m_done = true;
+      return;
+    }
+  if (global <= next)
+    {
+      // The global events may touch any node: run them alone.
+      m_current = m_global;
+      while (!m_stop
+             && !m_global->m_events->IsEmpty ()
+             && m_global->m_events->PeekNext ().key.m_ts == global)
+        {
+          ProcessOneEvent (m_global);
+        }
+      m_current = 0;
+      m_windowEnd = 0;
+      return;
+    }
+  // No event posted during the window can fall before its end.
+  m_windowEnd = m_lookAheadTs >= global - next ? global : next + m_lookAheadTs;
+}
+
+bool
+MultithreadedSimulatorImpl::DoRound (uint32_t thread)
+{
+  std::vector<Partition *> &partitions = m_threadPartitions[thread];
+  uint64_t next = NEVER;
+  for (std::vector<Partition *>::const_iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Drain (*i);
+      if (!(*i)->m_events->IsEmpty ())
+        {
+          next = std::min (next, (*i)->m_events->PeekNext ().key.m_ts);
+        }
+    }
+  m_threadNextTs[thread] = next;
+
+  Barrier ();
+  if (thread == 0)
+    {
+      Coordinate ();
+    }
+  Barrier ();
+
+  if (m_done)
+    {
+      return false;
+    }
+  if (m_windowEnd != 0)
+    {
+      for (std::vector<Partition *>::const_iterator i = partitions.begin (); i != partitions.end (); ++i)
+        {
+          ProcessWindow (*i, m_windowEnd);
+        }
+    }
+  Barrier ();
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (void)
+{
+  uint32_t thread = m_nextWorker.fetch_add (1);
+  NS_LOG_FUNCTION (this << thread);
+  while (DoRound (thread))
+    {
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_lookAhead.IsZero ())
+    {
+      m_lookAheadTs = m_lookAhead.GetTimeStep ();
+      return;
+    }
+
+  m_lookAheadTs = NEVER;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> device = (*node)->GetDevice (i);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          bool remote = false;
+          for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              if (channel->GetDevice (j)->GetNode () != *node)
+                {
+                  remote = true;
+                }
+            }
+          if (!remote)
+            {
+              continue;
+            }
+
+          // Only the channels which connect exactly two devices have
+          // no state shared by the nodes.
+          TypeId tid = channel->GetInstanceTypeId ();
+          struct TypeId::AttributeInformation info;
+          if (!device->IsPointToPoint () || !tid.LookupAttributeByName ("Delay", &info))
+            {
+              NS_FATAL_ERROR ("Cannot compute the lookahead of channel " << tid.GetName ()
+                              << ": set ns3::MultithreadedSimulatorImpl::LookAhead");
+            }
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          m_lookAheadTs = std::min (m_lookAheadTs,
+                                    static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+        }
+    }
+  if (m_lookAheadTs == 0)
+    {
+      NS_FATAL_ERROR ("A channel between two nodes has no delay: the lookahead is zero");
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookAheadTs);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  CalculateLookAhead ();
+
+  m_nThreads = m_threadCount;
+  if (m_nThreads == 0)
+    {
+      m_nThreads = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  m_threadPartitions.assign (m_nThreads, std::vector<Partition *> ());
+  m_threadNextTs.assign (m_nThreads, NEVER);
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (*i != 0)
+        {
+          m_threadPartitions[(*i)->m_context % m_nThreads].push_back (*i);
+        }
+    }
+  m_stop = false;
+  m_done = false;
+  m_windowEnd = 0;
+  m_barrierCount = 0;
+  m_nextWorker = 1;
+
+  // The packets sent to another node may be used by another thread.
+  bool multithreaded = Packet::IsMultithreaded ();
+  if (m_nThreads > 1)
+    {
+      Packet::EnableMultithreading ();
+    }
+  std::vector<Ptr<SystemThread> > workers;
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> worker =
+        Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::RunWorker, this));
+      worker->Start ();
+      workers.push_back (worker);
+    }
+  while (DoRound (0))
+    {
+    }
+  for (std::vector<Ptr<SystemThread> >::const_iterator i = workers.begin (); i != workers.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threadPartitions.clear ();
+  if (!multithreaded)
+    {
+      Packet::DisableMultithreading ();
+    }
+
+  // The main program resumes at the time of the last event.
+  bool empty = m_global->m_events->IsEmpty ();
+  int unscheduledEvents = m_global->m_unscheduledEvents;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (*i != 0)
+        {
+          m_global->m_currentTs = std::max (m_global->m_currentTs, (*i)->m_currentTs);
+          empty = empty && (*i)->m_events->IsEmpty ();
+          unscheduledEvents += (*i)->m_unscheduledEvents;
+        }
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!empty || unscheduledEvents == 0);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Partition *source = Current ();
+  uint64_t ts = source->m_currentTs + delay.GetTimeStep ();
+  EventImpl *event = MakeEvent (&Simulator::Stop);
+  if (source == m_global)
+    {
+      Insert (m_global, ts, event);
+    }
+  else
+    {
+      // Exempt from the lookahead: the simulation may stop a bit late.
+      Post (source, m_global, Simulator::NO_CONTEXT, ts, event);
+    }
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+
+  Partition *partition = Current ();
+  Time tAbsolute = delay + TimeStep (partition->m_currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->m_currentTs));
+  uint64_t ts = tAbsolute.GetTimeStep ();
+  uint32_t uid = Insert (partition, ts, event);
+  return EventId (event, ts, partition->m_context, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+
+  Partition *source = Current ();
+  uint64_t ts = source->m_currentTs + delay.GetTimeStep ();
+  if (context == source->m_context)
+    {
+      Insert (source, ts, event);
+      return;
+    }
+  Partition *destination = Find (context);
+  if (source == m_global)
+    {
+      // Only the main thread runs: the other logical processes can be
+      // accessed directly.
+      if (destination == 0)
+        {
+          destination = CreatePartition (context);
+        }
+      Insert (destination, ts, event);
+      return;
+    }
+  if (static_cast<uint64_t> (delay.GetTimeStep ()) < m_lookAheadTs)
+    {
+      NS_FATAL_ERROR ("Event scheduled in context " << context << " from context "
+                      << source->m_context << " with delay " << delay
+                      << ", less than the lookahead " << TimeStep (m_lookAheadTs));
+    }
+  Post (source, destination, context, ts, event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::ScheduleNow Thread-unsafe invocation!");
+
+  Partition *partition = Current ();
+  uint32_t uid = Insert (partition, partition->m_currentTs, event);
+  return EventId (event, partition->m_currentTs, partition->m_context, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Current ()->m_currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (Current ()->m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Current ()->m_currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = Find (id.GetContext ());
+  NS_ASSERT_MSG (partition == Current () || Current () == m_global,
+                 "Simulator::Remove of an event of another context");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->m_events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->m_unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // Only the events scheduled in the current context have an EventId,
+  // so their logical process exists.
+  const Partition *partition = Find (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      partition == 0 ||
+      id.GetTs () < partition->m_currentTs ||
+      (id.GetTs () == partition->m_currentTs &&
+       id.GetUid () <= partition->m_currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  if (!m_global->m_events->IsEmpty () || m_global->m_inbox.load () != 0 || m_orphans.load () != 0)
+    {
+      return false;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (*i != 0 && (!(*i)->m_events->IsEmpty () || (*i)->m_inbox.load () != 0))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return Current ()->m_context;
+}
+
+} // namespace ns3
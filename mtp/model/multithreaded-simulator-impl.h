@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup mtp
+ *
+ * \brief A conservative parallel simulator implementation for shared
+ * memory machines.
+ *
+ * Every event context (a node id, in practice) is a logical process
+ * with its own event list, current time and event uids. Events without
+ * context (Simulator::NO_CONTEXT), such as those scheduled by the
+ * main program, belong to a separate global logical process.
+ *
+ * The simulation advances in rounds. Each round the logical processes
+ * are spread over ThreadCount threads, which execute in parallel all
+ * the events earlier than the end of a window:
+ *
+ *     window = min (T + lookahead, g)
+ *
+ * where T is the earliest pending event of all the node logical
+ * processes and g the earliest pending global event. Whenever g comes
+ * first, the global events at g run alone on the main thread, so they
+ * can safely touch any node.
+ *
+ * An event may schedule events in its own context with any delay. To
+ * schedule an event in another context, it has to use a delay of at
+ * least the lookahead, which guarantees that the new event falls
+ * after the current window. Such events are posted in a lock-free
+ * inbox of the destination and moved to its event list at the start
+ * of the next round, sorted by time stamp, sending context and
+ * sending order. The outcome of a simulation is therefore identical
+ * whatever the number of threads, but for the packet uids, which are
+ * allocated in the order the threads create the packets.
+ *
+ * The lookahead is the LookAhead attribute when it is set, otherwise
+ * the smallest "Delay" attribute of the point-to-point channels which
+ * connect different nodes, as computed by the distributed simulator.
+ * A simulation with other channels between nodes must set the
+ * LookAhead attribute, and the channels must only let a node touch the
+ * state of another node through ScheduleWithContext().
+ *
+ * The reference counts of the objects and of the data shared by the
+ * copies of a packet are not atomic. While several threads run,
+ * Packet::IsMultithreaded() returns true, and a channel must then hand
+ * Packet::DeepCopy() copies to the receiving node, and neither take
+ * nor release a reference to the receiving device or node, as the
+ * PointToPointChannel does.
+ *
+ * Limitations:
+ *  - the models executed in parallel must not share mutable state
+ *    other than through ScheduleWithContext(), nor Ptr to the objects
+ *    of another node;
+ *  - an EventId can only be cancelled, removed or tested by events of
+ *    its own context, or by global events;
+ *  - Stop() called by a node event ends the simulation at the end of
+ *    the current window; Stop(delay) may overshoot by less than the
+ *    lookahead;
+ *  - events cannot be scheduled from threads other than the simulator
+ *    threads.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event posted to the logical process of another context. */
+  struct Message
+  {
+    Message *m_next;      /**< Next message in the inbox. */
+    uint64_t m_ts;        /**< Absolute time stamp of the event. */
+    uint32_t m_context;   /**< Destination context. */
+    uint32_t m_source;    /**< Context of the sending logical process. */
+    uint32_t m_seq;       /**< Sending order in the sending logical process. */
+    EventImpl *m_event;   /**< The event implementation. */
+  };
+
+  /** A logical process: the events of one context. */
+  struct Partition
+  {
+    /** The event priority queue. */
+    Ptr<Scheduler> m_events;
+    /** Timestamp of the current event. */
+    uint64_t m_currentTs;
+    /** Unique id of the current event. */
+    uint32_t m_currentUid;
+    /** The context of all the events. */
+    uint32_t m_context;
+    /** Next event unique id. */
+    uint32_t m_uid;
+    /** Number of messages sent. */
+    uint32_t m_sent;
+    /** Number of events inserted but not yet executed. */
+    int m_unscheduledEvents;
+    /** Events posted by other logical processes. */
+    std::atomic<Message *> m_inbox;
+  };
+
+  /**
+   * Get the logical process of the calling thread.
+   * \returns The logical process running an event, or the global one.
+   */
+  Partition * Current (void) const;
+  /**
+   * Find the logical process of a context.
+   * \param [in] context The context.
+   * \returns The logical process, or 0 if it does not exist yet.
+   */
+  Partition * Find (uint32_t context) const;
+  /**
+   * Create the logical process of a context.
+   * \param [in] context The context.
+   * \returns The new logical process.
+   */
+  Partition * CreatePartition (uint32_t context);
+  /**
+   * Insert an event in a logical process.
+   * \param [in] partition The logical process.
+   * \param [in] ts The absolute time stamp.
+   * \param [in] event The event implementation.
+   * \returns The event uid.
+   */
+  uint32_t Insert (Partition *partition, uint64_t ts, EventImpl *event);
+  /**
+   * Post an event in the inbox of another logical process.
+   * \param [in] source The sending logical process.
+   * \param [in] destination The destination logical process, or 0
+   *             if it does not exist yet.
+   * \param [in] context The destination context.
+   * \param [in] ts The absolute time stamp.
+   * \param [in] event The event implementation.
+   */
+  void Post (Partition *source, Partition *destination,
+             uint32_t context, uint64_t ts, EventImpl *event);
+  /**
+   * Order messages by time stamp, sending context and sending order.
+   * \param [in] a The first message.
+   * \param [in] b The second message.
+   * \returns \c true if \p a comes first.
+   */
+  static bool MessageLess (const Message *a, const Message *b);
+  /**
+   * Move the posted events of a logical process to its event list.
+   * \param [in] partition The logical process.
+   */
+  void Drain (Partition *partition);
+  /** Create the logical processes of the events posted to unknown contexts. */
+  void DrainOrphans (void);
+  /**
+   * Execute the next event of a logical process.
+   * \param [in] partition The logical process.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Execute the events of a logical process up to a time stamp.
+   * \param [in] partition The logical process.
+   * \param [in] end The end of the window (excluded).
+   */
+  void ProcessWindow (Partition *partition, uint64_t end);
+  /**
+   * Execute one round of the simulation, on one thread.
+   * \param [in] thread The thread index.
+   * \returns \c false when the simulation is over.
+   */
+  bool DoRound (uint32_t thread);
+  /** Compute the window of the next round, on the main thread. */
+  void Coordinate (void);
+  /** Entry point of the worker threads. */
+  void RunWorker (void);
+  /** Wait until all the threads reach this point. */
+  void Barrier (void);
+  /** Set the lookahead from the attribute or the channels. */
+  void CalculateLookAhead (void);
+
+  /** The logical process running an event on the calling thread. */
+  static thread_local Partition *m_current;
+
+  /** The logical process of the events without context. */
+  Partition *m_global;
+  /** The logical processes of the contexts, indexed by context. */
+  std::vector<Partition *> m_partitions;
+  /** The logical processes executed by each thread. */
+  std::vector<std::vector<Partition *> > m_threadPartitions;
+  /** Earliest pending event of the logical processes of each thread. */
+  std::vector<uint64_t> m_threadNextTs;
+  /** Events posted to contexts without logical process. */
+  std::atomic<Message *> m_orphans;
+  /** The factory of the event lists. */
+  ObjectFactory m_schedulerFactory;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the destroy events. */
+  mutable SystemMutex m_destroyMutex;
+
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The simulation is over. */
+  bool m_done;
+  /** End of the window of the current round (excluded). */
+  uint64_t m_windowEnd;
+  /** The lookahead attribute, or zero. */
+  Time m_lookAhead;
+  /** The lookahead in use. */
+  uint64_t m_lookAheadTs;
+  /** The ThreadCount attribute. */
+  uint32_t m_threadCount;
+  /** The number of threads of the current run. */
+  uint32_t m_nThreads;
+  /** Index of the next worker thread to start. */
+  std::atomic<uint32_t> m_nextWorker;
+  /** Number of threads which reached the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** Incremented each time all the threads reach the barrier. */
+  std::atomic<uint32_t> m_barrierGeneration;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,580 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/point-to-point-helper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl test suite.
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Number of event contexts. */
+const uint32_t CONTEXTS = 8;
+/** Number of hops of each token. */
+const uint32_t HOPS = 200;
+/** Number of local ticks of each context. */
+const uint32_t TICKS = 40;
+
+/** The events executed by one context: time stamp and event argument. */
+typedef std::vector<std::pair<int64_t, uint32_t> > History;
+
+/** Number of nodes of the point-to-point chain. */
+const uint32_t CHAIN = 4;
+/** Number of packets sent by each end of the chain. */
+const uint32_t PACKETS = 50;
+
+/** The packets received by one node, summarized as strings. */
+typedef std::vector<std::string> Receptions;
+
+} // unnamed namespace
+
+/**
+ * \ingroup mtp
+ * A model of tokens hopping between contexts, with local timers.
+ *
+ * Each context only touches its own history, and the cross-context
+ * delays are at least one millisecond.
+ */
+class MtpTokenModel
+{
+public:
+  /** Constructor. */
+  MtpTokenModel ();
+  /** Schedule the initial events. */
+  void Start (void);
+  /**
+   * A token arrives in a context.
+   * \param [in] context The expected context.
+   * \param [in] hop The number of hops so far.
+   */
+  void Hop (uint32_t context, uint32_t hop);
+  /**
+   * A local timer expires.
+   * \param [in] context The expected context.
+   * \param [in] tick The number of ticks so far.
+   */
+  void Tick (uint32_t context, uint32_t tick);
+  /** A global event, which checks that no context is ahead of it. */
+  void Check (void);
+
+  std::vector<History> m_histories;  //!< The events of each context.
+  std::atomic<uint32_t> m_errors;    //!< Number of events run in the wrong context.
+  bool m_late;                       //!< A context ran ahead of a global event.
+};
+
+MtpTokenModel::MtpTokenModel ()
+  : m_histories (CONTEXTS),
+    m_errors (0),
+    m_late (false)
+{}
+
+void
+MtpTokenModel::Start (void)
+{
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      Simulator::ScheduleWithContext (c, MicroSeconds (c), &MtpTokenModel::Hop, this, c, 0);
+      Simulator::ScheduleWithContext (c, MicroSeconds (3 * c), &MtpTokenModel::Tick, this, c, 0);
+    }
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Schedule (MilliSeconds (7 * i), &MtpTokenModel::Check, this);
+    }
+}
+
+void
+MtpTokenModel::Hop (uint32_t context, uint32_t hop)
+{
+  if (Simulator::GetContext () != context)
+    {
+      m_errors++;
+    }
+  m_histories[context].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), hop));
+  if (hop < HOPS)
+    {
+      uint32_t next = (context * 5 + hop + 1) % CONTEXTS;
+      Time delay = MilliSeconds (1) + MicroSeconds ((context * 31 + hop * 17) % 500);
+      Simulator::ScheduleWithContext (next, delay, &MtpTokenModel::Hop, this, next, hop + 1);
+    }
+}
+
+void
+MtpTokenModel::Tick (uint32_t context, uint32_t tick)
+{
+  if (Simulator::GetContext () != context)
+    {
+      m_errors++;
+    }
+  m_histories[context].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), 1000 + tick));
+  if (tick < TICKS)
+    {
+      Simulator::Schedule (MicroSeconds (250 + context), &MtpTokenModel::Tick, this, context, tick + 1);
+    }
+}
+
+void
+MtpTokenModel::Check (void)
+{
+  if (Simulator::GetContext () != Simulator::NO_CONTEXT)
+    {
+      m_errors++;
+    }
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      if (!m_histories[c].empty () && m_histories[c].back ().first > now)
+        {
+          m_late = true;
+        }
+    }
+}
+
+/**
+ * \ingroup mtp
+ * Compare the events executed with DefaultSimulatorImpl and with
+ * MultithreadedSimulatorImpl with several thread counts.
+ */
+class MtpEquivalenceTestCase : public TestCase
+{
+public:
+  MtpEquivalenceTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  /**
+   * Run the token model.
+   * \param [in] simulatorType The simulator implementation.
+   * \param [in] threads The number of threads.
+   * \returns The history of each context.
+   */
+  std::vector<History> RunModel (std::string simulatorType, uint32_t threads);
+};
+
+MtpEquivalenceTestCase::MtpEquivalenceTestCase ()
+  : TestCase ("Check that the result does not depend on the thread count")
+{}
+
+std::vector<History>
+MtpEquivalenceTestCase::RunModel (std::string simulatorType, uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (threads));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::LookAhead", TimeValue (MilliSeconds (1)));
+
+  MtpTokenModel model;
+  model.Start ();
+  Simulator::Run ();
+  Time end = Simulator::Now ();
+  Simulator::Destroy ();
+
+  std::ostringstream oss;
+  oss << simulatorType << " with " << threads << " threads";
+  NS_TEST_EXPECT_MSG_EQ (model.m_errors.load (), 0, oss.str () << ": event run in the wrong context");
+  NS_TEST_EXPECT_MSG_EQ (model.m_late, false, oss.str () << ": context ahead of a global event");
+  int64_t last = 0;
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      const History &history = model.m_histories[c];
+      NS_TEST_EXPECT_MSG_EQ (history.empty (), false, oss.str ());
+      for (uint32_t i = 1; i < history.size (); i++)
+        {
+          bool ordered = history[i - 1].first <= history[i].first;
+          NS_TEST_EXPECT_MSG_EQ (ordered, true, oss.str () << ": time went backwards");
+        }
+      last = std::max (last, history.back ().first);
+    }
+  NS_TEST_EXPECT_MSG_EQ (end.GetTimeStep (), last, oss.str () << ": wrong time after Run");
+  return model.m_histories;
+}
+
+void
+MtpEquivalenceTestCase::DoRun (void)
+{
+  std::vector<History> reference = RunModel ("ns3::DefaultSimulatorImpl", 1);
+  std::vector<History> serial = RunModel ("ns3::MultithreadedSimulatorImpl", 1);
+  uint32_t threadCounts[] = { 2, 3, 8 };
+  for (uint32_t i = 0; i < sizeof (threadCounts) / sizeof (threadCounts[0]); i++)
+    {
+      std::vector<History> parallel = RunModel ("ns3::MultithreadedSimulatorImpl", threadCounts[i]);
+      for (uint32_t c = 0; c < CONTEXTS; c++)
+        {
+          // Bit for bit identical, including the order of simultaneous events.
+          bool same = parallel[c] == serial[c];
+          NS_TEST_EXPECT_MSG_EQ (same, true, threadCounts[i] << " threads, context " << c);
+        }
+    }
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      // Simultaneous events from different contexts may be ordered
+      // differently by the sequential simulator.
+      std::sort (reference[c].begin (), reference[c].end ());
+      std::sort (serial[c].begin (), serial[c].end ());
+      bool same = reference[c] == serial[c];
+      NS_TEST_EXPECT_MSG_EQ (same, true, "context " << c);
+    }
+}
+
+void
+MtpEquivalenceTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup mtp
+ * Check Simulator::Stop and the events scheduled from the main program
+ * between two runs.
+ */
+class MtpStopTestCase : public TestCase
+{
+public:
+  MtpStopTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+MtpStopTestCase::MtpStopTestCase ()
+  : TestCase ("Check Simulator::Stop")
+{}
+
+void
+MtpStopTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (4));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::LookAhead", TimeValue (MilliSeconds (1)));
+
+  MtpTokenModel model;
+  model.Start ();
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (20), "Stopped at the wrong time");
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      bool early = model.m_histories[c].back ().first < MilliSeconds (20).GetTimeStep ();
+      NS_TEST_EXPECT_MSG_EQ (early, true, "Event executed after Stop");
+    }
+
+  // Resume until the end.
+  Simulator::ScheduleWithContext (0, Seconds (0), &MtpTokenModel::Tick, &model, 0, TICKS);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), true, "Events left");
+  NS_TEST_EXPECT_MSG_EQ (model.m_errors.load (), 0, "Event run in the wrong context");
+  NS_TEST_EXPECT_MSG_EQ (model.m_late, false, "Context ahead of a global event");
+  uint32_t hops = 0;
+  for (uint32_t c = 0; c < CONTEXTS; c++)
+    {
+      for (History::const_iterator i = model.m_histories[c].begin (); i != model.m_histories[c].end (); ++i)
+        {
+          if (i->second == HOPS)
+            {
+              hops++;
+            }
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (hops, CONTEXTS, "Tokens lost");
+  Simulator::Destroy ();
+}
+
+void
+MtpStopTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup mtp
+ * Tagged packets sent by both ends of a chain of nodes connected by
+ * point-to-point links.
+ *
+ * The intermediate nodes modify and forward the packets they receive,
+ * and the senders modify copies of the packets they sent, so that the
+ * nodes of both ends of a link work on packets which would share their
+ * data with a plain Packet::Copy.
+ */
+class MtpPointToPointModel
+{
+public:
+  /** Constructor. */
+  MtpPointToPointModel ();
+  /** Create the nodes and the links, and schedule the packets. */
+  void Start (void);
+  /**
+   * Send a packet from one end of the chain.
+   * \param [in] node The sending node.
+   * \param [in] seq The sequence number of the packet.
+   */
+  void Send (uint32_t node, uint32_t seq);
+  /**
+   * Record a packet and forward it to the next node.
+   * \param [in] device The receiving device.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The address of the sender.
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+
+  NodeContainer m_nodes;                          //!< The chain.
+  std::vector<Ptr<NetDevice> > m_left;            //!< The device of each node towards the previous one.
+  std::vector<Ptr<NetDevice> > m_right;           //!< The device of each node towards the next one.
+  std::vector<Receptions> m_receptions;           //!< The packets received by each node.
+  std::vector<std::vector<Ptr<Packet> > > m_kept; //!< The copies kept by each sender.
+};
+
+MtpPointToPointModel::MtpPointToPointModel ()
+  : m_left (CHAIN),
+    m_right (CHAIN),
+    m_receptions (CHAIN),
+    m_kept (CHAIN)
+{}
+
+void
+MtpPointToPointModel::Start (void)
+{
+  m_nodes.Create (CHAIN);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  for (uint32_t i = 0; i + 1 < CHAIN; i++)
+    {
+      NetDeviceContainer devices = p2p.Install (m_nodes.Get (i), m_nodes.Get (i + 1));
+      m_right[i] = devices.Get (0);
+      m_left[i + 1] = devices.Get (1);
+      for (uint32_t j = 0; j < devices.GetN (); j++)
+        {
+          devices.Get (j)->SetReceiveCallback (MakeCallback (&MtpPointToPointModel::Receive, this));
+        }
+    }
+  for (uint32_t seq = 0; seq < PACKETS; seq++)
+    {
+      Simulator::ScheduleWithContext (0, MicroSeconds (500 * seq),
+                                      &MtpPointToPointModel::Send, this, 0, seq);
+      Simulator::ScheduleWithContext (CHAIN - 1, MicroSeconds (500 * seq + 7),
+                                      &MtpPointToPointModel::Send, this, CHAIN - 1, seq);
+    }
+}
+
+void
+MtpPointToPointModel::Send (uint32_t node, uint32_t seq)
+{
+  std::vector<uint8_t> data (100 + seq);
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      data[i] = static_cast<uint8_t> (node + seq + i);
+    }
+  Ptr<Packet> packet = Create<Packet> (&data[0], data.size ());
+  SocketPriorityTag priority;
+  priority.SetPriority (0);
+  packet->AddPacketTag (priority);
+  SocketIpTtlTag ttl;
+  ttl.SetTtl (static_cast<uint8_t> (node));
+  packet->AddByteTag (ttl);
+  Ptr<Packet> kept = packet->Copy ();
+
+  Ptr<NetDevice> device = node == 0 ? m_right[node] : m_left[node];
+  device->Send (packet, device->GetBroadcast (), 0x800);
+
+  // The receivers must not see these changes, which are made while
+  // they handle the previous packets.
+  kept->AddPaddingAtEnd (16);
+  kept->RemoveAllPacketTags ();
+  m_kept[node].push_back (kept);
+  for (uint32_t i = 0; i < m_kept[node].size (); i++)
+    {
+      m_kept[node][i]->AddAtEnd (Create<Packet> (&data[0], 8));
+      m_kept[node][i]->RemoveAtStart (1);
+      m_kept[node][i]->AddByteTag (ttl);
+    }
+  if (m_kept[node].size () > 4)
+    {
+      m_kept[node].erase (m_kept[node].begin ());
+    }
+}
+
+bool
+MtpPointToPointModel::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                               uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  bool fromLeft = device == m_left[node];
+
+  SocketPriorityTag priority;
+  priority.SetPriority (255);
+  packet->PeekPacketTag (priority);
+  uint32_t byteTags = 0;
+  uint32_t ttlSum = 0;
+  ByteTagIterator tags = packet->GetByteTagIterator ();
+  while (tags.HasNext ())
+    {
+      ByteTagIterator::Item item = tags.Next ();
+      SocketIpTtlTag ttl;
+      item.GetTag (ttl);
+      byteTags++;
+      ttlSum += ttl.GetTtl ();
+    }
+  std::vector<uint8_t> data (packet->GetSize ());
+  packet->CopyData (&data[0], data.size ());
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      sum = sum * 31 + data[i];
+    }
+
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetTimeStep () << " " << fromLeft << " " << packet->GetSize ()
+      << " " << static_cast<uint32_t> (priority.GetPriority ())
+      << " " << byteTags << " " << ttlSum << " " << sum;
+  m_receptions[node].push_back (oss.str ());
+
+  Ptr<NetDevice> next = fromLeft ? m_right[node] : m_left[node];
+  if (next != 0)
+    {
+      Ptr<Packet> forward = packet->Copy ();
+      priority.SetPriority (priority.GetPriority () + 1);
+      forward->ReplacePacketTag (priority);
+      SocketIpTtlTag ttl;
+      ttl.SetTtl (static_cast<uint8_t> (node));
+      forward->AddByteTag (ttl);
+      uint8_t trailer[4] = { 1, 2, 3, static_cast<uint8_t> (node) };
+      forward->AddAtEnd (Create<Packet> (trailer, sizeof (trailer)));
+      next->Send (forward, next->GetBroadcast (), protocol);
+    }
+  return true;
+}
+
+/**
+ * \ingroup mtp
+ * Compare the packets received over point-to-point links with
+ * DefaultSimulatorImpl and with MultithreadedSimulatorImpl.
+ */
+class MtpPointToPointTestCase : public TestCase
+{
+public:
+  MtpPointToPointTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+private:
+  /**
+   * Run the point-to-point model.
+   * \param [in] simulatorType The simulator implementation.
+   * \param [in] threads The number of threads.
+   * \returns The packets received by each node.
+   */
+  std::vector<Receptions> RunModel (std::string simulatorType, uint32_t threads);
+};
+
+MtpPointToPointTestCase::MtpPointToPointTestCase ()
+  : TestCase ("Check the packets sent over point-to-point links")
+{}
+
+std::vector<Receptions>
+MtpPointToPointTestCase::RunModel (std::string simulatorType, uint32_t threads)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (threads));
+
+  MtpPointToPointModel model;
+  model.Start ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ostringstream oss;
+  oss << simulatorType << " with " << threads << " threads";
+  NS_TEST_EXPECT_MSG_EQ (Packet::IsMultithreaded (), false, oss.str ());
+  for (uint32_t n = 0; n < CHAIN; n++)
+    {
+      uint32_t expected = PACKETS;
+      if (n != 0 && n != CHAIN - 1)
+        {
+          expected = 2 * PACKETS;
+        }
+      NS_TEST_EXPECT_MSG_EQ (model.m_receptions[n].size (), expected,
+                             oss.str () << ": packets lost by node " << n);
+    }
+  return model.m_receptions;
+}
+
+void
+MtpPointToPointTestCase::DoRun (void)
+{
+  std::vector<Receptions> reference = RunModel ("ns3::DefaultSimulatorImpl", 1);
+  std::vector<Receptions> parallel = RunModel ("ns3::MultithreadedSimulatorImpl", 2);
+  std::vector<Receptions> parallel4 = RunModel ("ns3::MultithreadedSimulatorImpl", 4);
+  for (uint32_t n = 0; n < CHAIN; n++)
+    {
+      bool same = parallel4[n] == parallel[n];
+      NS_TEST_EXPECT_MSG_EQ (same, true, "4 threads, node " << n);
+      std::sort (reference[n].begin (), reference[n].end ());
+      std::sort (parallel[n].begin (), parallel[n].end ());
+      same = reference[n] == parallel[n];
+      NS_TEST_EXPECT_MSG_EQ (same, true, "2 threads, node " << n);
+    }
+}
+
+void
+MtpPointToPointTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup mtp
+ * The multithreaded simulator test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+public:
+  MtpTestSuite ();
+};
+
+MtpTestSuite::MtpTestSuite ()
+  : TestSuite ("mtp", UNIT)
+{
+  AddTestCase (new MtpEquivalenceTestCase, TestCase::QUICK);
+  AddTestCase (new MtpStopTestCase, TestCase::QUICK);
+  AddTestCase (new MtpPointToPointTestCase, TestCase::QUICK);
+}
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
@@ -43,6 +43,13 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief The smallest number of real bytes which are shared in a chain
+ * segment rather than copied.
+ */
+static const uint32_t g_minSegmentSize = 256;
+
 }
 
 namespace ns3 {
@@ -50,48 +57,20 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+std::atomic<uint32_t> Buffer::g_recommendedStart (0);
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+PacketDataPool &
+Buffer::GetPool (void)
 {
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
+  // Created on first use, so that it outlives the static buffers.
+  static PacketDataPool pool;
+  return pool;
+}
+
+PacketDataPool::Stats
+Buffer::GetPoolStats (void)
+{
+  return GetPool ().GetStats ();
 }
 
 void
@@ -99,50 +78,33 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  GetPool ().Recycle (reinterpret_cast<uint8_t *> (data),
+                      data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  if (dataSize == 0) 
     {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      dataSize = 1;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  uint32_t capacity;
+  uint8_t *b = GetPool ().Allocate (dataSize - 1 + sizeof (struct Buffer::Data), &capacity);
+  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
+  data->m_size = capacity + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
 #else /* BUFFER_FREE_LIST */
+PacketDataPool::Stats
+Buffer::GetPoolStats (void)
+{
+  PacketDataPool::Stats stats = { 0, 0, 0, 0 };
+  return stats;
+}
+
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
@@ -186,18 +148,21 @@ Buffer::Deallocate (struct Buffer::Data *data)
 }
 
 Buffer::Buffer ()
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this);
   Initialize (0);
 }
 
 Buffer::Buffer (uint32_t dataSize)
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this << dataSize);
   Initialize (dataSize);
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_chain (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -226,13 +191,27 @@ Buffer::CheckInternalState (void) const
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool chainOk = true;
+  if (m_chain != 0)
+    {
+      uint32_t size = 0;
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_segments.begin ();
+           i != m_chain->m_segments.end (); i++)
+        {
+          chainOk = chainOk && i->m_chain == 0 && i->GetSize () > 0;
+          size += i->GetSize ();
+        }
+      chainOk = chainOk && m_chain->m_count > 0 && size == m_chain->m_size;
+    }
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && chainOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this << 
                           ", " << (offsetsOk ? "true" : "false") <<
                           ", " << (dirtyOk ? "true" : "false") <<
-                          ", " << (internalSizeOk ? "true" : "false") << " ");
+                          ", " << (internalSizeOk ? "true" : "false") <<
+                          ", " << (chainOk ? "true" : "false") << " ");
     }
   return ok;
 #else
@@ -245,7 +224,7 @@ Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
   m_data = Buffer::Create (0);
-  m_start = std::min (m_data->m_size, g_recommendedStart);
+  m_start = std::min (m_data->m_size, g_recommendedStart.load (std::memory_order_relaxed));
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
   m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
@@ -270,7 +249,16 @@ Buffer::operator = (Buffer const&o)
       m_data = o.m_data;
       m_data->m_count++;
     }
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  if (m_chain != o.m_chain)
+    {
+      if (o.m_chain != 0)
+        {
+          o.m_chain->m_count++;
+        }
+      ReleaseChain ();
+      m_chain = o.m_chain;
+    }
+  UpdateRecommendedStart ();
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
   m_zeroAreaEnd = o.m_zeroAreaEnd;
@@ -280,16 +268,147 @@ Buffer::operator = (Buffer const&o)
   return *this;
 }
 
+void
+Buffer::UpdateRecommendedStart (void) const
+{
+  uint32_t start = g_recommendedStart.load (std::memory_order_relaxed);
+  while (m_maxZeroAreaStart > start
+         && !g_recommendedStart.compare_exchange_weak (start, m_maxZeroAreaStart,
+                                                       std::memory_order_relaxed))
+    {
+    }
+}
+
 Buffer::~Buffer ()
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  UpdateRecommendedStart ();
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
+  ReleaseChain ();
+}
+
+Buffer
+Buffer::GetHead (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer head = *this;
+  head.ReleaseChain ();
+  return head;
+}
+
+void
+Buffer::SetHead (Buffer const &head)
+{
+  NS_LOG_FUNCTION (this << &head);
+  NS_ASSERT (head.m_chain == 0);
+  struct Chain *chain = m_chain;
+  m_chain = 0;
+  *this = head;
+  m_chain = chain;
+}
+
+void
+Buffer::ReleaseChain (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_chain != 0)
+    {
+      m_chain->m_count--;
+      if (m_chain->m_count == 0)
+        {
+          delete m_chain;
+        }
+      m_chain = 0;
+    }
+}
+
+struct Buffer::Chain *
+Buffer::GetWritableChain (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_chain == 0)
+    {
+      m_chain = new Chain ();
+      m_chain->m_count = 1;
+      m_chain->m_size = 0;
+    }
+  else if (m_chain->m_count > 1)
+    {
+      struct Chain *chain = new Chain (*m_chain);
+      chain->m_count = 1;
+      m_chain->m_count--;
+      m_chain = chain;
+    }
+  return m_chain;
+}
+
+void
+Buffer::AppendSegments (Buffer const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  struct Chain *chain = GetWritableChain ();
+  if (o.m_end != o.m_start)
+    {
+      chain->m_segments.push_back (o.GetHead ());
+      chain->m_size += o.m_end - o.m_start;
+    }
+  if (o.m_chain != 0)
+    {
+      chain->m_segments.insert (chain->m_segments.end (),
+                                o.m_chain->m_segments.begin (),
+                                o.m_chain->m_segments.end ());
+      chain->m_size += o.m_chain->m_size;
+    }
+  NormalizeChain ();
+}
+
+void
+Buffer::PushHeadSegment (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct Chain *chain = GetWritableChain ();
+  if (m_end != m_start)
+    {
+      chain->m_segments.insert (chain->m_segments.begin (), GetHead ());
+      chain->m_size += m_end - m_start;
+    }
+  SetHead (Buffer ());
+  NormalizeChain ();
+}
+
+void
+Buffer::NormalizeChain (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_chain == 0)
+    {
+      return;
+    }
+  if (m_chain->m_segments.empty ())
+    {
+      ReleaseChain ();
+      return;
+    }
+  if (m_zeroAreaEnd != m_zeroAreaStart)
+    {
+      // The iterators see the segments in place of the zero area of
+      // the head, so move it to the first segment.
+      Buffer head = GetHead ();
+      uint32_t dataStart = m_zeroAreaStart - m_start;
+      Buffer rest = head.CreateFragment (dataStart, m_end - m_zeroAreaStart);
+      head.RemoveAtEnd (m_end - m_zeroAreaStart);
+      struct Chain *chain = GetWritableChain ();
+      chain->m_segments.insert (chain->m_segments.begin (), rest);
+      chain->m_size += rest.GetSize ();
+      SetHead (head);
+    }
+  NS_ASSERT (CheckInternalState ());
+  NS_ASSERT (m_zeroAreaStart == m_zeroAreaEnd && !m_chain->m_segments.empty ());
 }
 
 uint32_t
@@ -323,6 +442,15 @@ Buffer::AddAtStart (uint32_t start)
       // update dirty area
       m_data->m_dirtyStart = m_start;
     } 
+  else if (m_data->m_count > 1 && GetInternalSize () >= g_minSegmentSize)
+    {
+      /* the data is shared and large: rather than copying it, keep it
+       * in a segment behind a new head.
+       */
+      PushHeadSegment ();
+      AddAtStart (start);
+      return;
+    }
   else
     {
       uint32_t newSize = GetInternalSize () + start;
@@ -355,6 +483,18 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      /* grow the last segment, which may itself become a chain.
+       */
+      struct Chain *chain = GetWritableChain ();
+      Buffer last = chain->m_segments.back ();
+      chain->m_segments.pop_back ();
+      chain->m_size -= last.GetSize ();
+      last.AddAtEnd (end);
+      AppendSegments (last);
+      return;
+    }
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
@@ -368,6 +508,16 @@ Buffer::AddAtEnd (uint32_t end)
       // update dirty area.
       m_data->m_dirtyEnd = m_end;
     } 
+  else if (m_data->m_count > 1 && GetInternalSize () >= g_minSegmentSize)
+    {
+      /* the data is shared and large: rather than copying it, add
+       * the new bytes in a new segment.
+       */
+      Buffer segment;
+      segment.AddAtEnd (end);
+      AppendSegments (segment);
+      return;
+    }
   else
     {
       uint32_t newSize = GetInternalSize () + end;
@@ -400,6 +550,46 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  if (o.GetSize () == 0)
+    {
+      return;
+    }
+  if (m_chain != 0)
+    {
+      struct Chain *chain = GetWritableChain ();
+      if (o.m_chain == 0 &&
+          chain->m_segments.back ().GetSize () + o.GetSize () < g_minSegmentSize)
+        {
+          /* merge small buffers into a single segment.
+           */
+          Buffer last = chain->m_segments.back ();
+          chain->m_segments.pop_back ();
+          chain->m_size -= last.GetSize ();
+          last.AddAtEnd (o);
+          AppendSegments (last);
+        }
+      else
+        {
+          AppendSegments (o);
+        }
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (o.m_chain != 0 || o.GetSize () >= g_minSegmentSize)
+    {
+      /* share the bytes of o rather than copying them.
+       */
+      if (m_end == m_start)
+        {
+          *this = o;
+        }
+      else
+        {
+          AppendSegments (o);
+        }
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   if (m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
@@ -442,6 +632,39 @@ Buffer::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0 && start > m_end - m_start)
+    {
+      /* remove the head, and promote the first segment left.
+       */
+      start -= m_end - m_start;
+      struct Chain *chain = GetWritableChain ();
+      std::vector<Buffer>::iterator i = chain->m_segments.begin ();
+      while (i != chain->m_segments.end () && start >= i->GetSize ())
+        {
+          start -= i->GetSize ();
+          chain->m_size -= i->GetSize ();
+          i++;
+        }
+      if (i == chain->m_segments.end ())
+        {
+          Buffer head = chain->m_segments.back ();
+          head.RemoveAtStart (head.GetSize ());
+          ReleaseChain ();
+          *this = head;
+        }
+      else
+        {
+          Buffer head = *i;
+          chain->m_size -= head.GetSize ();
+          chain->m_segments.erase (chain->m_segments.begin (), i + 1);
+          head.RemoveAtStart (start);
+          SetHead (head);
+          NormalizeChain ();
+        }
+      LOG_INTERNAL_STATE ("rem start=" << start << ", ");
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   uint32_t newStart = m_start + start;
   if (newStart <= m_zeroAreaStart)
     {
@@ -487,6 +710,30 @@ Buffer::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      /* remove the last segments first.
+       */
+      struct Chain *chain = GetWritableChain ();
+      while (end > 0 && !chain->m_segments.empty ())
+        {
+          Buffer &last = chain->m_segments.back ();
+          uint32_t size = last.GetSize ();
+          if (end >= size)
+            {
+              chain->m_segments.pop_back ();
+              chain->m_size -= size;
+              end -= size;
+            }
+          else
+            {
+              last.RemoveAtEnd (end);
+              chain->m_size -= end;
+              end = 0;
+            }
+        }
+      NormalizeChain ();
+    }
   uint32_t newEnd = m_end - std::min (end, m_end - m_start);
   if (newEnd > m_zeroAreaEnd)
     {
@@ -530,11 +777,41 @@ Buffer::CreateFragment (uint32_t start, uint32_t length) const
   return tmp;
 }
 
+Buffer
+Buffer::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      return CreateFullCopy ();
+    }
+  Buffer tmp (m_zeroAreaEnd - m_zeroAreaStart);
+  uint32_t dataStart = m_zeroAreaStart - m_start;
+  tmp.AddAtStart (dataStart);
+  tmp.Begin ().Write (m_data->m_data + m_start, dataStart);
+  uint32_t dataEnd = m_end - m_zeroAreaEnd;
+  tmp.AddAtEnd (dataEnd);
+  Buffer::Iterator i = tmp.End ();
+  i.Prev (dataEnd);
+  i.Write (m_data->m_data + m_zeroAreaStart, dataEnd);
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 Buffer 
 Buffer::CreateFullCopy (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
+  if (m_chain != 0)
+    {
+      Buffer tmp;
+      tmp.AddAtStart (GetSize ());
+      CopyData (tmp.m_data->m_data + tmp.m_start, GetSize ());
+      NS_ASSERT (tmp.CheckInternalState ());
+      return tmp;
+    }
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
       Buffer tmp;
@@ -559,6 +836,10 @@ uint32_t
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_chain != 0)
+    {
+      return CreateFullCopy ().GetSerializedSize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -579,6 +860,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_chain != 0)
+    {
+      return CreateFullCopy ().Serialize (buffer, maxSize);
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -718,6 +1003,18 @@ void
 Buffer::CopyData (std::ostream *os, uint32_t size) const
 {
   NS_LOG_FUNCTION (this << &os << size);
+  if (m_chain != 0)
+    {
+      GetHead ().CopyData (os, size);
+      size -= std::min (size, m_end - m_start);
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_segments.begin ();
+           i != m_chain->m_segments.end () && size > 0; i++)
+        {
+          i->CopyData (os, size);
+          size -= std::min (size, i->GetSize ());
+        }
+      return;
+    }
   if (size > 0)
     {
       uint32_t tmpsize = std::min (m_zeroAreaStart-m_start, size);
@@ -747,6 +1044,16 @@ uint32_t
 Buffer::CopyData (uint8_t *buffer, uint32_t size) const
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_chain != 0)
+    {
+      uint32_t copied = GetHead ().CopyData (buffer, size);
+      for (std::vector<Buffer>::const_iterator i = m_chain->m_segments.begin ();
+           i != m_chain->m_segments.end () && copied < size; i++)
+        {
+          copied += i->CopyData (buffer + copied, size - copied);
+        }
+      return copied;
+    }
   uint32_t originalSize = size;
   if (size > 0)
     {
@@ -829,10 +1136,70 @@ Buffer::Iterator::Check (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << &i);
   return i >= m_dataStart && 
-         !(i >= m_zeroStart && i < m_zeroEnd) &&
+         !(i >= m_zeroStart && i < m_zeroEnd && m_chain == 0) &&
          i <= m_dataEnd;
 }
 
+uint8_t *
+Buffer::Iterator::GetChainByte (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_chain != 0 && m_current >= m_zeroStart && m_current < m_zeroEnd);
+  uint32_t offset = m_current - m_zeroStart;
+  if (offset < m_segmentStart)
+    {
+      m_segment = 0;
+      m_segmentStart = 0;
+    }
+  while (offset >= m_segmentStart + m_chain->m_segments[m_segment].GetSize ())
+    {
+      m_segmentStart += m_chain->m_segments[m_segment].GetSize ();
+      m_segment++;
+    }
+  const Buffer &segment = m_chain->m_segments[m_segment];
+  uint32_t i = segment.m_start + offset - m_segmentStart;
+  if (i < segment.m_zeroAreaStart)
+    {
+      return &segment.m_data->m_data[i];
+    }
+  else if (i < segment.m_zeroAreaEnd)
+    {
+      return 0;
+    }
+  else
+    {
+      return &segment.m_data->m_data[i - (segment.m_zeroAreaEnd - segment.m_zeroAreaStart)];
+    }
+}
+
+uint8_t
+Buffer::Iterator::SlowPeekU8 (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint8_t *byte = GetChainByte ();
+  if (byte == 0)
+    {
+      return 0;
+    }
+  return *byte;
+}
+
+void
+Buffer::Iterator::SlowWriteU8 (uint8_t data)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (data));
+  if (m_chain == 0)
+    {
+      m_data[m_current - (m_zeroEnd - m_zeroStart)] = data;
+      m_current++;
+      return;
+    }
+  uint8_t *byte = GetChainByte ();
+  NS_ASSERT_MSG (byte != 0, GetWriteErrorMessage ());
+  *byte = data;
+  m_current++;
+}
+
 
 void 
 Buffer::Iterator::Write (Iterator start, Iterator end)
@@ -846,27 +1213,42 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  if (m_chain != 0 || start.m_chain != 0)
+    {
+      while (start.m_current != end.m_current)
+        {
+          WriteU8 (start.ReadU8 ());
+        }
+      return;
+    }
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
-  uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
-  memcpy (to, from, toCopy);
-  m_current += toCopy;
+  memcpy (to, from, size);
 }
 
 void 
@@ -958,6 +1340,14 @@ Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
   NS_LOG_FUNCTION (this << &buffer << size);
   NS_ASSERT_MSG (CheckNoZero (m_current, size),
                  GetWriteErrorMessage ());
+  if (m_chain != 0 && m_current + size > m_zeroStart)
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          WriteU8 (buffer[i]);
+        }
+      return;
+    }
   uint8_t *to;
   if (m_current <= m_zeroStart)
     {
@@ -21,9 +21,11 @@
 #define BUFFER_H
 
 #include <stdint.h>
+#include <atomic>
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "packet-data-pool.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -88,9 +90,18 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * Appending a large buffer, taking a fragment which spans appended
+ * buffers, or adding bytes around large shared data does not copy the
+ * bytes: the buffer becomes a chain instead. The fields above then
+ * describe its head, which has no zero area, and the rest of the bytes
+ * are held by the segments of a Buffer::Chain: plain buffers which
+ * share the data of the original ones. Headers are still added and
+ * removed in the head, and the iterators walk through the segments.
  */
 class Buffer 
 {
+  struct Chain;
 public:
   /**
    * \brief iterator in a Buffer instance
@@ -451,6 +462,24 @@ private:
      * \returns the error message
      */
     std::string GetWriteErrorMessage (void) const;
+    /**
+     * \brief Find the current byte in the segments of a chain.
+     *
+     * The segments are seen in the "virtual zero area" of the iterator.
+     *
+     * \returns a pointer to the byte, or zero if the byte is in the
+     * "virtual zero area" of its segment.
+     */
+    uint8_t *GetChainByte (void);
+    /**
+     * \returns the current byte, in the segments of a chain.
+     */
+    uint8_t SlowPeekU8 (void);
+    /**
+     * \brief Write the current byte, in the segments of a chain.
+     * \param data the byte to write
+     */
+    void SlowWriteU8 (uint8_t data);
 
     /**
      * offset in virtual bytes from the start of the data buffer to the
@@ -482,6 +511,19 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * the segments which follow the head of a chained buffer, or zero.
+     */
+    const Chain *m_chain;
+    /**
+     * the index of the last segment accessed.
+     */
+    uint32_t m_segment;
+    /**
+     * offset in bytes from the start of the first segment to the start
+     * of the last segment accessed.
+     */
+    uint32_t m_segmentStart;
   };
 
   /**
@@ -555,6 +597,15 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * \return a copy of this Buffer which shares no data with it.
+   *
+   * Unlike the copy constructor, the copy can be handed to another
+   * thread: the zero area is kept, but the bytes are copied to new
+   * storage.
+   */
+  Buffer CreateDeepCopy (void) const;
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -642,6 +693,13 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Get the statistics of the pool of buffer data storages
+   *
+   * \returns the statistics of all the threads.
+   */
+  static PacketDataPool::Stats GetPoolStats (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -749,6 +807,45 @@ private:
    */
   static void Deallocate (struct Buffer::Data *data);
 
+  /**
+   * \brief Get the head of a chained buffer
+   * \returns a plain buffer sharing the data of the head
+   */
+  Buffer GetHead (void) const;
+  /**
+   * \brief Replace the head of this buffer, keeping its chain
+   * \param head the new head, a plain buffer
+   */
+  void SetHead (Buffer const &head);
+  /**
+   * \brief Drop the reference of this buffer to its chain
+   */
+  void ReleaseChain (void);
+  /**
+   * \brief Get the chain of this buffer, for modification.
+   *
+   * The chain is created if needed, and copied if shared.
+   *
+   * \returns the chain
+   */
+  Chain *GetWritableChain (void);
+  /**
+   * \brief Append the bytes of a buffer as new segments, without copy
+   * \param o the buffer to append
+   */
+  void AppendSegments (Buffer const &o);
+  /**
+   * \brief Move the head to the first segment, behind a new empty head
+   */
+  void PushHeadSegment (void);
+  /**
+   * \brief Restore the invariants of a chained buffer.
+   *
+   * An empty chain is released, and the zero area of the head is moved
+   * to the first segment, with the data which follows it.
+   */
+  void NormalizeChain (void);
+
   struct Data *m_data; //!< the buffer data storage
 
   /**
@@ -767,7 +864,12 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static std::atomic<uint32_t> g_recommendedStart;
+  /**
+   * \brief Raise g_recommendedStart to the maximum zero area start of
+   * this buffer.
+   */
+  void UpdateRecommendedStart (void) const;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,21 +891,36 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
+  /**
+   * the segments which follow the head, or zero if this buffer is not
+   * chained.
+   */
+  Chain *m_chain;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /**
+   * \brief Get the pool of buffer data storages
+   * \returns the pool
+   */
+  static PacketDataPool &GetPool (void);
 #endif
 };
 
+/**
+ * \ingroup packet
+ *
+ * \brief The segments of a chained Buffer.
+ *
+ * A chain is shared by the copies of a buffer, and copied before
+ * being modified if it is shared.
+ */
+struct Buffer::Chain
+{
+  uint32_t m_count;                //!< the number of buffers referencing this chain
+  uint32_t m_size;                 //!< the total size of the segments
+  std::vector<Buffer> m_segments;  //!< the segments, which are neither chained nor empty
+};
+
 } // namespace ns3
 
 #include "ns3/assert.h"
@@ -817,7 +934,10 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_chain (0),
+    m_segment (0),
+    m_segmentStart (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -839,6 +959,16 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_chain = buffer->m_chain;
+  m_segment = 0;
+  m_segmentStart = 0;
+  if (m_chain != 0)
+    {
+      // The segments follow the head, in place of the zero area.
+      m_zeroStart = m_dataEnd;
+      m_zeroEnd = m_dataEnd + m_chain->m_size;
+      m_dataEnd = m_zeroEnd;
+    }
 }
 
 void 
@@ -876,6 +1006,10 @@ Buffer::Iterator::WriteU8 (uint8_t data)
       m_data[m_current] = data;
       m_current++;
     }
+  else if (m_current < m_zeroEnd)
+    {
+      SlowWriteU8 (data);
+    }
   else
     {
       m_data[m_current - (m_zeroEnd-m_zeroStart)] = data;
@@ -888,17 +1022,24 @@ Buffer::Iterator::WriteU8 (uint8_t  data, uint32_t len)
 {
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + len),
                  GetWriteErrorMessage ());
-  if (m_current <= m_zeroStart)
+  if (m_current + len <= m_zeroStart)
     {
       std::memset (&(m_data[m_current]), data, len);
       m_current += len;
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       uint8_t *buffer = &m_data[m_current - (m_zeroEnd-m_zeroStart)];
       std::memset (buffer, data, len);
       m_current += len;
     }
+  else
+    {
+      for (uint32_t i = 0; i < len; i++)
+        {
+          WriteU8 (data);
+        }
+    }
 }
 
 void 
@@ -911,10 +1052,16 @@ Buffer::Iterator::WriteHtonU16 (uint16_t data)
     {
       buffer = &m_data[m_current];
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else
+    {
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   buffer[0] = (data >> 8)& 0xff;
   buffer[1] = (data >> 0)& 0xff;
   m_current+= 2;
@@ -931,10 +1078,18 @@ Buffer::Iterator::WriteHtonU32 (uint32_t data)
     {
       buffer = &m_data[m_current];
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else
+    {
+      WriteU8 ((data >> 24) & 0xff);
+      WriteU8 ((data >> 16) & 0xff);
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   buffer[0] = (data >> 24)& 0xff;
   buffer[1] = (data >> 16)& 0xff;
   buffer[2] = (data >> 8)& 0xff;
@@ -1008,6 +1163,10 @@ Buffer::Iterator::PeekU8 (void)
     }
   else if (m_current < m_zeroEnd)
     {
+      if (m_chain != 0)
+        {
+          return SlowPeekU8 ();
+        }
       return 0;
     }
   else
@@ -1053,16 +1212,26 @@ Buffer::Buffer (Buffer const&o)
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
     m_start (o.m_start),
-    m_end (o.m_end)
+    m_end (o.m_end),
+    m_chain (o.m_chain)
 {
   m_data->m_count++;
+  if (m_chain != 0)
+    {
+      m_chain->m_count++;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
 uint32_t 
 Buffer::GetSize (void) const
 {
-  return m_end - m_start;
+  uint32_t size = m_end - m_start;
+  if (m_chain != 0)
+    {
+      size += m_chain->m_size;
+    }
+  return size;
 }
 
 Buffer::Iterator 
@@ -51,14 +51,18 @@ struct ByteTagListData {
  *
  * \brief Container class for struct ByteTagListData
  *
- * Internal use only.
+ * Internal use only. Each thread has its own free list, a block
+ * released by another thread than the one which allocated it joins the
+ * free list of the releasing thread.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+static thread_local class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
 } g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/** Whether g_freeList was destroyed by the exit of its thread. */
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +73,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -188,6 +193,22 @@ ByteTagList::~ByteTagList ()
   m_used = 0;
 }
 
+ByteTagList
+ByteTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList copy = *this;
+  if (m_data != 0)
+    {
+      struct ByteTagListData *newData = copy.Allocate (m_used);
+      std::memcpy (&newData->data, &m_data->data, m_used);
+      newData->dirty = m_used;
+      copy.Deallocate (copy.m_data);
+      copy.m_data = newData;
+    }
+  return copy;
+}
+
 TagBuffer
 ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
 {
@@ -345,7 +366,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -379,7 +400,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
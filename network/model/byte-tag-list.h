@@ -169,6 +169,12 @@ private:
   ByteTagList &operator = (const ByteTagList &o);
   ~ByteTagList ();
 
+  /**
+   * \returns a copy of this list which shares no data with it, and
+   *          can thus be handed to another thread.
+   */
+  ByteTagList CreateDeepCopy (void) const;
+
   /**
    * \param tid the typeid of the tag added
    * \param bufferSize the size of the tag when its serialization will 
@@ -214,6 +220,12 @@ private:
    */
   inline void Adjust (int32_t adjustment);
 
+  /**
+   * \returns true if the list holds no tag, in which case adjusting
+   * the offsets has no effect.
+   */
+  inline bool IsEmpty (void) const;
+
   /**
    * Make sure that all offsets are smaller than appendOffset which represents
    * the location where new bytes have been added to the byte buffer.
@@ -265,6 +277,12 @@ ByteTagList::Adjust (int32_t adjustment)
   m_adjustment += adjustment;
 }
 
+bool
+ByteTagList::IsEmpty (void) const
+{
+  return m_used == 0;
+}
+
 } // namespace ns3
 
 #endif /* BYTE_TAG_LIST_H */
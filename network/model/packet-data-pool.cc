@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-data-pool.h"
+#include "ns3/assert.h"
+#include "ns3/unused.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketDataPool implementation.
+ */
+
+namespace ns3 {
+
+// Note: no logging in this file, since it runs on every packet
+// allocation, possibly during the static destructors.
+
+/** A free block, linked to the next free one. */
+struct PacketDataPool::Block
+{
+  Block *next;   //!< The next free block.
+  uint32_t n;    //!< In the first block of a depot batch, the number of blocks.
+};
+
+/**
+ * The cache of a pool for a thread.
+ *
+ * This is a plain thread-local variable, without constructor nor
+ * destructor, so that it remains usable by the static destructors
+ * which run after the thread-local ones.
+ */
+struct PacketDataPool::ThreadCache
+{
+  PacketDataPool *pool;        //!< The pool, once the cache is used.
+  bool destroyed;              //!< The thread-local destructors have run.
+  Block *free[CLASSES];        //!< The free blocks, per class.
+  uint32_t n[CLASSES];         //!< The number of free blocks, per class.
+  uint64_t allocations;        //!< The allocations not published yet.
+  uint64_t hits;               //!< The hits not published yet.
+  uint64_t recycles;           //!< The recycles not published yet.
+  uint64_t releases;           //!< The releases not published yet.
+};
+
+/** Give back the blocks of the thread caches when the thread exits. */
+struct PacketDataPool::ThreadCacheDestructor
+{
+  ~ThreadCacheDestructor ()
+  {
+    for (uint32_t i = 0; i < MAX_POOLS; i++)
+      {
+        ThreadCache *cache = &t_caches[i];
+        if (cache->pool == 0)
+          {
+            continue;
+          }
+        for (uint32_t c = 0; c < CLASSES; c++)
+          {
+            while (cache->n[c] > 0)
+              {
+                uint32_t n = cache->n[c] < BATCH_SIZE ? cache->n[c] : BATCH_SIZE;
+                cache->pool->Flush (cache, c, n);
+              }
+          }
+        cache->pool->Publish (cache);
+        cache->destroyed = true;
+      }
+  }
+};
+
+thread_local PacketDataPool::ThreadCache PacketDataPool::t_caches[PacketDataPool::MAX_POOLS];
+
+namespace {
+
+/** The ids of the live pools, one bit per id. */
+std::atomic<uint32_t> g_packetDataPoolIds (0);
+
+} // unnamed namespace
+
+double
+PacketDataPool::Stats::GetHitRate (void) const
+{
+  if (allocations == 0)
+    {
+      return 0;
+    }
+  return double (hits) / double (allocations);
+}
+
+PacketDataPool::PacketDataPool ()
+  : m_id (MAX_POOLS),
+    m_maxSize (0),
+    m_allocations (0),
+    m_hits (0),
+    m_recycles (0),
+    m_releases (0)
+{
+  uint32_t ids = g_packetDataPoolIds.load (std::memory_order_relaxed);
+  do
+    {
+      m_id = 0;
+      while (m_id < MAX_POOLS && (ids & (uint32_t (1) << m_id)) != 0)
+        {
+          m_id++;
+        }
+      NS_ASSERT_MSG (m_id < MAX_POOLS, "Too many packet data pools");
+    }
+  while (!g_packetDataPoolIds.compare_exchange_weak (ids, ids | (uint32_t (1) << m_id)));
+  for (uint32_t c = 0; c < CLASSES; c++)
+    {
+      for (uint32_t i = 0; i < DEPOT_SLOTS; i++)
+        {
+          m_depot[c][i].store (0, std::memory_order_relaxed);
+        }
+    }
+}
+
+PacketDataPool::~PacketDataPool ()
+{
+  ThreadCache *cache = &t_caches[m_id];
+  if (cache->pool == this)
+    {
+      for (uint32_t c = 0; c < CLASSES; c++)
+        {
+          while (cache->free[c] != 0)
+            {
+              Block *next = cache->free[c]->next;
+              delete [] reinterpret_cast<uint8_t *> (cache->free[c]);
+              cache->free[c] = next;
+            }
+          cache->n[c] = 0;
+        }
+      cache->pool = 0;
+    }
+  for (uint32_t c = 0; c < CLASSES; c++)
+    {
+      for (uint32_t i = 0; i < DEPOT_SLOTS; i++)
+        {
+          Block *block = m_depot[c][i].exchange (0);
+          while (block != 0)
+            {
+              Block *next = block->next;
+              delete [] reinterpret_cast<uint8_t *> (block);
+              block = next;
+            }
+        }
+    }
+  g_packetDataPoolIds.fetch_and (~(uint32_t (1) << m_id));
+}
+
+uint32_t
+PacketDataPool::GetClass (uint32_t size)
+{
+  uint32_t c = 0;
+  while (c < CLASSES && (uint32_t (1) << (c + MIN_CLASS_SHIFT)) < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+PacketDataPool::ThreadCache *
+PacketDataPool::GetThreadCache (void)
+{
+  ThreadCache *cache = &t_caches[m_id];
+  if (cache->pool == 0 && !cache->destroyed)
+    {
+      // First use by this thread: give back the blocks when it exits.
+      static thread_local ThreadCacheDestructor destructor;
+      NS_UNUSED (destructor);
+      cache->pool = this;
+    }
+  return cache;
+}
+
+uint8_t *
+PacketDataPool::Allocate (uint32_t size, uint32_t *capacity)
+{
+  uint32_t c = GetClass (size);
+  if (c >= CLASSES)
+    {
+      // Too large to be pooled.
+      *capacity = size;
+      return new uint8_t [size];
+    }
+  *capacity = uint32_t (1) << (c + MIN_CLASS_SHIFT);
+
+  ThreadCache *cache = GetThreadCache ();
+  if (cache->destroyed)
+    {
+      return new uint8_t [*capacity];
+    }
+  cache->allocations++;
+  if (cache->allocations >= STATS_PERIOD)
+    {
+      Publish (cache);
+    }
+  // Only the blocks of the class of the largest recycled block are
+  // kept, so reuse one of them if there is any, or else allocate a
+  // block of the requested class.
+  uint32_t maxSize = m_maxSize.load (std::memory_order_relaxed);
+  uint32_t reuse = GetClass (size > maxSize ? size : maxSize);
+  if (reuse >= CLASSES)
+    {
+      return new uint8_t [*capacity];
+    }
+  if (cache->n[reuse] == 0)
+    {
+      // Refill from the depot.
+      for (uint32_t i = 0; i < DEPOT_SLOTS; i++)
+        {
+          if (m_depot[reuse][i].load (std::memory_order_relaxed) == 0)
+            {
+              continue;
+            }
+          Block *batch = m_depot[reuse][i].exchange (0, std::memory_order_acquire);
+          if (batch != 0)
+            {
+              cache->free[reuse] = batch;
+              cache->n[reuse] = batch->n;
+              break;
+            }
+        }
+    }
+  if (cache->n[reuse] == 0)
+    {
+      return new uint8_t [*capacity];
+    }
+  Block *block = cache->free[reuse];
+  cache->free[reuse] = block->next;
+  cache->n[reuse]--;
+  cache->hits++;
+  *capacity = uint32_t (1) << (reuse + MIN_CLASS_SHIFT);
+  return reinterpret_cast<uint8_t *> (block);
+}
+
+void
+PacketDataPool::Recycle (uint8_t *block, uint32_t capacity)
+{
+  uint32_t c = GetClass (capacity);
+  uint32_t maxSize = m_maxSize.load (std::memory_order_relaxed);
+  while (capacity > maxSize
+         && !m_maxSize.compare_exchange_weak (maxSize, capacity, std::memory_order_relaxed))
+    {
+    }
+  ThreadCache *cache = GetThreadCache ();
+  if (!cache->destroyed)
+    {
+      cache->recycles++;
+    }
+  if (c >= CLASSES
+      || capacity != (uint32_t (1) << (c + MIN_CLASS_SHIFT))
+      || c < GetClass (maxSize)
+      || cache->destroyed)
+    {
+      // Not pooled, or too small to fit the next requests.
+      if (!cache->destroyed)
+        {
+          cache->releases++;
+        }
+      delete [] block;
+      return;
+    }
+  Block *free = reinterpret_cast<Block *> (block);
+  free->next = cache->free[c];
+  cache->free[c] = free;
+  cache->n[c]++;
+  if (cache->n[c] > CACHE_SIZE)
+    {
+      Flush (cache, c, BATCH_SIZE);
+    }
+}
+
+void
+PacketDataPool::Flush (ThreadCache *cache, uint32_t c, uint32_t n)
+{
+  NS_ASSERT (n > 0 && n <= cache->n[c]);
+  Block *batch = cache->free[c];
+  Block *last = batch;
+  for (uint32_t i = 1; i < n; i++)
+    {
+      last = last->next;
+    }
+  cache->free[c] = last->next;
+  cache->n[c] -= n;
+  last->next = 0;
+  batch->n = n;
+
+  for (uint32_t i = 0; i < DEPOT_SLOTS; i++)
+    {
+      Block *empty = 0;
+      if (m_depot[c][i].load (std::memory_order_relaxed) == 0
+          && m_depot[c][i].compare_exchange_strong (empty, batch, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+        {
+          return;
+        }
+    }
+  // The depot is full.
+  while (batch != 0)
+    {
+      Block *next = batch->next;
+      delete [] reinterpret_cast<uint8_t *> (batch);
+      batch = next;
+    }
+  cache->releases += n;
+}
+
+void
+PacketDataPool::Publish (ThreadCache *cache)
+{
+  m_allocations.fetch_add (cache->allocations, std::memory_order_relaxed);
+  m_hits.fetch_add (cache->hits, std::memory_order_relaxed);
+  m_recycles.fetch_add (cache->recycles, std::memory_order_relaxed);
+  m_releases.fetch_add (cache->releases, std::memory_order_relaxed);
+  cache->allocations = 0;
+  cache->hits = 0;
+  cache->recycles = 0;
+  cache->releases = 0;
+}
+
+uint32_t
+PacketDataPool::GetMaxSize (void) const
+{
+  return m_maxSize.load (std::memory_order_relaxed);
+}
+
+PacketDataPool::Stats
+PacketDataPool::GetStats (void)
+{
+  ThreadCache *cache = GetThreadCache ();
+  if (!cache->destroyed)
+    {
+      Publish (cache);
+    }
+  Stats stats;
+  stats.allocations = m_allocations.load (std::memory_order_relaxed);
+  stats.hits = m_hits.load (std::memory_order_relaxed);
+  stats.recycles = m_recycles.load (std::memory_order_relaxed);
+  stats.releases = m_releases.load (std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace ns3
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_DATA_POOL_H
+#define PACKET_DATA_POOL_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketDataPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief A thread-safe pool of the memory blocks of Buffer and
+ * PacketMetadata.
+ *
+ * Blocks are allocated in power of two size classes.  Each thread
+ * keeps a small cache of free blocks per size class, which it uses
+ * without any synchronization.  When a cache overflows, a batch of
+ * its blocks moves to a global depot, from which the caches of the
+ * other threads refill.  The depot is a fixed array of slots per size
+ * class, each holding a batch, which are filled by compare-and-swap
+ * and emptied by atomic exchange, so it takes no lock.
+ *
+ * Like the free lists it replaces, the pool tracks the largest block
+ * given back so far, and only recycles the blocks of that size class:
+ * the blocks of smaller classes are freed rather than recycled, since
+ * they would not fit all the next requests.  A request is served with
+ * a recycled block when there is one, and otherwise with a new block
+ * of the size class of the request, so that small requests do not
+ * take large blocks after a single large one.
+ */
+class PacketDataPool
+{
+public:
+  /** The pool statistics. */
+  struct Stats
+  {
+    uint64_t allocations;  //!< The number of blocks requested.
+    uint64_t hits;         //!< The number of blocks reused from the pool.
+    uint64_t recycles;     //!< The number of blocks given back.
+    uint64_t releases;     //!< The number of blocks given back, but freed.
+
+    /**
+     * Get the recycle hit rate.
+     * \returns The fraction of the requests served from the pool.
+     */
+    double GetHitRate (void) const;
+  };
+
+  /** Constructor. */
+  PacketDataPool ();
+  /**
+   * Destructor: free the blocks of the depot and of the cache of the
+   * calling thread.  The other threads which used the pool must have
+   * exited.
+   */
+  ~PacketDataPool ();
+
+  /**
+   * Get a block.
+   *
+   * \param [in] size The minimum size of the block, in bytes.
+   * \param [out] capacity The size of the block, which must be given
+   *              back to Recycle().  It is the size class of the
+   *              request, or a larger one if a recycled block is reused.
+   * \returns The block.
+   */
+  uint8_t *Allocate (uint32_t size, uint32_t *capacity);
+  /**
+   * Give back a block.
+   *
+   * \param [in] block The block, from Allocate().
+   * \param [in] capacity The size of the block, from Allocate().
+   */
+  void Recycle (uint8_t *block, uint32_t capacity);
+  /**
+   * Get the largest block given back so far.
+   * \returns The size, in bytes.
+   */
+  uint32_t GetMaxSize (void) const;
+  /**
+   * Get the statistics of all the threads.
+   *
+   * The counters of the other running threads are published every few
+   * hundred allocations, so they may lag slightly.
+   *
+   * \returns The statistics.
+   */
+  Stats GetStats (void);
+
+private:
+  /** Pool constants. */
+  enum {
+    MIN_CLASS_SHIFT = 6,   //!< The smallest class holds 64 bytes.
+    CLASSES = 20,          //!< The number of size classes, up to 32 MiB.
+    CACHE_SIZE = 64,       //!< The maximum number of blocks per thread and class.
+    BATCH_SIZE = 32,       //!< The number of blocks moved to or from the depot.
+    DEPOT_SLOTS = 32,      //!< The number of batches in the depot per class.
+    MAX_POOLS = 8,         //!< The maximum number of live pools.
+    STATS_PERIOD = 256     //!< The number of allocations between publications.
+  };
+
+  struct Block;
+  struct ThreadCache;
+  struct ThreadCacheDestructor;
+
+  /**
+   * Get the size class of a block.
+   * \param [in] size The size of the block.
+   * \returns The size class, which may be CLASSES or more.
+   */
+  static uint32_t GetClass (uint32_t size);
+  /**
+   * Get the cache of this pool for the calling thread.
+   * \returns The cache.
+   */
+  ThreadCache *GetThreadCache (void);
+  /**
+   * Move a batch of blocks from a thread cache to the depot, or free
+   * them if the depot is full.
+   * \param [in,out] cache The thread cache.
+   * \param [in] c The size class.
+   * \param [in] n The number of blocks to move.
+   */
+  void Flush (ThreadCache *cache, uint32_t c, uint32_t n);
+  /**
+   * Add the counters of a thread cache to the pool statistics.
+   * \param [in,out] cache The thread cache.
+   */
+  void Publish (ThreadCache *cache);
+
+  uint32_t m_id;                        //!< The index of the thread caches.
+  std::atomic<uint32_t> m_maxSize;      //!< The largest block given back.
+  std::atomic<Block *> m_depot[CLASSES][DEPOT_SLOTS];  //!< The batches of free blocks.
+  std::atomic<uint64_t> m_allocations;  //!< The published allocation count.
+  std::atomic<uint64_t> m_hits;         //!< The published hit count.
+  std::atomic<uint64_t> m_recycles;     //!< The published recycle count.
+  std::atomic<uint64_t> m_releases;     //!< The published release count.
+
+  /** The caches of the pools for this thread. */
+  static thread_local ThreadCache t_caches[MAX_POOLS];
+};
+
+} // namespace ns3
+
+#endif /* PACKET_DATA_POOL_H */
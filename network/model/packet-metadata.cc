@@ -34,18 +34,20 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
+PacketDataPool &
+PacketMetadata::GetPool (void)
 {
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
+  // Created on first use, so that it outlives the static packets.
+  static PacketDataPool pool;
+  return pool;
+}
+
+PacketDataPool::Stats
+PacketMetadata::GetPoolStats (void)
+{
+  return GetPool ().GetStats ();
 }
 
 void 
@@ -70,6 +72,12 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+bool
+PacketMetadata::IsEnabled (void)
+{
+  return m_enable;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -570,48 +578,15 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
-  NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
-  if (size > m_maxSize)
-    {
-      m_maxSize = size;
-    }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-      PacketMetadata::Deallocate (data);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  return PacketMetadata::Allocate (size);
 }
 
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  PacketMetadata::Deallocate (data);
 }
 
 struct PacketMetadata::Data *
@@ -624,9 +599,11 @@ PacketMetadata::Allocate (uint32_t n)
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
+  // The pool rounds the size up to its size class, or reuses a larger block.
+  uint32_t capacity;
+  uint8_t *buf = GetPool ().Allocate (size, &capacity);
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
+  data->m_size = capacity - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE;
   data->m_count = 1;
   data->m_dirtyEnd = 0;
   return data;
@@ -635,8 +612,8 @@ void
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  GetPool ().Recycle ((uint8_t *)data,
+                      data->m_size + sizeof (struct Data) - PACKET_METADATA_DATA_M_DATA_SIZE);
 }
 
 
@@ -650,6 +627,15 @@ PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
   return fragment;
 }
 
+PacketMetadata
+PacketMetadata::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata copy = *this;
+  copy.ReserveCopy (0);
+  return copy;
+}
+
 void 
 PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
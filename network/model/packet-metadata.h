@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "packet-data-pool.h"
 
 namespace ns3 {
 
@@ -160,6 +161,17 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Check if the packet metadata is enabled
+   * \returns true if Enable or EnableChecking was called
+   */
+  static bool IsEnabled (void);
+  /**
+   * \brief Get the statistics of the pool of metadata storages
+   *
+   * \returns the statistics of all the threads.
+   */
+  static PacketDataPool::Stats GetPoolStats (void);
 
   /**
    * \brief Constructor
@@ -218,6 +230,13 @@ private:
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
 
+  /**
+   * \brief Creates a copy which shares no storage with this metadata.
+   *
+   * \return a copy which can be handed to another thread.
+   */
+  PacketMetadata CreateDeepCopy (void) const;
+
   /**
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
@@ -494,16 +513,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -661,7 +670,12 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * \brief Get the pool of metadata storages
+   * \returns the pool
+   */
+  static PacketDataPool &GetPool (void);
+
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,7 +686,6 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
@@ -28,12 +28,60 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
+#include <cstdlib>
 #include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+namespace {
+
+/**
+ * \ingroup packet
+ * The free TagData blocks of a thread, with room for
+ * PacketTagList::POOL_DATA_SIZE bytes of data, linked by their
+ * \c next pointer.
+ *
+ * This is a plain thread-local variable, without constructor nor
+ * destructor, so that it remains usable by the static destructors
+ * which run after the thread-local ones.
+ */
+struct TagDataFreeList
+{
+  PacketTagList::TagData *head;  //!< The first free block.
+  uint32_t size;                 //!< The number of free blocks.
+  bool destroyed;                //!< The thread-local destructors have run.
+};
+
+/** The maximum number of free blocks kept by each thread. */
+const uint32_t TAG_DATA_FREE_LIST_MAX = 1000;
+
+/** The free blocks of this thread. */
+thread_local TagDataFreeList g_tagDataFreeList = { 0, 0, false };
+
+/**
+ * \ingroup packet
+ * Free the blocks of g_tagDataFreeList when its thread exits.
+ */
+struct TagDataFreeListDestructor
+{
+  ~TagDataFreeListDestructor ()
+  {
+    while (g_tagDataFreeList.head != 0)
+      {
+        PacketTagList::TagData *block = g_tagDataFreeList.head;
+        g_tagDataFreeList.head = block->next;
+        std::free (block);
+      }
+    g_tagDataFreeList.size = 0;
+    g_tagDataFreeList.destroyed = true;
+  }
+};
+
+} // unnamed namespace
+
 PacketTagList::TagData *
 PacketTagList::CreateTagData (size_t dataSize)
 {
@@ -43,14 +91,46 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p;
+  if (dataSize <= POOL_DATA_SIZE && g_tagDataFreeList.head != 0)
+    {
+      p = g_tagDataFreeList.head;
+      g_tagDataFreeList.head = g_tagDataFreeList.head->next;
+      g_tagDataFreeList.size--;
+    }
+  else
+    {
+      // Small tags get a full pool block, so that it can be recycled.
+      std::size_t room = dataSize <= POOL_DATA_SIZE ? POOL_DATA_SIZE : dataSize;
+      p = std::malloc (sizeof (TagData) + room - 1);
+    }
+  // The matching frees are in FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::FreeTagData (TagData *tag)
+{
+  bool recycle = tag->size <= POOL_DATA_SIZE
+    && !g_tagDataFreeList.destroyed
+    && g_tagDataFreeList.size < TAG_DATA_FREE_LIST_MAX;
+  tag->~TagData ();
+  if (!recycle)
+    {
+      std::free (tag);
+      return;
+    }
+  // Free the blocks when the thread exits.
+  static thread_local TagDataFreeListDestructor destructor;
+  NS_UNUSED (destructor);
+  tag->next = g_tagDataFreeList.head;
+  g_tagDataFreeList.head = tag;
+  g_tagDataFreeList.size++;
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -175,9 +255,35 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_inlineN)
+    {
+      uint8_t *start = m_inlineData + m_inline[i].start;
+      tag.Deserialize (TagBuffer (start, start + m_inline[i].size));
+      RemoveInline (i);
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
+void
+PacketTagList::RemoveInline (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  NS_ASSERT (i < m_inlineN);
+  uint8_t start = m_inline[i].start;
+  uint8_t size = m_inline[i].size;
+  std::memmove (m_inlineData + start, m_inlineData + start + size,
+                m_inlineSize - start - size);
+  m_inlineSize -= size;
+  m_inlineN--;
+  for (uint32_t j = i; j < m_inlineN; j++)
+    {
+      m_inline[j] = m_inline[j + 1];
+      m_inline[j].start -= size;
+    }
+}
+
 // COWWriter implementing Remove
 bool
 PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
@@ -194,8 +300,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      FreeTagData (cur);
     }
   else
     {
@@ -214,6 +319,22 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_inlineN)
+    {
+      if (tag.GetSerializedSize () == m_inline[i].size)
+        {
+          // rewrite in place
+          uint8_t *start = m_inlineData + m_inline[i].start;
+          tag.Serialize (TagBuffer (start, start + m_inline[i].size));
+        }
+      else
+        {
+          RemoveInline (i);
+          Add (tag);
+        }
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -256,17 +377,53 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
   return found;
 }
 
+PacketTagList
+PacketTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  copy.CopyInline (*this);
+  struct TagData **prevNext = &copy.m_next;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *tag = CreateTagData (cur->size);
+      tag->count = 1;
+      tag->next = 0;
+      tag->tid = cur->tid;
+      std::memcpy (tag->data, cur->data, cur->size);
+      *prevNext = tag;
+      prevNext = &tag->next;
+    }
+  return copy;
+}
+
 void 
 PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT_MSG (FindInline (tag.GetInstanceTypeId ()) == INLINE_TAGS,
+                 "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
                      "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
+  uint32_t size = tag.GetSerializedSize ();
+  if (m_inlineN < INLINE_TAGS && size <= uint32_t (INLINE_SIZE - m_inlineSize))
+    {
+      PacketTagList *self = const_cast<PacketTagList *> (this);
+      struct InlineTag &entry = self->m_inline[m_inlineN];
+      entry.tid = tag.GetInstanceTypeId ();
+      entry.start = m_inlineSize;
+      entry.size = size;
+      uint8_t *start = self->m_inlineData + m_inlineSize;
+      tag.Serialize (TagBuffer (start, start + size));
+      self->m_inlineSize += size;
+      self->m_inlineN++;
+      return;
+    }
+  struct TagData * head = CreateTagData (size);
   head->count = 1;
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
@@ -281,6 +438,13 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t i = FindInline (tid);
+  if (i < m_inlineN)
+    {
+      uint8_t *start = const_cast<uint8_t *> (m_inlineData) + m_inline[i].start;
+      tag.Deserialize (TagBuffer (start, start + m_inline[i].size));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -26,6 +26,7 @@
 */
 
 #include <stdint.h>
+#include <cstring>
 #include <ostream>
 #include "ns3/type-id.h"
 
@@ -43,7 +44,24 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
+ * \par <b> Inline tags </b>
+ *
+ * Most packets carry only a few small tags, which are added and
+ * removed at each hop.  The first #INLINE_TAGS tags which fit in
+ * #INLINE_SIZE bytes are stored in serialized form in an array inside
+ * the PacketTagList itself.  Adding, finding, replacing and removing
+ * them takes constant time, and never allocates: copying the
+ * PacketTagList copies them.
+ *
+ * \par <b> Overflow tags </b>
+ *
+ * The other tags, more numerous or larger, are stored in a shared tree
+ * with copy-on-write semantics, as described below.  The nodes of the
+ * tree are recycled through a per-thread pool of blocks with room for
+ * #POOL_DATA_SIZE bytes of data, so that the larger tags do not hit the
+ * heap either at each hop.
+ *
+ * The implementation of the tree is a bit tricky.  Refer to this
  * diagram in the discussion that follows.
  *
  * \dot
@@ -97,8 +115,8 @@ class Tag;
  *
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
+ *   - #Add prepends a new overflow tag to the list (growing that branch of
+ *     the tree, as \c T6). This is a constant time operation, and does not affect
  *     any other #PacketTagList's, hence this is a \c const function.
  *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
@@ -147,6 +165,13 @@ public:
     uint8_t data[1];            /**< Serialization buffer */
   };  /* struct TagData */
 
+  /** Storage constants. */
+  enum {
+    INLINE_TAGS = 4,     //!< Maximum number of inline tags.
+    INLINE_SIZE = 64,    //!< Size of the inline tag data, in bytes.
+    POOL_DATA_SIZE = 32  //!< Largest overflow tag recycled by the pool, in bytes.
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -156,8 +181,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags of \pname{o}, and makes a light-weight
+   * copy of its overflow tags by pointing to the same \ref TagData.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -166,8 +191,9 @@ public:
    * \param [in] o The PacketTagList to copy.
    * \returns the copied object
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags of \pname{o}, then makes a light-weight
+   * copy of its overflow tags by #RemoveAll, then pointing to the same
+   * \ref TagData as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
@@ -177,6 +203,13 @@ public:
    */
   inline ~PacketTagList ();
 
+  /**
+   * Create a copy which shares no \ref TagData with this list.
+   *
+   * \returns A copy which can be handed to another thread.
+   */
+  PacketTagList CreateDeepCopy (void) const;
+
   /**
    * Add a tag to the head of this branch.
    *
@@ -214,11 +247,57 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of the overflow tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns The number of inline tags.
+   */
+  inline uint32_t GetInlineN (void) const;
+  /**
+   * Get an inline tag.
+   *
+   * \param [in] i The index of the inline tag.
+   * \param [out] tid The type of the tag.
+   * \param [out] data The serialized tag.
+   * \param [out] size The size of the serialized tag.
+   */
+  inline void PeekInline (uint32_t i, TypeId *tid,
+                          const uint8_t **data, uint32_t *size) const;
 
 private:
+  /** An inline tag. */
+  struct InlineTag
+  {
+    TypeId tid;      /**< Type of the tag serialized in #m_inlineData */
+    uint8_t start;   /**< Offset of the tag in #m_inlineData */
+    uint8_t size;    /**< Size of the serialized tag */
+  };
+
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The type of the tag.
+   * \returns The index of the inline tag, or #INLINE_TAGS if not found.
+   */
+  inline uint32_t FindInline (TypeId tid) const;
+  /**
+   * Remove an inline tag, and pack the data of the following ones.
+   *
+   * \param [in] i The index of the inline tag.
+   */
+  void RemoveInline (uint32_t i);
+  /**
+   * Copy the inline tags of another PacketTagList.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  inline void CopyInline (PacketTagList const &o);
+  /**
+   * Remove the overflow tags from this list (up to the first merge).
+   */
+  inline void RemoveOverflow (void);
+
   /**
    * Allocate and construct a TagData struct, sizing the data area
    * large enough to serialize dataSize bytes from a Tag.
@@ -228,6 +307,13 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destroy a TagData struct, and recycle or free its memory.
+   *
+   * \param [in] tag The TagData to free.
+   */
+  static
+  void FreeTagData (TagData *tag);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -278,8 +364,16 @@ private:
   bool ReplaceWriter (Tag & tag, bool preMerge,
                       struct TagData * cur, struct TagData ** prevNext);
 
+  /** The inline tags. */
+  struct InlineTag m_inline[INLINE_TAGS];
+  /** The number of inline tags. */
+  uint8_t m_inlineN;
+  /** The number of bytes used in #m_inlineData. */
+  uint8_t m_inlineSize;
+  /** The serialized inline tags. */
+  uint8_t m_inlineData[INLINE_SIZE];
   /**
-   * Pointer to first \ref TagData on the list
+   * Pointer to first overflow \ref TagData on the list
    */
   struct TagData *m_next;
 };
@@ -293,13 +387,18 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_inlineN (0),
+    m_inlineSize (0),
+    m_next ()
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_inlineN (0),
+    m_inlineSize (0),
+    m_next (o.m_next)
 {
+  CopyInline (o);
   if (m_next != 0)
     {
       m_next->count++;
@@ -310,11 +409,16 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
+  if (this == &o)
+    {
+      return *this;
+    }
+  CopyInline (o);
   if (m_next == o.m_next) 
     {
       return *this;
     }
-  RemoveAll ();
+  RemoveOverflow ();
   m_next = o.m_next;
   if (m_next != 0) 
     {
@@ -325,11 +429,59 @@ PacketTagList::operator = (PacketTagList const &o)
 
 PacketTagList::~PacketTagList ()
 {
-  RemoveAll ();
+  RemoveOverflow ();
+}
+
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  m_inlineN = o.m_inlineN;
+  m_inlineSize = o.m_inlineSize;
+  for (uint32_t i = 0; i < m_inlineN; i++)
+    {
+      m_inline[i] = o.m_inline[i];
+    }
+  std::memcpy (m_inlineData, o.m_inlineData, m_inlineSize);
+}
+
+uint32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  for (uint32_t i = 0; i < m_inlineN; i++)
+    {
+      if (m_inline[i].tid == tid)
+        {
+          return i;
+        }
+    }
+  return INLINE_TAGS;
+}
+
+uint32_t
+PacketTagList::GetInlineN (void) const
+{
+  return m_inlineN;
+}
+
+void
+PacketTagList::PeekInline (uint32_t i, TypeId *tid,
+                           const uint8_t **data, uint32_t *size) const
+{
+  *tid = m_inline[i].tid;
+  *data = m_inlineData + m_inline[i].start;
+  *size = m_inline[i].size;
 }
 
 void
 PacketTagList::RemoveAll (void)
+{
+  m_inlineN = 0;
+  m_inlineSize = 0;
+  RemoveOverflow ();
+}
+
+void
+PacketTagList::RemoveOverflow (void)
 {
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
@@ -341,15 +493,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          FreeTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      FreeTagData (prev);
     }
   m_next = 0;
 }
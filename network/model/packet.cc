@@ -28,7 +28,13 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
+#ifdef NS3_PACKET_FAST_MODE
+bool Packet::m_fastMode = true;
+#else
+bool Packet::m_fastMode = false;
+#endif
+bool Packet::m_multithreaded = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,39 +87,52 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagList &list)
+  : m_list (&list),
+    m_inline (0),
+    m_current (list.Head ())
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_inline < m_list->GetInlineN () || m_current != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  if (m_inline < m_list->GetInlineN ())
+    {
+      TypeId tid;
+      const uint8_t *data;
+      uint32_t size;
+      m_list->PeekInline (m_inline, &tid, &data, &size);
+      m_inline++;
+      return PacketTagIterator::Item (tid, data, size);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  return PacketTagIterator::Item (prev->tid, prev->data, prev->size);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data, uint32_t size)
+  : m_tid (tid),
+    m_data (data),
+    m_size (size)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data + m_data->size));
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data + m_size));
 }
 
 
@@ -126,6 +145,21 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (m_buffer.CreateDeepCopy (),
+                                              m_byteTagList.CreateDeepCopy (),
+                                              m_packetTagList.CreateDeepCopy (),
+                                              m_metadata.CreateDeepCopy ()),
+                                  false);
+  if (m_nixVector)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,10 +170,10 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | m_globalUid.fetch_add (1, std::memory_order_relaxed), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -178,10 +212,10 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | m_globalUid.fetch_add (1, std::memory_order_relaxed), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +238,10 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | m_globalUid.fetch_add (1, std::memory_order_relaxed), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -231,11 +265,19 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   ByteTagList byteTagList = m_byteTagList;
   byteTagList.Adjust (-start);
   NS_ASSERT (m_buffer.GetSize () >= start + length);
-  uint32_t end = m_buffer.GetSize () - (start + length);
-  PacketMetadata metadata = m_metadata.CreateFragment (start, end);
   // again, call the constructor directly rather than
   // through Create because it is private.
-  Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
+  Ptr<Packet> ret;
+  if (m_fastMode)
+    {
+      ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, m_metadata), false);
+    }
+  else
+    {
+      uint32_t end = m_buffer.GetSize () - (start + length);
+      PacketMetadata metadata = m_metadata.CreateFragment (start, end);
+      ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
+    }
   ret->SetNixVector (GetNixVector ());
   return ret;
 }
@@ -252,16 +294,28 @@ Packet::GetNixVector (void) const
   return m_nixVector;
 } 
 
+bool
+Packet::NeedsByteTagFixup (void) const
+{
+  return !m_fastMode || !m_byteTagList.IsEmpty ();
+}
+
 void
 Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
   m_buffer.AddAtStart (size);
-  m_byteTagList.Adjust (size);
-  m_byteTagList.AddAtStart (size);
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.Adjust (size);
+      m_byteTagList.AddAtStart (size);
+    }
   header.Serialize (m_buffer.Begin ());
-  m_metadata.AddHeader (header, size);
+  if (!m_fastMode)
+    {
+      m_metadata.AddHeader (header, size);
+    }
 }
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
@@ -272,8 +326,14 @@ Packet::RemoveHeader (Header &header, uint32_t size)
   uint32_t deserialized = header.Deserialize (m_buffer.Begin (), end);
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.Adjust (-deserialized);
+    }
+  if (!m_fastMode)
+    {
+      m_metadata.RemoveHeader (header, deserialized);
+    }
   return deserialized;
 }
 uint32_t
@@ -282,8 +342,14 @@ Packet::RemoveHeader (Header &header)
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.Adjust (-deserialized);
+    }
+  if (!m_fastMode)
+    {
+      m_metadata.RemoveHeader (header, deserialized);
+    }
   return deserialized;
 }
 uint32_t
@@ -308,11 +374,17 @@ Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
-  m_byteTagList.AddAtEnd (GetSize ());
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.AddAtEnd (GetSize ());
+    }
   m_buffer.AddAtEnd (size);
   Buffer::Iterator end = m_buffer.End ();
   trailer.Serialize (end);
-  m_metadata.AddTrailer (trailer, size);
+  if (!m_fastMode)
+    {
+      m_metadata.AddTrailer (trailer, size);
+    }
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
@@ -320,7 +392,10 @@ Packet::RemoveTrailer (Trailer &trailer)
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
-  m_metadata.RemoveTrailer (trailer, deserialized);
+  if (!m_fastMode)
+    {
+      m_metadata.RemoveTrailer (trailer, deserialized);
+    }
   return deserialized;
 }
 uint32_t
@@ -335,36 +410,57 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
-  m_byteTagList.AddAtEnd (GetSize ());
-  ByteTagList copy = packet->m_byteTagList;
-  copy.AddAtStart (0);
-  copy.Adjust (GetSize ());
-  m_byteTagList.Add (copy);
+  if (NeedsByteTagFixup () || packet->NeedsByteTagFixup ())
+    {
+      m_byteTagList.AddAtEnd (GetSize ());
+      ByteTagList copy = packet->m_byteTagList;
+      copy.AddAtStart (0);
+      copy.Adjust (GetSize ());
+      m_byteTagList.Add (copy);
+    }
   m_buffer.AddAtEnd (packet->m_buffer);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  if (!m_fastMode)
+    {
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  m_byteTagList.AddAtEnd (GetSize ());
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.AddAtEnd (GetSize ());
+    }
   m_buffer.AddAtEnd (size);
-  m_metadata.AddPaddingAtEnd (size);
+  if (!m_fastMode)
+    {
+      m_metadata.AddPaddingAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtEnd (size);
-  m_metadata.RemoveAtEnd (size);
+  if (!m_fastMode)
+    {
+      m_metadata.RemoveAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtStart (size);
-  m_byteTagList.Adjust (-size);
-  m_metadata.RemoveAtStart (size);
+  if (NeedsByteTagFixup ())
+    {
+      m_byteTagList.Adjust (-size);
+    }
+  if (!m_fastMode)
+    {
+      m_metadata.RemoveAtStart (size);
+    }
 }
 
 void 
@@ -572,6 +668,9 @@ void
 Packet::EnablePrinting (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (!m_fastMode,
+                 "Error: the packet metadata cannot be enabled "
+                 "with the fast packet mode.");
   PacketMetadata::Enable ();
 }
 
@@ -579,9 +678,55 @@ void
 Packet::EnableChecking (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (!m_fastMode,
+                 "Error: the packet metadata cannot be enabled "
+                 "with the fast packet mode.");
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableFastMode (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (!PacketMetadata::IsEnabled (),
+                 "Error: the fast packet mode cannot be enabled "
+                 "with packet printing or checking.");
+  m_fastMode = true;
+}
+
+void
+Packet::DisableFastMode (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_fastMode = false;
+}
+
+bool
+Packet::IsFastMode (void)
+{
+  return m_fastMode;
+}
+
+void
+Packet::EnableMultithreading (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_multithreaded = true;
+}
+
+void
+Packet::DisableMultithreading (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_multithreaded = false;
+}
+
+bool
+Packet::IsMultithreaded (void)
+{
+  return m_multithreaded;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -909,7 +1054,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
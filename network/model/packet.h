@@ -34,6 +34,7 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include <atomic>
 
 namespace ns3 {
 
@@ -155,10 +156,14 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the type of the tag.
+     * \param data the serialized tag.
+     * \param size the size of the serialized tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data, uint32_t size);
+    TypeId m_tid;          //!< the type of the tag
+    const uint8_t *m_data; //!< the serialized tag
+    uint32_t m_size;       //!< the size of the serialized tag
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -173,10 +178,12 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the tags of the packet
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const PacketTagList &list);
+  const PacketTagList *m_list;  //!< the tags of the packet
+  uint32_t m_inline;            //!< actual position over the inline tags
+  const struct PacketTagList::TagData *m_current;  //!< actual position over the overflow tags
 };
 
 /**
@@ -199,7 +206,8 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. When neither is needed, Packet::EnableFastMode
+ * bypasses the metadata entirely.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -453,6 +461,19 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with it.
+   *
+   * The reference counts of the datasets shared by COW copies are not
+   * atomic, so a packet handed to an event of another thread must be a
+   * deep copy. Channels between nodes should use this method rather
+   * than Copy when IsMultithreaded returns true. The byte and packet
+   * tags, the metadata and the nix-vector are kept.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -530,6 +551,53 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the fast packet mode.
+   *
+   * Even when printing and checking are disabled, every operation on
+   * a packet goes through the metadata hooks, which look up the TypeId
+   * of each header and trailer. In the fast mode, the metadata is not
+   * touched at all, and the byte tag offsets are only fixed up when the
+   * packet carries byte tags.
+   *
+   * The fast mode cannot be combined with EnablePrinting or
+   * EnableChecking. It can also be enabled at build time, by
+   * configuring with
+   * \code
+   *   CXXFLAGS="-DNS3_PACKET_FAST_MODE" ./waf configure ...
+   * \endcode
+   */
+  static void EnableFastMode (void);
+  /**
+   * \brief Disable the fast packet mode.
+   *
+   * The packets used in the fast mode keep no metadata, so printing
+   * and checking should not be enabled afterwards.
+   */
+  static void DisableFastMode (void);
+  /**
+   * \brief Check if the fast packet mode is enabled.
+   * \returns true if the metadata is bypassed
+   */
+  static bool IsFastMode (void);
+  /**
+   * \brief Declare that the events of different nodes run on several
+   * threads.
+   *
+   * Called by the multithreaded simulator when it starts its threads.
+   * The packet uids stay unique, but the order in which they are
+   * allocated then depends on the scheduling of the threads.
+   */
+  static void EnableMultithreading (void);
+  /**
+   * \brief Declare that the events of all the nodes run on one thread.
+   */
+  static void DisableMultithreading (void);
+  /**
+   * \brief Check if the events of different nodes run on several threads.
+   * \returns true if the packets sent to another node must be deep copies
+   */
+  static bool IsMultithreaded (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -748,6 +816,12 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Check if the byte tag offsets must be fixed up.
+   * \returns false in the fast mode, when the packet has no byte tag
+   */
+  bool NeedsByteTagFixup (void) const;
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -756,7 +830,9 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+  static bool m_fastMode;      //!< Bypass the metadata
+  static bool m_multithreaded; //!< The nodes run on several threads
 };
 
 /**
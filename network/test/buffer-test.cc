@@ -378,6 +378,141 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Chained Buffer unit tests: fragments and aggregates which share the
+ * original bytes.
+ */
+class BufferChainTest : public TestCase {
+private:
+  /**
+   * Check the content of a buffer against the original bytes, through
+   * CopyData, PeekData and the iterators.
+   * \param b The buffer to check
+   * \param offset The offset of the buffer in the original bytes
+   * \param msg The message on failure
+   */
+  void CheckContent (const Buffer &b, uint32_t offset, std::string msg);
+public:
+  virtual void DoRun (void);
+  BufferChainTest ();
+};
+
+BufferChainTest::BufferChainTest ()
+  : TestCase ("Chained buffers") {
+}
+
+void
+BufferChainTest::CheckContent (const Buffer &b, uint32_t offset, std::string msg)
+{
+  std::vector<uint8_t> copy (b.GetSize ());
+  NS_TEST_EXPECT_MSG_EQ (b.CopyData (&copy[0], b.GetSize ()), b.GetSize (), msg);
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < b.GetSize (); j++)
+    {
+      uint8_t expected = (offset + j) & 0xff;
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)copy[j], (uint32_t)expected, msg << ": CopyData at " << j);
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), (uint32_t)expected, msg << ": ReadU8 at " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, msg << ": iterator not at the end");
+  Buffer flat = b;
+  NS_TEST_EXPECT_MSG_EQ (memcmp (flat.PeekData (), &copy[0], b.GetSize ()), 0, msg << ": PeekData");
+}
+
+void
+BufferChainTest::DoRun (void)
+{
+  const uint32_t size = 2000;
+  Buffer payload;
+  payload.AddAtStart (size);
+  Buffer::Iterator i = payload.Begin ();
+  for (uint32_t j = 0; j < size; j++)
+    {
+      i.WriteU8 (j & 0xff);
+    }
+
+  // Fragment, reassemble and fragment again without allocating data.
+  PacketDataPool::Stats before = Buffer::GetPoolStats ();
+  Buffer frag0 = payload.CreateFragment (0, 700);
+  Buffer frag1 = payload.CreateFragment (700, 600);
+  Buffer frag2 = payload.CreateFragment (1300, 700);
+  Buffer whole = frag0;
+  whole.AddAtEnd (frag1);
+  whole.AddAtEnd (frag2);
+  Buffer middle = whole.CreateFragment (500, 1000);
+  PacketDataPool::Stats after = Buffer::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.allocations, before.allocations, "Payload bytes copied");
+  NS_TEST_ASSERT_MSG_EQ (whole.GetSize (), size, "Wrong reassembled size");
+  NS_TEST_ASSERT_MSG_EQ (middle.GetSize (), 1000, "Wrong fragment size");
+  CheckContent (whole, 0, "reassembled");
+  CheckContent (middle, 500, "fragment across segments");
+
+  // Reads across the segments.
+  i = whole.Begin ();
+  i.Next (699);
+  uint16_t across = ((699 & 0xff) << 8) | (700 & 0xff);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU16 (), across, "Wrong read across segments");
+  i = whole.Begin ();
+  Buffer::Iterator j = payload.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.CalculateIpChecksum (size), j.CalculateIpChecksum (size), "Wrong checksum");
+
+  // Headers and trailers around shared bytes.
+  Buffer packet = frag1;
+  packet.AddAtStart (20);
+  i = packet.Begin ();
+  for (uint32_t k = 0; k < 20; k++)
+    {
+      i.WriteU8 ((680 + k) & 0xff);
+    }
+  packet.AddAtEnd (4);
+  i = packet.End ();
+  i.Prev (4);
+  i.WriteHtonU32 ((1300 & 0xff) << 24 | (1301 & 0xff) << 16 | (1302 & 0xff) << 8 | (1303 & 0xff));
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 624, "Wrong size with header and trailer");
+  CheckContent (packet, 680, "header and trailer");
+  CheckContent (frag1, 700, "original fragment");
+  packet.RemoveAtStart (30);
+  packet.RemoveAtEnd (14);
+  CheckContent (packet, 710, "removed at both ends");
+  packet.RemoveAtEnd (packet.GetSize ());
+  NS_TEST_EXPECT_MSG_EQ (packet.GetSize (), 0, "Buffer size not zero");
+
+  // Writes across the segments, and copies to a plain buffer.
+  i = whole.Begin ();
+  i.Next (698);
+  i.WriteHtonU32 (0x01020304);
+  i.Prev (4);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Wrong write across segments");
+  i.Prev (4);
+  uint8_t original[4] = { 698 & 0xff, 699 & 0xff, 700 & 0xff, 701 & 0xff };
+  i.Write (original, 4);
+  CheckContent (whole, 0, "rewritten");
+  CheckContent (payload, 0, "original payload");
+  i = whole.Begin ();
+  i.Next (690);
+  Buffer::Iterator end = i;
+  end.Next (20);
+  Buffer plain;
+  plain.AddAtStart (20);
+  plain.Begin ().Write (i, end);
+  CheckContent (plain, 690, "copied from a chain");
+
+  // Serialization, as a plain buffer.
+  std::vector<uint8_t> bytes (whole.GetSize ());
+  whole.CopyData (&bytes[0], bytes.size ());
+  Buffer flat;
+  flat.AddAtStart (bytes.size ());
+  flat.Begin ().Write (&bytes[0], bytes.size ());
+  NS_TEST_ASSERT_MSG_EQ (whole.GetSerializedSize (), flat.GetSerializedSize (), "Wrong serialized size");
+  std::vector<uint8_t> serialized (whole.GetSerializedSize ());
+  std::vector<uint8_t> expected (flat.GetSerializedSize ());
+  NS_TEST_EXPECT_MSG_EQ (whole.Serialize (&serialized[0], serialized.size ()), 1, "Serialization failed");
+  NS_TEST_EXPECT_MSG_EQ (flat.Serialize (&expected[0], expected.size ()), 1, "Serialization failed");
+  NS_TEST_EXPECT_MSG_EQ ((serialized == expected), true, "Wrong serialization");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +529,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChainTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
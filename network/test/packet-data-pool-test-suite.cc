@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-data-pool.h"
+#include "ns3/buffer.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the size classes and the recycling of a PacketDataPool.
+ */
+class PacketDataPoolTestCase : public TestCase
+{
+public:
+  PacketDataPoolTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketDataPoolTestCase::PacketDataPoolTestCase ()
+  : TestCase ("Check the packet data pool")
+{
+}
+
+void
+PacketDataPoolTestCase::DoRun (void)
+{
+  PacketDataPool pool;
+  uint32_t capacity;
+  uint8_t *block = pool.Allocate (100, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 128, "Wrong size class");
+  pool.Recycle (block, capacity);
+
+  uint8_t *reused = pool.Allocate (20, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 128, "Recycled block not reused");
+  NS_TEST_EXPECT_MSG_EQ ((reused == block), true, "Block not reused");
+
+  // A larger block makes the smaller ones useless.
+  uint8_t *large = pool.Allocate (1000, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 1024, "Wrong size class");
+  pool.Recycle (large, capacity);
+  NS_TEST_EXPECT_MSG_EQ (pool.GetMaxSize (), 1024, "Wrong largest block");
+  pool.Recycle (reused, 128);
+
+  // Overflow the thread cache into the depot, and take the blocks back.
+  std::vector<uint8_t *> blocks;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      blocks.push_back (pool.Allocate (1000, &capacity));
+    }
+  for (uint32_t i = 0; i < blocks.size (); i++)
+    {
+      pool.Recycle (blocks[i], capacity);
+    }
+  for (uint32_t i = 0; i < blocks.size (); i++)
+    {
+      blocks[i] = pool.Allocate (1000, &capacity);
+    }
+  for (uint32_t i = 0; i < blocks.size (); i++)
+    {
+      pool.Recycle (blocks[i], capacity);
+    }
+
+  PacketDataPool::Stats stats = pool.GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.allocations, 403, "Wrong number of allocations");
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, 202, "Wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (stats.recycles, 403, "Wrong number of recycles");
+  NS_TEST_EXPECT_MSG_EQ (stats.releases, 1, "Wrong number of releases");
+
+  // Without a recycled block, a small request is not rounded up to the
+  // largest one.
+  PacketDataPool fresh;
+  uint8_t *first = fresh.Allocate (1000, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 1024, "Wrong size class");
+  uint8_t *small = fresh.Allocate (20, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 64, "Small request rounded up to the largest one");
+  fresh.Recycle (small, capacity);
+  fresh.Recycle (first, 1024);
+  small = fresh.Allocate (20, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 1024, "Recycled block not reused");
+  NS_TEST_EXPECT_MSG_EQ ((small == first), true, "Recycled block not reused");
+  fresh.Recycle (small, capacity);
+
+  // The ids of the destroyed pools are reused.
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      PacketDataPool temporary;
+      temporary.Recycle (temporary.Allocate (100, &capacity), capacity);
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the buffers of successive packets are recycled.
+ */
+class PacketDataPoolRecycleTestCase : public TestCase
+{
+public:
+  PacketDataPoolRecycleTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketDataPoolRecycleTestCase::PacketDataPoolRecycleTestCase ()
+  : TestCase ("Check the recycling of the packet buffers")
+{
+}
+
+void
+PacketDataPoolRecycleTestCase::DoRun (void)
+{
+  PacketDataPool::Stats before = Buffer::GetPoolStats ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      Ptr<Packet> copy = p->Copy ();
+      copy->RemoveAtStart (10);
+    }
+  PacketDataPool::Stats after = Buffer::GetPoolStats ();
+  uint64_t allocations = after.allocations - before.allocations;
+  uint64_t hits = after.hits - before.hits;
+  NS_TEST_EXPECT_MSG_GT (allocations, 0, "No buffer allocated");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (hits + 1, allocations, "Buffers not recycled");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketDataPool test suite.
+ */
+class PacketDataPoolTestSuite : public TestSuite
+{
+public:
+  PacketDataPoolTestSuite ();
+};
+
+PacketDataPoolTestSuite::PacketDataPoolTestSuite ()
+  : TestSuite ("packet-data-pool", UNIT)
+{
+  AddTestCase (new PacketDataPoolTestCase, TestCase::QUICK);
+  AddTestCase (new PacketDataPoolRecycleTestCase, TestCase::QUICK);
+}
+
+static PacketDataPoolTestSuite g_packetDataPoolTestSuite; //!< Static variable for test initialization
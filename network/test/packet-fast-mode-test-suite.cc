@@ -0,0 +1,499 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/trailer.h"
+#include "ns3/tag.h"
+#include "ns3/test.h"
+
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief A header of N bytes, which carries a value.
+ *
+ * \note Class internal to packet-fast-mode-test-suite.cc
+ */
+template <int N>
+class FastModeHeader : public Header
+{
+public:
+  /**
+   * Constructor.
+   * \param value The value of the header.
+   */
+  FastModeHeader (uint8_t value = 0);
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \returns The value of the header.
+   */
+  uint8_t GetValue (void) const;
+private:
+  uint8_t m_value; //!< The value of the header.
+};
+
+template <int N>
+FastModeHeader<N>::FastModeHeader (uint8_t value)
+  : m_value (value)
+{
+}
+
+template <int N>
+TypeId
+FastModeHeader<N>::GetTypeId (void)
+{
+  std::ostringstream oss;
+  oss << "ns3::FastModeHeader<" << N << ">";
+  static TypeId tid = TypeId (oss.str ().c_str ())
+    .SetParent<Header> ()
+    .SetGroupName ("Network")
+    .AddConstructor<FastModeHeader<N> > ()
+  ;
+  return tid;
+}
+
+template <int N>
+TypeId
+FastModeHeader<N>::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+template <int N>
+void
+FastModeHeader<N>::Print (std::ostream &os) const
+{
+  os << (uint32_t)m_value;
+}
+
+template <int N>
+uint32_t
+FastModeHeader<N>::GetSerializedSize (void) const
+{
+  return N;
+}
+
+template <int N>
+void
+FastModeHeader<N>::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU8 (m_value, N);
+}
+
+template <int N>
+uint32_t
+FastModeHeader<N>::Deserialize (Buffer::Iterator start)
+{
+  m_value = start.ReadU8 ();
+  return N;
+}
+
+template <int N>
+uint8_t
+FastModeHeader<N>::GetValue (void) const
+{
+  return m_value;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief A 4 bytes trailer, which carries a value.
+ *
+ * \note Class internal to packet-fast-mode-test-suite.cc
+ */
+class FastModeTrailer : public Trailer
+{
+public:
+  /**
+   * Constructor.
+   * \param value The value of the trailer.
+   */
+  FastModeTrailer (uint32_t value = 0);
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  /**
+   * \returns The value of the trailer.
+   */
+  uint32_t GetValue (void) const;
+private:
+  uint32_t m_value; //!< The value of the trailer.
+};
+
+FastModeTrailer::FastModeTrailer (uint32_t value)
+  : m_value (value)
+{
+}
+
+TypeId
+FastModeTrailer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FastModeTrailer")
+    .SetParent<Trailer> ()
+    .SetGroupName ("Network")
+    .AddConstructor<FastModeTrailer> ()
+  ;
+  return tid;
+}
+
+TypeId
+FastModeTrailer::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+FastModeTrailer::Print (std::ostream &os) const
+{
+  os << m_value;
+}
+
+uint32_t
+FastModeTrailer::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+FastModeTrailer::Serialize (Buffer::Iterator start) const
+{
+  start.Prev (4);
+  start.WriteHtonU32 (m_value);
+}
+
+uint32_t
+FastModeTrailer::Deserialize (Buffer::Iterator start)
+{
+  start.Prev (4);
+  m_value = start.ReadNtohU32 ();
+  return 4;
+}
+
+uint32_t
+FastModeTrailer::GetValue (void) const
+{
+  return m_value;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief An empty byte tag.
+ *
+ * \note Class internal to packet-fast-mode-test-suite.cc
+ */
+class FastModeTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+};
+
+TypeId
+FastModeTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FastModeTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<FastModeTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+FastModeTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+FastModeTag::GetSerializedSize (void) const
+{
+  return 0;
+}
+
+void
+FastModeTag::Serialize (TagBuffer i) const
+{
+}
+
+void
+FastModeTag::Deserialize (TagBuffer i)
+{
+}
+
+void
+FastModeTag::Print (std::ostream &os) const
+{
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the packet operations in the fast packet mode.
+ */
+class PacketFastModeTestCase : public TestCase
+{
+public:
+  PacketFastModeTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the byte tag of a packet.
+   * \param p The packet.
+   * \param start The expected start of the tag.
+   * \param end The expected end of the tag.
+   */
+  void CheckTag (Ptr<const Packet> p, uint32_t start, uint32_t end);
+};
+
+PacketFastModeTestCase::PacketFastModeTestCase ()
+  : TestCase ("Check the fast packet mode")
+{
+}
+
+void
+PacketFastModeTestCase::CheckTag (Ptr<const Packet> p, uint32_t start, uint32_t end)
+{
+  ByteTagIterator i = p->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "No byte tag");
+  ByteTagIterator::Item item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.GetStart (), start, "Wrong start of byte tag");
+  NS_TEST_EXPECT_MSG_EQ (item.GetEnd (), end, "Wrong end of byte tag");
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "Unexpected byte tag");
+}
+
+void
+PacketFastModeTestCase::DoRun (void)
+{
+  Packet::EnableFastMode ();
+  NS_TEST_ASSERT_MSG_EQ (Packet::IsFastMode (), true, "Fast mode not enabled");
+
+  // Without byte tags.
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (FastModeHeader<8> (1));
+  p->AddHeader (FastModeHeader<20> (2));
+  p->AddTrailer (FastModeTrailer (3));
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 132, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (p->BeginItem ().HasNext (), false, "Unexpected metadata");
+  NS_TEST_EXPECT_MSG_EQ (p->GetByteTagIterator ().HasNext (), false, "Unexpected byte tag");
+
+  // The byte tag offsets are still fixed up when there are byte tags.
+  Ptr<Packet> q = Create<Packet> (50);
+  q->AddByteTag (FastModeTag ());
+  q->AddHeader (FastModeHeader<2> (4));
+  CheckTag (q, 2, 52);
+  q->AddTrailer (FastModeTrailer (5));
+  CheckTag (q, 2, 52);
+
+  Ptr<Packet> aggregate = p->Copy ();
+  aggregate->AddAtEnd (q);
+  NS_TEST_EXPECT_MSG_EQ (aggregate->GetSize (), 188, "Wrong size");
+  CheckTag (aggregate, 134, 184);
+
+  Ptr<Packet> fragment = aggregate->CreateFragment (130, 58);
+  NS_TEST_EXPECT_MSG_EQ (fragment->GetUid (), aggregate->GetUid (), "Wrong uid");
+  FastModeTrailer trailer;
+  fragment->RemoveTrailer (trailer);
+  NS_TEST_EXPECT_MSG_EQ (trailer.GetValue (), 5, "Wrong trailer");
+  fragment->RemoveAtStart (2);
+  FastModeHeader<2> small;
+  fragment->RemoveHeader (small);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)small.GetValue (), 4, "Wrong header");
+  CheckTag (fragment, 0, 50);
+
+  FastModeHeader<20> large;
+  FastModeHeader<8> medium;
+  p->RemoveTrailer (trailer);
+  p->RemoveHeader (large);
+  p->RemoveHeader (medium);
+  NS_TEST_EXPECT_MSG_EQ (trailer.GetValue (), 3, "Wrong trailer");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)large.GetValue (), 2, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)medium.GetValue (), 1, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "Wrong size");
+
+  Packet::DisableFastMode ();
+  NS_TEST_EXPECT_MSG_EQ (Packet::IsFastMode (), false, "Fast mode not disabled");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet fast mode test suite.
+ */
+class PacketFastModeTestSuite : public TestSuite
+{
+public:
+  PacketFastModeTestSuite ();
+};
+
+PacketFastModeTestSuite::PacketFastModeTestSuite ()
+  : TestSuite ("packet-fast-mode", UNIT)
+{
+  AddTestCase (new PacketFastModeTestCase, TestCase::QUICK);
+}
+
+static PacketFastModeTestSuite g_packetFastModeTestSuite; //!< Static variable for test initialization
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Measure the packet throughput along a chain of point-to-point
+ * links, with and without the fast packet mode.
+ *
+ * At each hop, the link header is added by the sending device and
+ * removed by the receiving one, and the network header is removed and
+ * added again to forward the packet, as a router would.
+ */
+class PacketFastModeThroughputTestCase : public TestCase
+{
+public:
+  PacketFastModeThroughputTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets along the chain.
+   * \returns The number of packets per second.
+   */
+  double Run (void);
+
+  /** Benchmark parameters. */
+  enum {
+    PACKETS = 100000,  //!< The number of packets sent.
+    HOPS = 8,          //!< The number of links of the chain.
+    PAYLOAD = 512      //!< The size of the payload of each packet.
+  };
+};
+
+PacketFastModeThroughputTestCase::PacketFastModeThroughputTestCase ()
+  : TestCase ("Measure the packet throughput on a point-to-point chain")
+{
+}
+
+double
+PacketFastModeThroughputTestCase::Run (void)
+{
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < PACKETS; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (PAYLOAD);
+      p->AddHeader (FastModeHeader<8> (17));
+      p->AddHeader (FastModeHeader<20> (HOPS));
+      for (uint32_t hop = 0; hop < HOPS; hop++)
+        {
+          p->AddHeader (FastModeHeader<2> (0x21));
+          FastModeHeader<2> link;
+          p->RemoveHeader (link);
+          FastModeHeader<20> network;
+          p->RemoveHeader (network);
+          p->AddHeader (FastModeHeader<20> (network.GetValue () - 1));
+        }
+      FastModeHeader<20> network;
+      FastModeHeader<8> transport;
+      p->RemoveHeader (network);
+      p->RemoveHeader (transport);
+      NS_ASSERT (p->GetSize () == PAYLOAD && network.GetValue () == 0);
+    }
+  std::clock_t stop = std::clock ();
+  double seconds = double (stop - start) / CLOCKS_PER_SEC;
+  return seconds > 0 ? PACKETS / seconds : 0;
+}
+
+void
+PacketFastModeThroughputTestCase::DoRun (void)
+{
+  bool fastMode = Packet::IsFastMode ();
+  Packet::DisableFastMode ();
+  double slow = Run ();
+  Packet::EnableFastMode ();
+  double fast = Run ();
+  if (!fastMode)
+    {
+      Packet::DisableFastMode ();
+    }
+
+  std::cout << GetName () << ": " << HOPS << " hops, "
+            << PACKETS << " packets" << std::endl;
+  std::cout << "  default mode: " << slow << " packets/s" << std::endl;
+  std::cout << "  fast mode:    " << fast << " packets/s";
+  if (slow > 0)
+    {
+      std::cout << " (x" << fast / slow << ")";
+    }
+  std::cout << std::endl;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet fast mode performance test suite.
+ */
+class PacketFastModePerformanceTestSuite : public TestSuite
+{
+public:
+  PacketFastModePerformanceTestSuite ();
+};
+
+PacketFastModePerformanceTestSuite::PacketFastModePerformanceTestSuite ()
+  : TestSuite ("packet-fast-mode-perf", PERFORMANCE)
+{
+  AddTestCase (new PacketFastModeThroughputTestCase, TestCase::QUICK);
+}
+
+static PacketFastModePerformanceTestSuite g_packetFastModePerformanceTestSuite; //!< Static variable for test initialization
@@ -23,6 +23,7 @@
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
 #include <string>
+#include <set>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
@@ -737,6 +738,38 @@ PacketTest::DoRun (void)
     ALargeTestTag a;
     tmp->AddPacketTag (a); 
   }
+
+  /* Test DeepCopy, with an inline and an overflow packet tag. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello"), 5);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddAtEnd (Create<Packet> (30));
+    tmp->AddPacketTag (ATestTag<1> ());
+    tmp->AddPacketTag (ATestTag<100> ());
+    Ptr<Packet> copy = tmp->DeepCopy ();
+    tmp->RemoveAtStart (10);
+    tmp->RemoveAllPacketTags ();
+    tmp->RemoveAllByteTags ();
+
+    NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), tmp->GetUid (), "The uid should be kept");
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 45, "The size should be kept");
+    CHECK (copy, 1, E (20, 0, 15));
+    ATestTag<1> inlineTag;
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (inlineTag), true, "The inline tag should be kept");
+    NS_TEST_EXPECT_MSG_EQ (inlineTag.m_error, false, "Wrong inline tag");
+    ATestTag<100> overflowTag;
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (overflowTag), true, "The overflow tag should be kept");
+    NS_TEST_EXPECT_MSG_EQ (overflowTag.m_error, false, "Wrong overflow tag");
+    uint8_t buf[45];
+    copy->CopyData (buf, sizeof (buf));
+    std::string hello = std::string (reinterpret_cast<const char *> (buf) + 10, 5);
+    NS_TEST_EXPECT_MSG_EQ (hello, "hello", "The data should be kept");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (buf[44]), 0, "The zero bytes should be kept");
+    ATestHeader<10> header;
+    copy->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "Wrong header");
+  }
 }
 
 /**
@@ -994,6 +1027,45 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline and overflow storage
+    std::cout << GetName () << "check inline and overflow tags" << std::endl;
+    MAKE_TEST_TAGS ;          // fresh values, after the replacements
+    ATestTag<70> big (3);     // too large to be inline
+    PacketTagList ptl = ref;
+    ptl.Remove (t2);          // inline, packs the following ones
+    ptl.Add (big);
+    ptl.Remove (t6);          // overflow
+    CheckRefList (ref, "inline/overflow orig");
+    const char * msg = "inline/overflow copy";
+    CheckRef (ptl, t1, msg, false);
+    CheckRef (ptl, t2, msg, true);
+    CheckRef (ptl, t3, msg, false);
+    CheckRef (ptl, t4, msg, false);
+    CheckRef (ptl, t5, msg, false);
+    CheckRef (ptl, t6, msg, true);
+    CheckRef (ptl, t7, msg, false);
+    CheckRef (ptl, big, msg, false);
+    ptl.Add (t2);             // inline again
+    CheckRef (ptl, t2, msg, false);
+    NS_TEST_EXPECT_MSG_EQ (big.m_error, false, msg << ": big tag data");
+
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddPacketTag (t1);
+    p->AddPacketTag (t2);
+    p->AddPacketTag (big);
+    p->AddPacketTag (t3);
+    p->AddPacketTag (t4);
+    p->AddPacketTag (t5);
+    std::set<TypeId> tids;
+    PacketTagIterator i = p->GetPacketTagIterator ();
+    while (i.HasNext ())
+      {
+        tids.insert (i.Next ().GetTypeId ());
+      }
+    NS_TEST_EXPECT_MSG_EQ (tids.size (), 6, "iterated tags");
+    NS_TEST_EXPECT_MSG_EQ (tids.count (big.GetInstanceTypeId ()), 1, "iterated big tag");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
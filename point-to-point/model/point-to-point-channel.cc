@@ -80,6 +80,14 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      for (uint32_t i = 0; i < N_DEVICES; i++)
+        {
+          Ptr<Node> node = m_link[i].m_dst->GetNode ();
+          if (node != 0)
+            {
+              m_link[i].m_dstNodeId = node->GetId ();
+            }
+        }
     }
 }
 
@@ -97,12 +105,25 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  // The devices were attached before being added to their nodes.
+  if (m_link[wire].m_dstNodeId == NO_NODE)
+    {
+      m_link[wire].m_dstNodeId = m_link[wire].m_dst->GetNode ()->GetId ();
+    }
+
+  // The receiver may run on another thread, which must not share the
+  // reference counts of the packet or of its device with this one: the
+  // event holds a deep copy of the packet and a plain device pointer.
+  Ptr<Packet> copy = Packet::IsMultithreaded () ? p->DeepCopy () : p->Copy ();
+  Simulator::ScheduleWithContext (m_link[wire].m_dstNodeId,
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+                                  PeekPointer (m_link[wire].m_dst), copy);
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  if (!m_txrxPointToPoint.IsEmpty ())
+    {
+      m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+    }
   return true;
 }
 
@@ -128,6 +149,22 @@ PointToPointChannel::GetDevice (uint32_t i) const
   return GetPointToPointDevice (i);
 }
 
+Address
+PointToPointChannel::GetRemoteAddress (const PointToPointNetDevice *device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  for (uint32_t i = 0; i < N_DEVICES; ++i)
+    {
+      if (PeekPointer (m_link[i].m_src) == device)
+        {
+          return m_link[i].m_dst->GetAddress ();
+        }
+    }
+  NS_ASSERT (false);
+  // quiet compiler.
+  return Address ();
+}
+
 Time
 PointToPointChannel::GetDelay (void) const
 {
@@ -25,6 +25,7 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "ns3/address.h"
 
 namespace ns3 {
 
@@ -100,6 +101,19 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
+  /**
+   * \brief Get the address of the NetDevice at the other end of the
+   * channel
+   *
+   * Unlike GetDevice, this touches the reference count of neither
+   * device, so the receiving device can call it while the sending one
+   * runs on another thread.
+   *
+   * \param device The device at this end of the channel
+   * \returns The address of the device at the other end
+   */
+  Address GetRemoteAddress (const PointToPointNetDevice *device) const;
+
 protected:
   /**
    * \brief Get the delay associated with this channel
@@ -194,13 +208,23 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNodeId (NO_NODE) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    /**
+     * Id of the node of the second NetDevice, or NO_NODE if unknown.
+     *
+     * Looking the node up while sending would touch its reference
+     * count, which the receiving node may use on another thread.
+     */
+    uint32_t                   m_dstNodeId;
   };
 
+  /** The node id of a Link which is not known yet. */
+  static const uint32_t NO_NODE = 0xffffffff;
+
   Link    m_link[N_DEVICES]; //!< Link model
 };
 
@@ -20,6 +20,9 @@
 
 #include "jakes-propagation-loss-model.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -47,6 +50,28 @@ JakesPropagationLossModel::GetTypeId ()
     .SetParent<PropagationLossModel> ()
     .SetGroupName ("Propagation")
     .AddConstructor<JakesPropagationLossModel> ()
+    .AddAttribute ("CacheCapacity",
+                   "The maximum number of paths whose JakesProcess is kept. "
+                   "When it is reached, the least recently used path is "
+                   "forgotten. 0 means no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&JakesPropagationLossModel::SetCacheCapacity,
+                                         &JakesPropagationLossModel::GetCacheCapacity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CacheMaxAge",
+                   "The time after which the JakesProcess of an unused "
+                   "path is forgotten. 0 means no limit.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&JakesPropagationLossModel::SetCacheMaxAge,
+                                     &JakesPropagationLossModel::GetCacheMaxAge),
+                   MakeTimeChecker ())
+    .AddAttribute ("CacheInvalidateOnCourseChange",
+                   "If true, the JakesProcess of a path is forgotten when "
+                   "one of its nodes changes course.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&JakesPropagationLossModel::SetCacheInvalidateOnCourseChange,
+                                        &JakesPropagationLossModel::GetCacheInvalidateOnCourseChange),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -66,6 +91,42 @@ JakesPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + pathData->GetChannelGainDb ();
 }
 
+void
+JakesPropagationLossModel::SetCacheCapacity (uint32_t capacity)
+{
+  m_propagationCache.SetCapacity (capacity);
+}
+
+uint32_t
+JakesPropagationLossModel::GetCacheCapacity () const
+{
+  return m_propagationCache.GetCapacity ();
+}
+
+void
+JakesPropagationLossModel::SetCacheMaxAge (Time maxAge)
+{
+  m_propagationCache.SetMaxAge (maxAge);
+}
+
+Time
+JakesPropagationLossModel::GetCacheMaxAge () const
+{
+  return m_propagationCache.GetMaxAge ();
+}
+
+void
+JakesPropagationLossModel::SetCacheInvalidateOnCourseChange (bool invalidate)
+{
+  m_propagationCache.SetInvalidateOnCourseChange (invalidate);
+}
+
+bool
+JakesPropagationLossModel::GetCacheInvalidateOnCourseChange () const
+{
+  return m_propagationCache.GetInvalidateOnCourseChange ();
+}
+
 Ptr<UniformRandomVariable>
 JakesPropagationLossModel::GetUniformRandomVariable () const
 {
@@ -31,6 +31,11 @@ namespace ns3
  *
  * \brief a  Jakes narrowband propagation model.
  * Symmetrical cache for JakesProcess
+ *
+ * The cache keeps the JakesProcess of every path which was ever used,
+ * unless it is bounded with the CacheCapacity, CacheMaxAge and
+ * CacheInvalidateOnCourseChange attributes. A forgotten path gets a new,
+ * independent JakesProcess on its next use.
  */
 
 class JakesPropagationLossModel : public PropagationLossModel
@@ -65,6 +70,31 @@ private:
                         Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
+  /**
+   * \param capacity the maximum number of cached paths, or 0 for no limit
+   */
+  void SetCacheCapacity (uint32_t capacity);
+  /**
+   * \return the maximum number of cached paths, or 0 for no limit
+   */
+  uint32_t GetCacheCapacity () const;
+  /**
+   * \param maxAge the time after which an unused path is forgotten, or 0 for no limit
+   */
+  void SetCacheMaxAge (Time maxAge);
+  /**
+   * \return the time after which an unused path is forgotten, or 0 for no limit
+   */
+  Time GetCacheMaxAge () const;
+  /**
+   * \param invalidate whether a path is forgotten when one of its nodes changes course
+   */
+  void SetCacheInvalidateOnCourseChange (bool invalidate);
+  /**
+   * \return whether a path is forgotten when one of its nodes changes course
+   */
+  bool GetCacheInvalidateOnCourseChange () const;
+
   /**
    * Get the underlying RNG stream
    * \return the RNG stream
@@ -21,6 +21,11 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include <unordered_map>
+#include <list>
 #include <map>
 
 namespace ns3
@@ -30,30 +35,69 @@ namespace ns3
  * \brief Constructs a cache of objects, where each object is responsible for a single propagation path loss calculations.
  * Propagation path a-->b and b-->a is the same thing. Propagation path is identified by
  * a couple of MobilityModels and a spectrum model UID
+ *
+ * The paths are stored in a hash table. By default the cache is
+ * unbounded and never forgets a path. To keep the memory flat in long
+ * runs with many node pairs, the cache can be bounded:
+ *  - SetCapacity () limits the number of paths; when a path is added
+ *    to a full cache, the least recently used path is evicted.
+ *  - SetMaxAge () evicts the paths which were not used for longer
+ *    than the given time.
+ *  - SetInvalidateOnCourseChange () forgets a path when one of its
+ *    MobilityModels changes course since the path was added.
+ *
+ * An evicted path is created again by the user of the cache on its
+ * next use, as any missing path.
  */
 template<class T>
 class PropagationCache
 {
 public:
-  PropagationCache () {};
-  ~PropagationCache () {};
+  PropagationCache ()
+    : m_capacity (0),
+      m_maxAge (Seconds (0)),
+      m_invalidateOnCourseChange (false),
+      m_hits (0),
+      m_misses (0),
+      m_evictions (0)
+  {};
+  ~PropagationCache ()
+  {
+    for (typename CourseMap::iterator it = m_courses.begin (); it != m_courses.end (); ++it)
+      {
+        ConstCast<MobilityModel> (it->first)->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&PropagationCache<T>::NotifyCourseChange, this));
+      }
+  };
 
   /**
    * Get the model associated with the path
    * \param a 1st node mobility model
    * \param b 2nd node mobility model
    * \param modelUid model UID
-   * \return the model
+   * \return the model, or 0 if the path is not cached
    */
   Ptr<T> GetPathData (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid)
   {
+    EvictAged ();
     PropagationPathIdentifier key = PropagationPathIdentifier (a, b, modelUid);
     typename PathCache::iterator it = m_pathCache.find (key);
     if (it == m_pathCache.end ())
       {
+        m_misses++;
         return 0;
       }
-    return it->second;
+    if (it->second.m_tracksCourses
+        && (it->second.m_firstCourse != GetCourse (key.m_firstMobility)
+            || it->second.m_secondCourse != GetCourse (key.m_secondMobility)))
+      {
+        Evict (it);
+        m_misses++;
+        return 0;
+      }
+    it->second.m_lastUse = Simulator::Now ();
+    m_lru.splice (m_lru.begin (), m_lru, it->second.m_lruIterator);
+    m_hits++;
+    return it->second.m_data;
   };
 
   /**
@@ -67,9 +111,126 @@ public:
   {
     PropagationPathIdentifier key = PropagationPathIdentifier (a, b, modelUid);
     NS_ASSERT (m_pathCache.find (key) == m_pathCache.end ());
-    m_pathCache.insert (std::make_pair (key, data)); 
+    EvictAged ();
+    if (m_capacity > 0)
+      {
+        while (m_pathCache.size () >= m_capacity)
+          {
+            Evict (m_pathCache.find (m_lru.back ()));
+          }
+      }
+    PathData path;
+    path.m_data = data;
+    path.m_lastUse = Simulator::Now ();
+    path.m_tracksCourses = m_invalidateOnCourseChange;
+    path.m_firstCourse = m_invalidateOnCourseChange ? AcquireCourse (key.m_firstMobility) : 0;
+    path.m_secondCourse = m_invalidateOnCourseChange ? AcquireCourse (key.m_secondMobility) : 0;
+    m_lru.push_front (key);
+    path.m_lruIterator = m_lru.begin ();
+    m_pathCache.insert (std::make_pair (key, path));
+  };
+
+  /**
+   * Set the maximum number of paths in the cache. When a path is added
+   * to a full cache, the least recently used path is evicted.
+   * \param capacity the maximum number of paths, or 0 for no limit
+   */
+  void SetCapacity (uint32_t capacity)
+  {
+    m_capacity = capacity;
+    while (m_capacity > 0 && m_pathCache.size () > m_capacity)
+      {
+        Evict (m_pathCache.find (m_lru.back ()));
+      }
+  };
+  /**
+   * \return the maximum number of paths in the cache, or 0 for no limit
+   */
+  uint32_t GetCapacity () const
+  {
+    return m_capacity;
+  };
+
+  /**
+   * Set the time after which an unused path is evicted.
+   * \param maxAge the maximum time since the last use of a path, or 0 for no limit
+   */
+  void SetMaxAge (Time maxAge)
+  {
+    m_maxAge = maxAge;
+  };
+  /**
+   * \return the maximum time since the last use of a path, or 0 for no limit
+   */
+  Time GetMaxAge () const
+  {
+    return m_maxAge;
+  };
+
+  /**
+   * Set whether a path is forgotten when one of its MobilityModels
+   * changes course. This should be set before the cache is used: the
+   * paths added before are not affected. The cache follows the course
+   * changes of a MobilityModel while it holds paths to it.
+   * \param invalidate true to forget the paths on course changes
+   */
+  void SetInvalidateOnCourseChange (bool invalidate)
+  {
+    m_invalidateOnCourseChange = invalidate;
+  };
+  /**
+   * \return true if the paths are forgotten on course changes
+   */
+  bool GetInvalidateOnCourseChange () const
+  {
+    return m_invalidateOnCourseChange;
+  };
+
+  /**
+   * \return the number of paths in the cache
+   */
+  uint32_t GetSize () const
+  {
+    return m_pathCache.size ();
   };
+  /**
+   * \return the number of calls of GetPathData which found a path
+   */
+  uint64_t GetHits () const
+  {
+    return m_hits;
+  };
+  /**
+   * \return the number of calls of GetPathData which did not find a path
+   */
+  uint64_t GetMisses () const
+  {
+    return m_misses;
+  };
+  /**
+   * \return the number of paths evicted, because of the capacity,
+   * the age or a course change
+   */
+  uint64_t GetEvictions () const
+  {
+    return m_evictions;
+  };
+
 private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  PropagationCache (const PropagationCache &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  PropagationCache & operator = (const PropagationCache &);
+
   /// Each path is identified by
   struct PropagationPathIdentifier
   {
@@ -80,47 +241,176 @@ private:
      * @param modelUid model UID
      */
     PropagationPathIdentifier (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid) :
-      m_srcMobility (a), m_dstMobility (b), m_spectrumModelUid (modelUid)
+      m_firstMobility (std::min (a, b)), m_secondMobility (std::max (a, b)), m_spectrumModelUid (modelUid)
     {};
-    Ptr<const MobilityModel> m_srcMobility; //!< 1st node mobility model
-    Ptr<const MobilityModel> m_dstMobility; //!< 2nd node mobility model
+    /// Links are supposed to be symmetrical, the mobility models are sorted
+    Ptr<const MobilityModel> m_firstMobility; //!< the lower mobility model
+    Ptr<const MobilityModel> m_secondMobility; //!< the higher mobility model
     uint32_t m_spectrumModelUid; //!< model UID
 
     /**
-     * Less-than operator.
-     *
-     * The goal of this operator is just to provide a stable comparison
-     * to be used in containers requiring a order (of any kind).
-     *
-     * If the models are different, the comparison is based on their Uid.
-     * Otherwise, the comparison is based on the pointers of the Mobility models.
+     * Equality operator.
      *
      * \param other Right value of the operator.
-     * \returns True if the Left value is less than the Right value.
+     * \returns True if both values identify the same path.
      */
-    bool operator < (const PropagationPathIdentifier & other) const
+    bool operator == (const PropagationPathIdentifier & other) const
     {
-      if (m_spectrumModelUid != other.m_spectrumModelUid)
-        {
-          return m_spectrumModelUid < other.m_spectrumModelUid;
-        }
-      /// Links are supposed to be symmetrical!
-      if (std::min (m_dstMobility, m_srcMobility) != std::min (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::min (m_dstMobility, m_srcMobility) < std::min (other.m_dstMobility, other.m_srcMobility);
-        }
-      if (std::max (m_dstMobility, m_srcMobility) != std::max (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::max (m_dstMobility, m_srcMobility) < std::max (other.m_dstMobility, other.m_srcMobility);
-        }
-      return false;
+      return m_spectrumModelUid == other.m_spectrumModelUid
+             && m_firstMobility == other.m_firstMobility
+             && m_secondMobility == other.m_secondMobility;
     }
   };
 
-  /// Typedef: PropagationPathIdentifier, Ptr<T>
-  typedef std::map<PropagationPathIdentifier, Ptr<T> > PathCache;
-private:
+  /// Hash function of PropagationPathIdentifier
+  struct PropagationPathIdentifierHash
+  {
+    /**
+     * \param key the path
+     * \returns the hash of the path
+     */
+    std::size_t operator () (const PropagationPathIdentifier & key) const
+    {
+      std::size_t h = std::hash<const MobilityModel *> () (PeekPointer (key.m_firstMobility));
+      h ^= std::hash<const MobilityModel *> () (PeekPointer (key.m_secondMobility)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      h ^= std::hash<uint32_t> () (key.m_spectrumModelUid) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+
+  /// Typedef: list of the paths, from the most to the least recently used
+  typedef std::list<PropagationPathIdentifier> LruList;
+
+  /// The model of a path, and the information used to evict it
+  struct PathData
+  {
+    Ptr<T> m_data; //!< the model
+    Time m_lastUse; //!< the time of the last use of the path
+    bool m_tracksCourses; //!< whether the path follows the course changes of its mobility models
+    uint32_t m_firstCourse; //!< the course of the 1st mobility model when the path was added
+    uint32_t m_secondCourse; //!< the course of the 2nd mobility model when the path was added
+    typename LruList::iterator m_lruIterator; //!< the position of the path in m_lru
+  };
+
+  /// Typedef: PropagationPathIdentifier, PathData
+  typedef std::unordered_map<PropagationPathIdentifier, PathData, PropagationPathIdentifierHash> PathCache;
+  /// The course changes of a mobility model
+  struct Course
+  {
+    uint32_t m_changes; //!< the number of course changes
+    uint32_t m_paths; //!< the number of cached paths which follow them
+  };
+  /// Typedef: mobility model, course changes
+  typedef std::map<Ptr<const MobilityModel>, Course> CourseMap;
+
+  /**
+   * Remove a path from the cache
+   * \param it the path
+   */
+  void Evict (typename PathCache::iterator it)
+  {
+    if (it->second.m_tracksCourses)
+      {
+        ReleaseCourse (it->first.m_firstMobility);
+        ReleaseCourse (it->first.m_secondMobility);
+      }
+    m_lru.erase (it->second.m_lruIterator);
+    m_pathCache.erase (it);
+    m_evictions++;
+  };
+
+  /**
+   * Remove the paths which were not used for longer than m_maxAge
+   */
+  void EvictAged ()
+  {
+    if (m_maxAge.IsStrictlyPositive ())
+      {
+        Time oldest = Simulator::Now () - m_maxAge;
+        while (!m_lru.empty ())
+          {
+            typename PathCache::iterator it = m_pathCache.find (m_lru.back ());
+            if (it->second.m_lastUse >= oldest)
+              {
+                break;
+              }
+            Evict (it);
+          }
+      }
+  };
+
+  /**
+   * Get the number of course changes of a mobility model followed by
+   * a cached path.
+   * \param mobility the mobility model
+   * \return the number of course changes
+   */
+  uint32_t GetCourse (Ptr<const MobilityModel> mobility) const
+  {
+    typename CourseMap::const_iterator it = m_courses.find (mobility);
+    NS_ASSERT (it != m_courses.end ());
+    return it->second.m_changes;
+  };
+
+  /**
+   * Follow the course changes of a mobility model for a new path, and
+   * start counting them if the model is new.
+   * \param mobility the mobility model
+   * \return the number of course changes
+   */
+  uint32_t AcquireCourse (Ptr<const MobilityModel> mobility)
+  {
+    typename CourseMap::iterator it = m_courses.find (mobility);
+    if (it == m_courses.end ())
+      {
+        ConstCast<MobilityModel> (mobility)->TraceConnectWithoutContext ("CourseChange", MakeCallback (&PropagationCache<T>::NotifyCourseChange, this));
+        Course course;
+        course.m_changes = 0;
+        course.m_paths = 0;
+        it = m_courses.insert (std::make_pair (mobility, course)).first;
+      }
+    it->second.m_paths++;
+    return it->second.m_changes;
+  };
+
+  /**
+   * Stop following the course changes of a mobility model for an
+   * evicted path, and forget the model if no path follows them.
+   * \param mobility the mobility model
+   */
+  void ReleaseCourse (Ptr<const MobilityModel> mobility)
+  {
+    typename CourseMap::iterator it = m_courses.find (mobility);
+    NS_ASSERT (it != m_courses.end () && it->second.m_paths > 0);
+    if (--it->second.m_paths == 0)
+      {
+        ConstCast<MobilityModel> (mobility)->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&PropagationCache<T>::NotifyCourseChange, this));
+        m_courses.erase (it);
+      }
+  };
+
+  /**
+   * Count a course change of a mobility model.
+   * \param mobility the mobility model
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility)
+  {
+    typename CourseMap::iterator it = m_courses.find (mobility);
+    if (it != m_courses.end ())
+      {
+        it->second.m_changes++;
+      }
+  };
+
   PathCache m_pathCache; //!< Path cache
+  LruList m_lru; //!< the paths, from the most to the least recently used
+  CourseMap m_courses; //!< the course changes of the mobility models of the paths
+  uint32_t m_capacity; //!< the maximum number of paths, or 0
+  Time m_maxAge; //!< the maximum time since the last use of a path, or 0
+  bool m_invalidateOnCourseChange; //!< whether the paths are forgotten on course changes
+  uint64_t m_hits; //!< the number of hits
+  uint64_t m_misses; //!< the number of misses
+  uint64_t m_evictions; //!< the number of evictions
 };
 } // namespace ns3
 
@@ -0,0 +1,222 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/object.h>
+#include <ns3/propagation-cache.h>
+#include <ns3/constant-position-mobility-model.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PropagationCacheTest");
+
+/**
+ * Check the lookups, the LRU eviction on capacity, the age-based
+ * eviction and the invalidation on course change of PropagationCache.
+ */
+class PropagationCacheTestCase : public TestCase
+{
+public:
+  PropagationCacheTestCase ();
+  virtual ~PropagationCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Check the lookups of symmetrical paths
+  void TestLookup (void);
+  /// Check the eviction of the least recently used path
+  void TestCapacity (void);
+  /// Check the eviction of the unused paths
+  void TestMaxAge (void);
+  /// Check the invalidation of the paths on course changes
+  void TestCourseChange (void);
+  /// Check that the mobility models of the evicted paths are released
+  void TestCourseRelease (void);
+
+  /**
+   * Check whether a path is cached in m_agedCache
+   * \param cached whether the path should be cached
+   */
+  void CheckAged (bool cached);
+
+  Ptr<MobilityModel> m_a; //!< 1st mobility model
+  Ptr<MobilityModel> m_b; //!< 2nd mobility model
+  Ptr<MobilityModel> m_c; //!< 3rd mobility model
+  PropagationCache<Object> *m_agedCache; //!< the cache of TestMaxAge
+};
+
+PropagationCacheTestCase::PropagationCacheTestCase ()
+  : TestCase ("Check the PropagationCache"),
+    m_agedCache (0)
+{
+}
+
+PropagationCacheTestCase::~PropagationCacheTestCase ()
+{
+}
+
+void
+PropagationCacheTestCase::TestLookup (void)
+{
+  PropagationCache<Object> cache;
+  Ptr<Object> ab = CreateObject<Object> ();
+  Ptr<Object> ab1 = CreateObject<Object> ();
+  cache.AddPathData (ab, m_a, m_b, 0);
+  cache.AddPathData (ab1, m_a, m_b, 1);
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 0), ab, "Path a-b not found");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_b, m_a, 0), ab, "Path b-a should be path a-b");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_b, m_a, 1), ab1, "Path a-b of model 1 not found");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_c, 0), 0, "Path a-c should not be found");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 2), 0, "Path a-b of model 2 should not be found");
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 2, "Wrong number of paths");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetHits (), 3, "Wrong number of hits");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetMisses (), 2, "Wrong number of misses");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 0, "Wrong number of evictions");
+}
+
+void
+PropagationCacheTestCase::TestCapacity (void)
+{
+  PropagationCache<Object> cache;
+  cache.SetCapacity (2);
+  Ptr<Object> ab = CreateObject<Object> ();
+  Ptr<Object> ac = CreateObject<Object> ();
+  Ptr<Object> bc = CreateObject<Object> ();
+  cache.AddPathData (ab, m_a, m_b, 0);
+  cache.AddPathData (ac, m_a, m_c, 0);
+  // a-b is now more recently used than a-c
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_b, m_a, 0), ab, "Path a-b not found");
+  cache.AddPathData (bc, m_b, m_c, 0);
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 2, "The capacity should not be exceeded");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_c, 0), 0, "Path a-c should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 0), ab, "Path a-b should be kept");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_c, m_b, 0), bc, "Path b-c should be kept");
+
+  cache.SetCapacity (1);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 1, "Reducing the capacity should evict paths");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 0), 0, "Path a-b should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_c, m_b, 0), bc, "Path b-c should be kept");
+}
+
+void
+PropagationCacheTestCase::CheckAged (bool cached)
+{
+  NS_TEST_ASSERT_MSG_EQ ((m_agedCache->GetPathData (m_a, m_b, 0) != 0), cached,
+                         "Wrong state of path a-b at " << Simulator::Now ().GetSeconds () << " s");
+}
+
+void
+PropagationCacheTestCase::TestMaxAge (void)
+{
+  PropagationCache<Object> cache;
+  cache.SetMaxAge (Seconds (1));
+  cache.AddPathData (CreateObject<Object> (), m_a, m_b, 0);
+  m_agedCache = &cache;
+  // Each use of the path delays its eviction
+  Simulator::Schedule (Seconds (0.8), &PropagationCacheTestCase::CheckAged, this, true);
+  Simulator::Schedule (Seconds (1.6), &PropagationCacheTestCase::CheckAged, this, true);
+  Simulator::Schedule (Seconds (2.7), &PropagationCacheTestCase::CheckAged, this, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_agedCache = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 0, "Path a-b should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 1, "Wrong number of evictions");
+}
+
+void
+PropagationCacheTestCase::TestCourseChange (void)
+{
+  PropagationCache<Object> cache;
+  cache.SetInvalidateOnCourseChange (true);
+  Ptr<Object> ab = CreateObject<Object> ();
+  Ptr<Object> bc = CreateObject<Object> ();
+  cache.AddPathData (ab, m_a, m_b, 0);
+  cache.AddPathData (bc, m_b, m_c, 0);
+
+  m_a->SetPosition (Vector (0, 10, 0));
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 0), 0, "Path a-b should be invalidated");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_b, m_c, 0), bc, "Path b-c should be kept");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 1, "Wrong number of evictions");
+
+  cache.AddPathData (ab, m_a, m_b, 0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m_a, m_b, 0), ab, "Path a-b should be cached again");
+}
+
+void
+PropagationCacheTestCase::TestCourseRelease (void)
+{
+  uint32_t aReferences = m_a->GetReferenceCount ();
+  uint32_t bReferences = m_b->GetReferenceCount ();
+  PropagationCache<Object> cache;
+  cache.SetInvalidateOnCourseChange (true);
+  cache.SetCapacity (1);
+  cache.AddPathData (CreateObject<Object> (), m_a, m_b, 0);
+  cache.AddPathData (CreateObject<Object> (), m_b, m_c, 0);
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 1, "Path a-b should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_a->GetReferenceCount (), aReferences, "Mobility model a not released");
+  NS_TEST_ASSERT_MSG_GT (m_b->GetReferenceCount (), bReferences, "Mobility model b released too early");
+
+  // A course change of a released model is ignored
+  m_a->SetPosition (Vector (0, 20, 0));
+  NS_TEST_ASSERT_MSG_EQ (m_a->GetReferenceCount (), aReferences, "Mobility model a followed again");
+  NS_TEST_ASSERT_MSG_NE (cache.GetPathData (m_b, m_c, 0), 0, "Path b-c should be kept");
+}
+
+void
+PropagationCacheTestCase::DoRun (void)
+{
+  m_a = CreateObject<ConstantPositionMobilityModel> ();
+  m_b = CreateObject<ConstantPositionMobilityModel> ();
+  m_b->SetPosition (Vector (100, 0, 0));
+  m_c = CreateObject<ConstantPositionMobilityModel> ();
+  m_c->SetPosition (Vector (0, 100, 0));
+
+  TestLookup ();
+  TestCapacity ();
+  TestMaxAge ();
+  TestCourseChange ();
+  TestCourseRelease ();
+
+  m_a = 0;
+  m_b = 0;
+  m_c = 0;
+}
+
+/**
+ * PropagationCache test suite
+ */
+class PropagationCacheTestSuite : public TestSuite
+{
+public:
+  PropagationCacheTestSuite ();
+};
+
+PropagationCacheTestSuite::PropagationCacheTestSuite ()
+  : TestSuite ("propagation-cache", UNIT)
+{
+  AddTestCase (new PropagationCacheTestCase, TestCase::QUICK);
+}
+
+static PropagationCacheTestSuite g_propagationCacheTestSuite; ///< the test suite
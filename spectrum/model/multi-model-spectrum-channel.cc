@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -82,6 +83,7 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numDevices (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -95,6 +97,12 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_linkGains.clear ();
+  for (std::map<Ptr<MobilityModel>, uint32_t>::iterator it = m_courses.begin (); it != m_courses.end (); ++it)
+    {
+      it->first->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  m_courses.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +127,27 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("CachePathLoss",
+                   "If true, the gains of the AntennaModels and the loss of "
+                   "the PropagationLossModel are computed once for each link, "
+                   "and again only when the transmitter or the receiver "
+                   "changes course. The links of moving nodes are not "
+                   "cached. Only enable it if these models depend "
+                   "on the positions of the nodes alone.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_cachePathLoss),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CacheSpectrumLoss",
+                   "If true, the gain of the SpectrumPropagationLossModel in "
+                   "each band of the receiver is computed once for each link, "
+                   "and again only when the transmitter or the receiver "
+                   "changes course. The links of moving nodes are not "
+                   "cached. Only enable it if this model depends on "
+                   "the positions of the nodes alone, and applies a gain to "
+                   "each band of the signal.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_cacheSpectrumLoss),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -216,6 +245,26 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 }
 
 
+void
+MultiModelSpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      std::set<Ptr<SpectrumPhy> >::iterator phyIt = rxInfoIterator->second.m_rxPhySet.find (phy);
+      if (phyIt != rxInfoIterator->second.m_rxPhySet.end ())
+        {
+          rxInfoIterator->second.m_rxPhySet.erase (phyIt);
+          --m_numDevices;
+          break; // there should be at most one entry
+        }
+    }
+  ClearLinkGains (phy);
+}
+
+
 TxSpectrumModelInfoMap_t::const_iterator
 MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel)
 {
@@ -267,10 +316,15 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   NS_ASSERT (txParams->txPhy);
   NS_ASSERT (txParams->psd);
-  Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy (); // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
-  m_txSigParamsTrace (txParamsTrace);
+  if (!m_txSigParamsTrace.IsEmpty ())
+    {
+      Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy (); // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
+      m_txSigParamsTrace (txParamsTrace);
+    }
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  // the gains of the links of a moving node change without a course change
+  bool txMoving = txMobility && txMobility->GetVelocity ().GetLength () != 0;
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
   NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
 
@@ -317,48 +371,67 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
               Time delay = MicroSeconds (0);
+              double pathLossDb = 0;
+              LinkGain *link = 0;
 
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
 
               if (txMobility && receiverMobility)
                 {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
+                  if ((m_cachePathLoss || m_cacheSpectrumLoss)
+                      && !txMoving && receiverMobility->GetVelocity ().GetLength () == 0)
                     {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
+                      link = &GetLinkGain (txParams->txPhy, *rxPhyIterator, txMobility, receiverMobility);
                     }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
+                  if (m_cachePathLoss && link != 0)
                     {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
+                      if (!link->pathLossValid)
+                        {
+                          link->pathLossDb = CalcPathLossDb (txParams, *rxPhyIterator, txMobility, receiverMobility);
+                          link->pathLossValid = true;
+                        }
+                      pathLossDb = link->pathLossDb;
                     }
-                  if (m_propagationLoss)
+                  else
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
+                      pathLossDb = CalcPathLossDb (txParams, *rxPhyIterator, txMobility, receiverMobility);
+                    }
+                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
                   m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
                   if ( pathLossDb > m_maxLossDb)
                     {
                       // beyond range
                       continue;
                     }
+                }
+
+              // the receivers share the packet of the signal, only the
+              // parameters and the psd are copied
+              NS_LOG_LOGIC (" copying signal parameters " << txParams);
+              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+              if (convertedTxPowerSpectrum != txParams->psd)
+                {
+                  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+                }
+
+              if (txMobility && receiverMobility)
+                {
                   double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
                   *(rxParams->psd) *= pathGainLinear;              
 
-                  if (m_spectrumPropagationLoss)
+                  if (m_spectrumPropagationLoss && m_cacheSpectrumLoss && link != 0)
+                    {
+                      if (link->spectrumGain == 0 || link->spectrumGain->GetSpectrumModelUid () != rxSpectrumModelUid)
+                        {
+                          // the gain in each band is the loss applied to a unit psd
+                          Ptr<SpectrumValue> unit = Create<SpectrumValue> (rxInfoIterator->second.m_rxSpectrumModel);
+                          (*unit) = 1.0;
+                          link->spectrumGain = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (unit, txMobility, receiverMobility);
+                        }
+                      *(rxParams->psd) *= *(link->spectrumGain);
+                    }
+                  else if (m_spectrumPropagationLoss)
                     {
                       rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
                     }
@@ -390,6 +463,111 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+double
+MultiModelSpectrumChannel::CalcPathLossDb (Ptr<const SpectrumSignalParameters> txParams, Ptr<SpectrumPhy> receiver,
+                                           Ptr<MobilityModel> txMobility, Ptr<MobilityModel> rxMobility) const
+{
+  double pathLossDb = 0;
+  if (txParams->txAntenna != 0)
+    {
+      Angles txAngles (rxMobility->GetPosition (), txMobility->GetPosition ());
+      double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      pathLossDb -= txAntennaGain;
+    }
+  Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txMobility->GetPosition (), rxMobility->GetPosition ());
+      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      pathLossDb -= rxAntennaGain;
+    }
+  if (m_propagationLoss)
+    {
+      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+      pathLossDb -= propagationGainDb;
+    }
+  return pathLossDb;
+}
+
+MultiModelSpectrumChannel::LinkGain&
+MultiModelSpectrumChannel::GetLinkGain (Ptr<SpectrumPhy> transmitter, Ptr<SpectrumPhy> receiver,
+                                        Ptr<MobilityModel> txMobility, Ptr<MobilityModel> rxMobility)
+{
+  uint32_t txCourse = GetCourse (txMobility);
+  uint32_t rxCourse = GetCourse (rxMobility);
+  LinkGain &link = m_linkGains[std::make_pair (transmitter, receiver)];
+  if (link.txMobility != txMobility || link.rxMobility != rxMobility
+      || link.txCourse != txCourse || link.rxCourse != rxCourse)
+    {
+      NS_LOG_LOGIC ("clearing the cached gains from " << transmitter << " to " << receiver);
+      link.txMobility = txMobility;
+      link.rxMobility = rxMobility;
+      link.txCourse = txCourse;
+      link.rxCourse = rxCourse;
+      link.pathLossValid = false;
+      link.spectrumGain = 0;
+    }
+  return link;
+}
+
+uint32_t
+MultiModelSpectrumChannel::GetCourse (Ptr<MobilityModel> mobility)
+{
+  std::map<Ptr<MobilityModel>, uint32_t>::iterator it = m_courses.find (mobility);
+  if (it == m_courses.end ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+      it = m_courses.insert (std::make_pair (mobility, 0)).first;
+    }
+  return it->second;
+}
+
+void
+MultiModelSpectrumChannel::ClearLinkGains (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  std::set<Ptr<MobilityModel> > used;
+  LinkGainMap::iterator it = m_linkGains.begin ();
+  while (it != m_linkGains.end ())
+    {
+      if (it->first.first == phy || it->first.second == phy)
+        {
+          m_linkGains.erase (it++);
+        }
+      else
+        {
+          used.insert (it->second.txMobility);
+          used.insert (it->second.rxMobility);
+          ++it;
+        }
+    }
+  std::map<Ptr<MobilityModel>, uint32_t>::iterator courseIt = m_courses.begin ();
+  while (courseIt != m_courses.end ())
+    {
+      if (used.find (courseIt->first) == used.end ())
+        {
+          courseIt->first->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+          m_courses.erase (courseIt++);
+        }
+      else
+        {
+          ++courseIt;
+        }
+    }
+}
+
+void
+MultiModelSpectrumChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<Ptr<MobilityModel>, uint32_t>::iterator it = m_courses.find (ConstCast<MobilityModel> (mobility));
+  NS_ASSERT (it != m_courses.end ());
+  it->second++;
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
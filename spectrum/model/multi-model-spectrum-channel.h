@@ -27,8 +27,10 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/mobility-model.h>
 #include <map>
 #include <set>
+#include <utility>
 
 namespace ns3 {
 
@@ -102,6 +104,20 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * The gains of each link can be cached, so that they are computed
+ * once for nodes which do not move instead of at every transmission:
+ * with CachePathLoss, the gains of the antennas and the loss of the
+ * PropagationLossModel; with CacheSpectrumLoss, the gain of the
+ * SpectrumPropagationLossModel in each band of the receiver. The
+ * gains of a link are computed again when the transmitter or the
+ * receiver changes course. The gains of a link are not cached while
+ * the transmitter or the receiver has a non-zero velocity, since its
+ * position then changes without a course change. Caching is only
+ * valid for models whose results depend on the positions of the nodes
+ * alone, not on the time nor on random variables, and for a
+ * SpectrumPropagationLossModel which applies a gain to each band of
+ * the signal.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -120,6 +136,7 @@ public:
   virtual void AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss);
   virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
   virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void RemoveRx (Ptr<SpectrumPhy> phy);
   virtual void StartTx (Ptr<SpectrumSignalParameters> params);
 
 
@@ -156,6 +173,78 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
+  /**
+   * The gains of a link, when they are cached.
+   */
+  struct LinkGain
+  {
+    Ptr<MobilityModel> txMobility;         //!< the mobility of the transmitter
+    Ptr<MobilityModel> rxMobility;         //!< the mobility of the receiver
+    uint32_t txCourse;                     //!< the course of the transmitter
+    uint32_t rxCourse;                     //!< the course of the receiver
+    bool pathLossValid;                    //!< whether pathLossDb was computed
+    double pathLossDb;                     //!< the loss of the antennas and the PropagationLossModel
+    Ptr<const SpectrumValue> spectrumGain; //!< the gain of the SpectrumPropagationLossModel in each RX band, or 0
+  };
+
+  /**
+   * Container: (TX SpectrumPhy, RX SpectrumPhy), LinkGain
+   */
+  typedef std::map<std::pair<Ptr<SpectrumPhy>, Ptr<SpectrumPhy> >, LinkGain> LinkGainMap;
+
+  /**
+   * Compute the loss of the antennas and of the PropagationLossModel
+   * between a transmitter and a receiver.
+   *
+   * @param txParams The parameters of the transmitted signal.
+   * @param receiver The receiver SpectrumPhy.
+   * @param txMobility The mobility of the transmitter.
+   * @param rxMobility The mobility of the receiver.
+   *
+   * @return The loss, in dB.
+   */
+  double CalcPathLossDb (Ptr<const SpectrumSignalParameters> txParams, Ptr<SpectrumPhy> receiver,
+                         Ptr<MobilityModel> txMobility, Ptr<MobilityModel> rxMobility) const;
+
+  /**
+   * Get the cached gains of a link. The gains are cleared if the
+   * transmitter or the receiver changed course since they were cached.
+   *
+   * @param transmitter The transmitter SpectrumPhy.
+   * @param receiver The receiver SpectrumPhy.
+   * @param txMobility The mobility of the transmitter.
+   * @param rxMobility The mobility of the receiver.
+   *
+   * @return The gains of the link.
+   */
+  LinkGain& GetLinkGain (Ptr<SpectrumPhy> transmitter, Ptr<SpectrumPhy> receiver,
+                         Ptr<MobilityModel> txMobility, Ptr<MobilityModel> rxMobility);
+
+  /**
+   * Get the number of course changes of a mobility model, and start
+   * counting them if the model is new.
+   *
+   * @param mobility The mobility model.
+   *
+   * @return The number of course changes.
+   */
+  uint32_t GetCourse (Ptr<MobilityModel> mobility);
+
+  /**
+   * Count a course change of a mobility model.
+   *
+   * @param mobility The mobility model.
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+
+  /**
+   * Forget the cached gains of the links of a SpectrumPhy, and stop
+   * counting the course changes of the mobility models no link uses.
+   *
+   * @param phy The SpectrumPhy.
+   */
+  void ClearLinkGains (Ptr<SpectrumPhy> phy);
+
   /**
    * Used internally to reschedule transmission after the propagation delay.
    *
@@ -207,6 +296,27 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Whether the losses of the antennas and of the PropagationLossModel
+   * are cached.
+   */
+  bool m_cachePathLoss;
+
+  /**
+   * Whether the gains of the SpectrumPropagationLossModel are cached.
+   */
+  bool m_cacheSpectrumLoss;
+
+  /**
+   * The cached gains of each link.
+   */
+  LinkGainMap m_linkGains;
+
+  /**
+   * The number of course changes of each mobility model of the cached links.
+   */
+  std::map<Ptr<MobilityModel>, uint32_t> m_courses;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -37,6 +37,8 @@
 
 #include "single-model-spectrum-channel.h"
 
+#include <algorithm>
+
 
 namespace ns3 {
 
@@ -109,6 +111,17 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   m_phyList.push_back (phy);
 }
 
+void
+SingleModelSpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  PhyList::iterator it = std::find (m_phyList.begin (), m_phyList.end (), phy);
+  if (it != m_phyList.end ())
+    {
+      m_phyList.erase (it);
+    }
+}
+
 
 void
 SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
@@ -142,17 +155,15 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         {
           Time delay  = MicroSeconds (0);
 
+          double pathLossDb = 0;
           Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-          NS_LOG_LOGIC ("copying signal parameters " << txParams);
-          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
 
           if (senderMobility && receiverMobility)
             {
-              double pathLossDb = 0;
-              if (rxParams->txAntenna != 0)
+              if (txParams->txAntenna != 0)
                 {
                   Angles txAngles (receiverMobility->GetPosition (), senderMobility->GetPosition ());
-                  double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+                  double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
                   NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                   pathLossDb -= txAntennaGain;
                 }
@@ -177,6 +188,15 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   // beyond range
                   continue;
                 }
+            }
+
+          // the receivers share the packet of the signal, only the
+          // parameters and the psd are copied
+          NS_LOG_LOGIC ("copying signal parameters " << txParams);
+          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+
+          if (senderMobility && receiverMobility)
+            {
               double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
               *(rxParams->psd) *= pathGainLinear;              
 
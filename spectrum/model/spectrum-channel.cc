@@ -19,6 +19,7 @@
  */
 
 #include "spectrum-channel.h"
+#include <ns3/fatal-error.h>
 
 
 namespace ns3 {
@@ -40,4 +41,10 @@ SpectrumChannel::~SpectrumChannel ()
 {
 }
 
+void
+SpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_FATAL_ERROR ("SpectrumChannel::RemoveRx is not supported by " << GetInstanceTypeId ().GetName ());
+}
+
 } // namespace
@@ -99,6 +99,22 @@ public:
    */
   virtual void AddRx (Ptr<SpectrumPhy> phy) = 0;
 
+  /**
+   * @brief Remove a SpectrumPhy from a channel
+   *
+   * This method is used to detach a SpectrumPhy instance from a
+   * SpectrumChannel instance, so that the SpectrumPhy does not receive
+   * packets sent on that channel any more.
+   *
+   * The default implementation is a fatal error: the classes inheriting
+   * from SpectrumChannel which support detaching a SpectrumPhy override
+   * it.
+   *
+   * @param phy the SpectrumPhy instance to be removed from the channel
+   * as a receiver.
+   */
+  virtual void RemoveRx (Ptr<SpectrumPhy> phy);
+
   /**
    * TracedCallback signature for path loss calculation events.
    *
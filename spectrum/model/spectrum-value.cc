@@ -22,6 +22,7 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -106,17 +107,15 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -124,12 +123,11 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,17 +136,15 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -164,17 +160,15 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -182,12 +176,11 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,17 +190,15 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -216,12 +207,11 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] /= s;
     }
 }
 
@@ -231,12 +221,11 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -344,31 +333,51 @@ SpectrumValue::Log ()
     }
 }
 
+// The sums below are split into four partial sums, so that the
+// additions do not wait for each other and can be vectorized: the
+// result may differ from a sequential sum in the last bits.
+
 double
 Norm (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  size_t n = x.m_values.size ();
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      s0 += v[i] * v[i];
+      s1 += v[i + 1] * v[i + 1];
+      s2 += v[i + 2] * v[i + 2];
+      s3 += v[i + 3] * v[i + 3];
     }
-  return std::sqrt (s);
+  for (; i < n; i++)
+    {
+      s0 += v[i] * v[i];
+    }
+  return std::sqrt ((s0 + s1) + (s2 + s3));
 }
 
 
 double
 Sum (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  size_t n = x.m_values.size ();
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
     {
-      s += (*it1);
-      ++it1;
+      s0 += v[i];
+      s1 += v[i + 1];
+      s2 += v[i + 2];
+      s3 += v[i + 3];
     }
-  return s;
+  for (; i < n; i++)
+    {
+      s0 += v[i];
+    }
+  return (s0 + s1) + (s2 + s3);
 }
 
 
@@ -389,18 +398,24 @@ Prod (const SpectrumValue& x)
 double
 Integral (const SpectrumValue& arg)
 {
-  double i = 0;
-  Values::const_iterator vit = arg.ConstValuesBegin ();
-  Bands::const_iterator bit = arg.ConstBandsBegin ();
-  while (vit != arg.ConstValuesEnd ())
+  NS_ASSERT (arg.m_values.size () == arg.m_spectrumModel->GetNumBands ());
+  const double *v = arg.m_values.data ();
+  Bands::const_iterator b = arg.ConstBandsBegin ();
+  size_t n = arg.m_values.size ();
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    {
+      s0 += v[i] * (b[i].fh - b[i].fl);
+      s1 += v[i + 1] * (b[i + 1].fh - b[i + 1].fl);
+      s2 += v[i + 2] * (b[i + 2].fh - b[i + 2].fl);
+      s3 += v[i + 3] * (b[i + 3].fh - b[i + 3].fl);
+    }
+  for (; i < n; i++)
     {
-      NS_ASSERT (bit != arg.ConstBandsEnd ());
-      i += (*vit) * (bit->fh - bit->fl);
-      ++vit;
-      ++bit;
+      s0 += v[i] * (b[i].fh - b[i].fl);
     }
-  NS_ASSERT (bit == arg.ConstBandsEnd ());
-  return i;
+  return (s0 + s1) + (s2 + s3);
 }
 
 
@@ -467,9 +482,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -664,13 +678,7 @@ SpectrumValue::operator/= (double rhs)
 SpectrumValue&
 SpectrumValue::operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/object.h>
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/friis-spectrum-propagation-loss.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MultiModelSpectrumChannelTest");
+
+/**
+ * A PropagationLossModel which counts its calls, to be chained
+ * before the actual loss model.
+ */
+class CallCountingPropagationLossModel : public PropagationLossModel
+{
+public:
+  CallCountingPropagationLossModel ();
+  uint32_t m_calls; ///< the number of calls
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+};
+
+CallCountingPropagationLossModel::CallCountingPropagationLossModel ()
+  : m_calls (0)
+{
+}
+
+double
+CallCountingPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  const_cast<CallCountingPropagationLossModel *> (this)->m_calls++;
+  return txPowerDbm;
+}
+
+int64_t
+CallCountingPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+/**
+ * A FriisSpectrumPropagationLossModel which counts its calls.
+ */
+class CallCountingSpectrumPropagationLossModel : public FriisSpectrumPropagationLossModel
+{
+public:
+  CallCountingSpectrumPropagationLossModel ();
+  virtual Ptr<SpectrumValue> DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
+                                                           Ptr<const MobilityModel> a,
+                                                           Ptr<const MobilityModel> b) const;
+  uint32_t m_calls; ///< the number of calls
+};
+
+CallCountingSpectrumPropagationLossModel::CallCountingSpectrumPropagationLossModel ()
+  : m_calls (0)
+{
+}
+
+Ptr<SpectrumValue>
+CallCountingSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
+                                                                    Ptr<const MobilityModel> a,
+                                                                    Ptr<const MobilityModel> b) const
+{
+  const_cast<CallCountingSpectrumPropagationLossModel *> (this)->m_calls++;
+  return FriisSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (txPsd, a, b);
+}
+
+/**
+ * A SpectrumPhy which records the signals it receives.
+ */
+class RecordingSpectrumPhy : public SpectrumPhy
+{
+public:
+  /**
+   * \param model the spectrum model of the receiver
+   */
+  RecordingSpectrumPhy (Ptr<const SpectrumModel> model);
+
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  std::vector<Ptr<SpectrumValue> > m_received; ///< the psd of the received signals
+
+private:
+  Ptr<const SpectrumModel> m_model; ///< the spectrum model of the receiver
+  Ptr<MobilityModel> m_mobility;    ///< the mobility of the receiver
+};
+
+RecordingSpectrumPhy::RecordingSpectrumPhy (Ptr<const SpectrumModel> model)
+  : m_model (model)
+{
+}
+
+void
+RecordingSpectrumPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+RecordingSpectrumPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+RecordingSpectrumPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+RecordingSpectrumPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+RecordingSpectrumPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+RecordingSpectrumPhy::GetRxSpectrumModel () const
+{
+  return m_model;
+}
+
+Ptr<AntennaModel>
+RecordingSpectrumPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+RecordingSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_received.push_back (params->psd);
+}
+
+/**
+ * Check that caching the gains of the links of a
+ * MultiModelSpectrumChannel leaves the received signals unchanged,
+ * computes the losses once for each link, computes them again when a
+ * node changes course, and does not cache the links of moving nodes.
+ */
+class MultiModelSpectrumChannelCacheTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumChannelCacheTestCase ();
+  virtual ~MultiModelSpectrumChannelCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Transmit signals and record the signals received.
+   *
+   * \param cache whether the gains of the links are cached
+   * \param moving whether the last receiver moves at a constant velocity
+   * \param received the psd of the received signals, for each receiver
+   * \param pathLossCalls the number of calls of the PropagationLossModel
+   * \param spectrumLossCalls the number of calls of the SpectrumPropagationLossModel
+   */
+  void RunScenario (bool cache, bool moving, std::vector<std::vector<Ptr<SpectrumValue> > > &received,
+                    uint32_t &pathLossCalls, uint32_t &spectrumLossCalls);
+  /**
+   * Compare the signals received with and without cache.
+   *
+   * \param received the psd of the received signals with cache
+   * \param expected the psd of the received signals without cache
+   */
+  void CheckReceived (const std::vector<std::vector<Ptr<SpectrumValue> > > &received,
+                      const std::vector<std::vector<Ptr<SpectrumValue> > > &expected);
+};
+
+MultiModelSpectrumChannelCacheTestCase::MultiModelSpectrumChannelCacheTestCase ()
+  : TestCase ("Check the cache of the link gains of MultiModelSpectrumChannel")
+{
+}
+
+MultiModelSpectrumChannelCacheTestCase::~MultiModelSpectrumChannelCacheTestCase ()
+{
+}
+
+void
+MultiModelSpectrumChannelCacheTestCase::RunScenario (bool cache, bool moving, std::vector<std::vector<Ptr<SpectrumValue> > > &received,
+                                                     uint32_t &pathLossCalls, uint32_t &spectrumLossCalls)
+{
+  std::vector<double> txFreqs;
+  std::vector<double> rxFreqs;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      txFreqs.push_back (2.4e9 + 1e6 * i);
+      rxFreqs.push_back (2.4e9 + 2e6 * i);
+    }
+  Ptr<SpectrumModel> txModel = Create<SpectrumModel> (txFreqs);
+  // The last receiver uses another model, its signals are converted
+  Ptr<SpectrumModel> rxModel = Create<SpectrumModel> (rxFreqs);
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->SetAttribute ("CachePathLoss", BooleanValue (cache));
+  channel->SetAttribute ("CacheSpectrumLoss", BooleanValue (cache));
+  Ptr<CallCountingPropagationLossModel> pathLoss = CreateObject<CallCountingPropagationLossModel> ();
+  pathLoss->SetNext (CreateObject<LogDistancePropagationLossModel> ());
+  channel->AddPropagationLossModel (pathLoss);
+  Ptr<CallCountingSpectrumPropagationLossModel> spectrumLoss = CreateObject<CallCountingSpectrumPropagationLossModel> ();
+  channel->AddSpectrumPropagationLossModel (spectrumLoss);
+
+  std::vector<Ptr<RecordingSpectrumPhy> > phys;
+  std::vector<Ptr<MobilityModel> > mobilities;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<RecordingSpectrumPhy> phy = CreateObject<RecordingSpectrumPhy> (i < 3 ? txModel : rxModel);
+      Ptr<MobilityModel> mobility;
+      if (moving && i == 3)
+        {
+          Ptr<ConstantVelocityMobilityModel> velocity = CreateObject<ConstantVelocityMobilityModel> ();
+          velocity->SetPosition (Vector (10.0 * i, 5.0 * i * i, 0.0));
+          velocity->SetVelocity (Vector (100.0, 0.0, 0.0));
+          mobility = velocity;
+        }
+      else
+        {
+          mobility = CreateObject<ConstantPositionMobilityModel> ();
+          mobility->SetPosition (Vector (10.0 * i, 5.0 * i * i, 0.0));
+        }
+      phy->SetMobility (mobility);
+      channel->AddRx (phy);
+      phys.push_back (phy);
+      mobilities.push_back (mobility);
+    }
+
+  // Each phy transmits in turn, a receiver moves in the middle
+  for (uint32_t t = 0; t < 12; t++)
+    {
+      Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+      params->txPhy = phys[t % 3];
+      params->duration = MilliSeconds (1);
+      params->psd = Create<SpectrumValue> (txModel);
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          (*params->psd)[i] = 1e-9 * (1 + t + i);
+        }
+      Simulator::Schedule (MilliSeconds (10 * t + 10), &MultiModelSpectrumChannel::StartTx, channel, params);
+    }
+  Simulator::Schedule (MilliSeconds (65), &MobilityModel::SetPosition, mobilities[1], Vector (-30.0, 20.0, 0.0));
+  // The last receiver leaves the channel before the last 3 signals
+  Simulator::Schedule (MilliSeconds (95), &MultiModelSpectrumChannel::RemoveRx, channel, phys[3]);
+
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (channel->GetNDevices (), 3, "The receiver should be removed");
+  Simulator::Destroy ();
+
+  received.clear ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      received.push_back (phys[i]->m_received);
+    }
+  pathLossCalls = pathLoss->m_calls;
+  spectrumLossCalls = spectrumLoss->m_calls;
+}
+
+void
+MultiModelSpectrumChannelCacheTestCase::CheckReceived (const std::vector<std::vector<Ptr<SpectrumValue> > > &received,
+                                                       const std::vector<std::vector<Ptr<SpectrumValue> > > &expected)
+{
+  NS_TEST_ASSERT_MSG_EQ (received.size (), expected.size (), "Wrong number of receivers");
+  for (uint32_t i = 0; i < received.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (received[i].size (), expected[i].size (), "Wrong number of signals for receiver " << i);
+      for (uint32_t j = 0; j < received[i].size () && j < expected[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (received[i][j]->GetSpectrumModel ()->GetNumBands (), expected[i][j]->GetSpectrumModel ()->GetNumBands (),
+                                 "Wrong spectrum model for signal " << j << " of receiver " << i);
+          for (uint32_t k = 0; k < expected[i][j]->GetSpectrumModel ()->GetNumBands (); k++)
+            {
+              double value = (*expected[i][j])[k];
+              NS_TEST_ASSERT_MSG_EQ_TOL ((*received[i][j])[k], value, value * 1e-12,
+                                         "Wrong psd in band " << k << " of signal " << j << " of receiver " << i);
+            }
+        }
+    }
+}
+
+void
+MultiModelSpectrumChannelCacheTestCase::DoRun (void)
+{
+  std::vector<std::vector<Ptr<SpectrumValue> > > expected;
+  uint32_t pathLossCalls;
+  uint32_t spectrumLossCalls;
+  RunScenario (false, false, expected, pathLossCalls, spectrumLossCalls);
+  NS_TEST_ASSERT_MSG_EQ (expected[3].size (), 9, "The removed receiver should not receive the last signals");
+  NS_TEST_ASSERT_MSG_EQ (pathLossCalls, 12 * 3 - 3, "The path loss should be computed for each signal and receiver");
+  NS_TEST_ASSERT_MSG_EQ (spectrumLossCalls, 12 * 3 - 3, "The spectrum loss should be computed for each signal and receiver");
+
+  std::vector<std::vector<Ptr<SpectrumValue> > > received;
+  RunScenario (true, false, received, pathLossCalls, spectrumLossCalls);
+  // 9 links, and the 5 links of the receiver which moved again: the
+  // transmissions after the move are from phys 0 and 2 to phy 1, and
+  // from phy 1 to phys 0, 2 and 3
+  NS_TEST_ASSERT_MSG_EQ (pathLossCalls, 9 + 5, "The path loss should be computed once for each link and course");
+  NS_TEST_ASSERT_MSG_EQ (spectrumLossCalls, 9 + 5, "The spectrum loss should be computed once for each link and course");
+  CheckReceived (received, expected);
+
+  // The last receiver moves without changing course
+  RunScenario (false, true, expected, pathLossCalls, spectrumLossCalls);
+  NS_TEST_ASSERT_MSG_EQ (pathLossCalls, 12 * 3 - 3, "The path loss should be computed for each signal and receiver");
+  RunScenario (true, true, received, pathLossCalls, spectrumLossCalls);
+  // the 6 links between the static phys and the 4 links of the one
+  // which moved again, as above, and each of the 9 signals received by
+  // the moving phy
+  NS_TEST_ASSERT_MSG_EQ (pathLossCalls, 6 + 4 + 9, "The path loss of a moving node should not be cached");
+  NS_TEST_ASSERT_MSG_EQ (spectrumLossCalls, 6 + 4 + 9, "The spectrum loss of a moving node should not be cached");
+  CheckReceived (received, expected);
+}
+
+/**
+ * Test suite of MultiModelSpectrumChannel
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumChannelCacheTestCase, TestCase::QUICK);
+}
+
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite; ///< the test suite
@@ -24,7 +24,9 @@
 #include <ns3/log.h>
 #include <ns3/test.h>
 #include <iostream>
+#include <sstream>
 #include <cmath>
+#include <ctime>
 
 #include "spectrum-test.h"
 
@@ -82,6 +84,78 @@ SpectrumValueTestCase::DoRun (void)
 
 
 
+/**
+ * Check the element-wise operations and the reductions of
+ * SpectrumValue against plain loops, with a number of bands which is
+ * not a multiple of the width of the kernels.
+ */
+class SpectrumValueKernelTestCase : public TestCase
+{
+public:
+  SpectrumValueKernelTestCase ();
+  virtual ~SpectrumValueKernelTestCase ();
+  virtual void DoRun (void);
+};
+
+SpectrumValueKernelTestCase::SpectrumValueKernelTestCase ()
+  : TestCase ("element-wise operations and reductions over 1003 bands")
+{
+}
+
+SpectrumValueKernelTestCase::~SpectrumValueKernelTestCase ()
+{
+}
+
+void
+SpectrumValueKernelTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  for (int i = 0; i < 1003; i++)
+    {
+      freqs.push_back (1e9 + 1e5 * i * (1 + i % 3));
+    }
+  Ptr<SpectrumModel> f = Create<SpectrumModel> (freqs);
+
+  SpectrumValue a (f), b (f);
+  for (int i = 0; i < 1003; i++)
+    {
+      a[i] = 1e-13 * (1 + (i * 7919) % 101);
+      b[i] = 2e-13 * (1 + (i * 104729) % 37);
+    }
+
+  SpectrumValue sum = a + b;
+  SpectrumValue difference = a - b;
+  SpectrumValue product = a * b;
+  SpectrumValue quotient = a / b;
+  SpectrumValue scaled = a * 3.5;
+  SpectrumValue logarithm = Log10 (a);
+  SpectrumValue accumulated = a;
+  accumulated += b;
+  accumulated -= a;
+  double expectedSum = 0;
+  double expectedNorm = 0;
+  double expectedIntegral = 0;
+  Bands::const_iterator band = f->Begin ();
+  for (int i = 0; i < 1003; i++, band++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sum[i], a[i] + b[i], "wrong sum in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (difference[i], a[i] - b[i], "wrong difference in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (product[i], a[i] * b[i], "wrong product in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (quotient[i], a[i] / b[i], "wrong quotient in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (scaled[i], a[i] * 3.5, "wrong scaling in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (logarithm[i], std::log10 (a[i]), "wrong logarithm in band " << i);
+      NS_TEST_ASSERT_MSG_EQ (accumulated[i], (a[i] + b[i]) - a[i], "wrong accumulation in band " << i);
+      expectedSum += a[i];
+      expectedNorm += a[i] * a[i];
+      expectedIntegral += a[i] * (band->fh - band->fl);
+    }
+  expectedNorm = std::sqrt (expectedNorm);
+  NS_TEST_ASSERT_MSG_EQ_TOL (Sum (a), expectedSum, expectedSum * 1e-12, "wrong Sum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Norm (a), expectedNorm, expectedNorm * 1e-12, "wrong Norm");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Integral (a), expectedIntegral, expectedIntegral * 1e-12, "wrong Integral");
+}
+
+
 class SpectrumValueTestSuite : public TestSuite
 {
 public:
@@ -241,6 +315,8 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   tv1rs3 = v1 >> 3;
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
+  AddTestCase (new SpectrumValueKernelTestCase, TestCase::QUICK);
+
 
 }
 
@@ -336,6 +412,156 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 
 
 
+/**
+ * Measure the time taken by the operations of SpectrumValue, with
+ * spectrum models of 50 to 1000 bands.
+ */
+class SpectrumValueTimeTestCase : public TestCase
+{
+public:
+  SpectrumValueTimeTestCase ();
+  virtual ~SpectrumValueTimeTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Print the time taken by an operation.
+   *
+   * \param what the operation
+   * \param ticks the clock ticks taken by all the iterations
+   * \param iterations the number of iterations
+   */
+  void Report (std::string what, std::clock_t ticks, uint32_t iterations) const;
+
+  enum { ELEMENTS = 50000000 }; ///< the number of bands processed by each measure
+};
+
+SpectrumValueTimeTestCase::SpectrumValueTimeTestCase ()
+  : TestCase ("Time the operations of SpectrumValue")
+{
+}
+
+SpectrumValueTimeTestCase::~SpectrumValueTimeTestCase ()
+{
+}
+
+void
+SpectrumValueTimeTestCase::Report (std::string what, std::clock_t ticks, uint32_t iterations) const
+{
+  double per = 1E9 * double (ticks) / (double (iterations) * CLOCKS_PER_SEC);
+  std::cout << "  " << what << ": " << per << " ns" << std::endl;
+}
+
+void
+SpectrumValueTimeTestCase::DoRun (void)
+{
+  uint32_t sizes[] = { 50, 100, 500, 1000 };
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+    {
+      uint32_t bands = sizes[s];
+      uint32_t iterations = ELEMENTS / bands;
+      std::vector<double> freqs;
+      for (uint32_t i = 0; i < bands; i++)
+        {
+          freqs.push_back (2.4e9 + 312.5e3 * i);
+        }
+      Ptr<SpectrumModel> f = Create<SpectrumModel> (freqs);
+      SpectrumValue a (f), b (f), c (f);
+      for (uint32_t i = 0; i < bands; i++)
+        {
+          a[i] = 1e-12 * (1 + i % 7);
+          b[i] = 1e-15 * (1 + i % 5);
+        }
+      std::cout << bands << " bands:" << std::endl;
+      double check = 0;
+
+      std::clock_t start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          c += b;
+        }
+      Report ("c += b", std::clock () - start, iterations);
+      check += c[0];
+
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          c *= 0.999999;
+        }
+      Report ("c *= s", std::clock () - start, iterations);
+      check += c[0];
+
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          c = a - b;
+        }
+      Report ("c = a - b", std::clock () - start, iterations);
+      check += c[0];
+
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          c = a * b;
+        }
+      Report ("c = a * b", std::clock () - start, iterations);
+      check += c[0];
+
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          c = a / b;
+        }
+      Report ("c = a / b", std::clock () - start, iterations);
+      check += c[0];
+
+      double total = 0;
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          total += Sum (a);
+        }
+      Report ("Sum (a)", std::clock () - start, iterations);
+      check += total;
+
+      total = 0;
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations; i++)
+        {
+          total += Integral (a);
+        }
+      Report ("Integral (a)", std::clock () - start, iterations);
+      check += total;
+
+      start = std::clock ();
+      for (uint32_t i = 0; i < iterations / 10; i++)
+        {
+          c = Log10 (a);
+        }
+      Report ("c = Log10 (a)", std::clock () - start, iterations / 10);
+      check += c[0];
+
+      NS_TEST_ASSERT_MSG_GT (check, 0, "Unexpected results");
+    }
+}
+
+/**
+ * Performance test suite of SpectrumValue
+ */
+class SpectrumValuePerfTestSuite : public TestSuite
+{
+public:
+  SpectrumValuePerfTestSuite ();
+};
+
+SpectrumValuePerfTestSuite::SpectrumValuePerfTestSuite ()
+  : TestSuite ("spectrum-value-perf", PERFORMANCE)
+{
+  AddTestCase (new SpectrumValueTimeTestCase, TestCase::QUICK);
+}
+
+
 // static instance of test suites
 static SpectrumValueTestSuite g_SpectrumValueTestSuite;
 static SpectrumConverterTestSuite g_SpectrumConverterTestSuite;
+static SpectrumValuePerfTestSuite g_SpectrumValuePerfTestSuite;
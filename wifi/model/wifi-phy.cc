@@ -2420,10 +2420,10 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
 }
 
 void
-WifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet, double rxPowerW, Time rxDuration)
+WifiPhy::StartReceivePreambleAndHeader (Ptr<const Packet> packet, double rxPowerW, Time rxDuration)
 {
   WifiPhyTag tag;
-  bool found = packet->RemovePacketTag (tag);
+  bool found = packet->PeekPacketTag (tag);
   if (!found)
     {
       NS_FATAL_ERROR ("Received Wi-Fi Signal with no WifiPhyTag");
@@ -2565,7 +2565,7 @@ WifiPhy::MaybeCcaBusyDuration ()
 }
 
 void
-WifiPhy::StartReceivePacket (Ptr<Packet> packet,
+WifiPhy::StartReceivePacket (Ptr<const Packet> packet,
                              WifiTxVector txVector,
                              MpduType mpdutype,
                              Ptr<InterferenceHelper::Event> event)
@@ -2603,12 +2603,18 @@ WifiPhy::StartReceivePacket (Ptr<Packet> packet,
 }
 
 void
-WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event)
+WifiPhy::EndReceive (Ptr<const Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event)
 {
   NS_LOG_FUNCTION (this << packet << event);
   NS_ASSERT (IsStateRx ());
   NS_ASSERT (event->GetEndTime () == Simulator::Now ());
 
+  //the arriving packet is shared with the other receivers of the signal:
+  //pass up a copy of our own, without the WifiPhyTag
+  Ptr<Packet> rxPacket = packet->Copy ();
+  WifiPhyTag tag;
+  rxPacket->RemovePacketTag (tag);
+
   InterferenceHelper::SnrPer snrPer;
   snrPer = m_interference.CalculatePlcpPayloadSnrPer (event);
   m_interference.NotifyRxEnd ();
@@ -2617,30 +2623,30 @@ WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutyp
   if (m_plcpSuccess == true)
     {
       NS_LOG_DEBUG ("mode=" << (event->GetPayloadMode ().GetDataRate (event->GetTxVector ())) <<
-                    ", snr(dB)=" << RatioToDb (snrPer.snr) << ", per=" << snrPer.per << ", size=" << packet->GetSize ());
+                    ", snr(dB)=" << RatioToDb (snrPer.snr) << ", per=" << snrPer.per << ", size=" << rxPacket->GetSize ());
 
       if (m_random->GetValue () > snrPer.per)
         {
-          NotifyRxEnd (packet);
+          NotifyRxEnd (rxPacket);
           SignalNoiseDbm signalNoise;
           signalNoise.signal = RatioToDb (event->GetRxPowerW ()) + 30;
           signalNoise.noise = RatioToDb (event->GetRxPowerW () / snrPer.snr) + 30;
           MpduInfo aMpdu;
           aMpdu.type = mpdutype;
           aMpdu.mpduRefNumber = m_rxMpduReferenceNumber;
-          NotifyMonitorSniffRx (packet, GetFrequency (), event->GetTxVector (), aMpdu, signalNoise);
-          m_state->SwitchFromRxEndOk (packet, snrPer.snr, event->GetTxVector ());
+          NotifyMonitorSniffRx (rxPacket, GetFrequency (), event->GetTxVector (), aMpdu, signalNoise);
+          m_state->SwitchFromRxEndOk (rxPacket, snrPer.snr, event->GetTxVector ());
         }
       else
         {
           /* failure. */
-          NotifyRxDrop (packet);
-          m_state->SwitchFromRxEndError (packet, snrPer.snr);
+          NotifyRxDrop (rxPacket);
+          m_state->SwitchFromRxEndError (rxPacket, snrPer.snr);
         }
     }
   else
     {
-      m_state->SwitchFromRxEndError (packet, snrPer.snr);
+      m_state->SwitchFromRxEndError (rxPacket, snrPer.snr);
     }
 
   if (preamble == WIFI_PREAMBLE_NONE && mpdutype == LAST_MPDU_IN_AGGREGATE)
@@ -3680,7 +3686,7 @@ WifiPhy::AbortCurrentReception ()
 }
 
 void
-WifiPhy::StartRx (Ptr<Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<InterferenceHelper::Event> event)
+WifiPhy::StartRx (Ptr<const Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<InterferenceHelper::Event> event)
 {
   NS_LOG_FUNCTION (this << packet << txVector << +mpdutype << rxPowerW << rxDuration);
   if (rxPowerW > GetEdThresholdW ()) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
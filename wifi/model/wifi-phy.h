@@ -133,11 +133,15 @@ public:
   /**
    * Starting receiving the plcp of a packet (i.e. the first bit of the preamble has arrived).
    *
+   * The packet, which still carries its WifiPhyTag, may be shared with
+   * the other receivers of the signal: it is copied only at the end of
+   * the reception, before being passed up.
+   *
    * \param packet the arriving packet
    * \param rxPowerW the receive power in W
    * \param rxDuration the duration needed for the reception of the packet
    */
-  void StartReceivePreambleAndHeader (Ptr<Packet> packet,
+  void StartReceivePreambleAndHeader (Ptr<const Packet> packet,
                                       double rxPowerW,
                                       Time rxDuration);
 
@@ -149,7 +153,7 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartReceivePacket (Ptr<Packet> packet,
+  void StartReceivePacket (Ptr<const Packet> packet,
                            WifiTxVector txVector,
                            MpduType mpdutype,
                            Ptr<InterferenceHelper::Event> event);
@@ -162,7 +166,7 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event);
+  void EndReceive (Ptr<const Packet> packet, WifiPreamble preamble, MpduType mpdutype, Ptr<InterferenceHelper::Event> event);
 
   /**
    * \param packet the packet to send
@@ -1689,7 +1693,7 @@ private:
    * \param rxDuration the duration needed for the reception of the packet
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartRx (Ptr<Packet> packet,
+  void StartRx (Ptr<const Packet> packet,
                 WifiTxVector txVector,
                 MpduType mpdutype,
                 double rxPowerW,
@@ -52,9 +52,10 @@ struct WifiSpectrumSignalParameters : public SpectrumSignalParameters
   WifiSpectrumSignalParameters (const WifiSpectrumSignalParameters& p);
 
   /**
-   * The packet being transmitted with this signal
+   * The packet being transmitted with this signal, shared by all the
+   * receivers of the signal
    */
-  Ptr<Packet> packet;
+  Ptr<const Packet> packet;
 };
 
 }  // namespace ns3
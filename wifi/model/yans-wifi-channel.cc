@@ -18,10 +18,15 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "yans-wifi-channel.h"
+#include "ns3/mobility-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "wifi-utils.h"
@@ -47,11 +52,27 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which the PHYs do not receive the transmissions: "
+                   "their propagation loss is not computed and no reception is scheduled. "
+                   "Zero means that all the PHYs receive the transmissions.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinRxPower",
+                   "The received power (dBm), including the receiver gain, below which "
+                   "no reception is scheduled.",
+                   DoubleValue (-std::numeric_limits<double>::max ()),
+                   MakeDoubleAccessor (&YansWifiChannel::m_minRxPower),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0),
+    m_minRxPower (-std::numeric_limits<double>::max ()),
+    m_cellSize (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -62,6 +83,21 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<IndexedPhy>::const_iterator i = m_indexedPhys.begin (); i != m_indexedPhys.end (); i++)
+    {
+      i->mobility->TraceDisconnectWithoutContext ("CourseChange", i->courseChange);
+    }
+  m_indexedPhys.clear ();
+  m_cells.clear ();
+  m_movingPhys.clear ();
+  m_cellSize = 0;
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -82,8 +118,15 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  std::vector<uint32_t> receivers;
+  if (m_maxRange > 0)
+    {
+      GetReceivers (senderMobility->GetPosition (), receivers);
+    }
+  uint32_t nReceivers = (m_maxRange > 0) ? receivers.size () : m_phyList.size ();
+  for (uint32_t j = 0; j < nReceivers; j++)
     {
+      PhyList::const_iterator i = m_phyList.begin () + ((m_maxRange > 0) ? receivers[j] : j);
       if (sender != (*i))
         {
           //For now don't account for inter channel interference nor channel bonding
@@ -97,7 +140,11 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
+          if (rxPowerDbm + (*i)->GetRxGain () < m_minRxPower)
+            {
+              NS_LOG_DEBUG ("reception below " << m_minRxPower << "dBm not scheduled");
+              continue;
+            }
           Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
@@ -111,13 +158,13 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+                                          (*i), packet, rxPowerDbm, duration);
         }
     }
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
   phy->StartReceivePreambleAndHeader (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
@@ -142,6 +189,126 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
   m_phyList.push_back (phy);
 }
 
+void
+YansWifiChannel::GetReceivers (const Vector &position, std::vector<uint32_t> &receivers) const
+{
+  NS_LOG_FUNCTION (this << position);
+  UpdateIndex ();
+  int64_t x = GetCellCoordinate (position.x);
+  int64_t y = GetCellCoordinate (position.y);
+  for (int64_t cellX = x - 1; cellX <= x + 1; cellX++)
+    {
+      for (int64_t cellY = y - 1; cellY <= y + 1; cellY++)
+        {
+          CellMap::const_iterator cell = m_cells.find (GetCellKey (cellX, cellY));
+          if (cell == m_cells.end ())
+            {
+              continue;
+            }
+          for (std::vector<uint32_t>::const_iterator i = cell->second.begin (); i != cell->second.end (); i++)
+            {
+              if (CalculateDistance (m_indexedPhys[*i].position, position) <= m_maxRange)
+                {
+                  receivers.push_back (*i);
+                }
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator i = m_movingPhys.begin (); i != m_movingPhys.end (); i++)
+    {
+      if (CalculateDistance (m_indexedPhys[*i].mobility->GetPosition (), position) <= m_maxRange)
+        {
+          receivers.push_back (*i);
+        }
+    }
+  // Deliver in the order of the PHY list, as without the grid, so that
+  // the simultaneous receptions are scheduled in the same order.
+  std::sort (receivers.begin (), receivers.end ());
+}
+
+void
+YansWifiChannel::UpdateIndex (void) const
+{
+  if (m_cellSize != m_maxRange)
+    {
+      NS_LOG_DEBUG ("build grid of " << m_maxRange << "m cells");
+      m_cells.clear ();
+      m_movingPhys.clear ();
+      m_cellSize = m_maxRange;
+      for (uint32_t i = 0; i < m_indexedPhys.size (); i++)
+        {
+          Insert (i);
+        }
+    }
+  for (uint32_t i = m_indexedPhys.size (); i < m_phyList.size (); i++)
+    {
+      IndexedPhy phy;
+      phy.mobility = m_phyList[i]->GetMobility ();
+      NS_ASSERT_MSG (phy.mobility != 0, "The PHYs of a channel with a MaxRange need a mobility model");
+      phy.courseChange = MakeCallback (&YansWifiChannel::NotifyCourseChange, this).Bind (i);
+      phy.mobility->TraceConnectWithoutContext ("CourseChange", phy.courseChange);
+      m_indexedPhys.push_back (phy);
+      Insert (i);
+    }
+}
+
+void
+YansWifiChannel::Insert (uint32_t index) const
+{
+  IndexedPhy &phy = m_indexedPhys[index];
+  phy.moving = phy.mobility->GetVelocity ().GetLength () != 0;
+  if (phy.moving)
+    {
+      m_movingPhys.push_back (index);
+    }
+  else
+    {
+      phy.position = phy.mobility->GetPosition ();
+      phy.cell = GetCellKey (GetCellCoordinate (phy.position.x), GetCellCoordinate (phy.position.y));
+      m_cells[phy.cell].push_back (index);
+    }
+}
+
+void
+YansWifiChannel::Remove (uint32_t index) const
+{
+  IndexedPhy &phy = m_indexedPhys[index];
+  if (phy.moving)
+    {
+      m_movingPhys.erase (std::find (m_movingPhys.begin (), m_movingPhys.end (), index));
+    }
+  else
+    {
+      CellMap::iterator cell = m_cells.find (phy.cell);
+      NS_ASSERT (cell != m_cells.end ());
+      cell->second.erase (std::find (cell->second.begin (), cell->second.end (), index));
+      if (cell->second.empty ())
+        {
+          m_cells.erase (cell);
+        }
+    }
+}
+
+void
+YansWifiChannel::NotifyCourseChange (uint32_t index, Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << index << mobility);
+  Remove (index);
+  Insert (index);
+}
+
+uint64_t
+YansWifiChannel::GetCellKey (int64_t x, int64_t y)
+{
+  return (static_cast<uint64_t> (x) << 32) ^ (static_cast<uint64_t> (y) & 0xffffffff);
+}
+
+int64_t
+YansWifiChannel::GetCellCoordinate (double coordinate) const
+{
+  return static_cast<int64_t> (std::floor (coordinate / m_cellSize));
+}
+
 int64_t
 YansWifiChannel::AssignStreams (int64_t stream)
 {
@@ -21,12 +21,15 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <unordered_map>
 #include "ns3/channel.h"
+#include "ns3/vector.h"
 #include "yans-wifi-phy.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 
@@ -38,6 +41,19 @@ class PropagationDelayModel;
  * class and supports an ns3::PropagationLossModel and an 
  * ns3::PropagationDelayModel.  By default, no propagation models are set; 
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default, every transmission is delivered to every other PHY on the
+ * same channel number, however weak the received signal. The MaxRange
+ * attribute restricts the delivery to the PHYs within a distance of the
+ * sender: they are found with a grid of the PHY positions, updated when
+ * the mobility models notify a course change, so that the propagation
+ * loss is not even computed for the other PHYs. The MinRxPower attribute
+ * drops the receptions which are too weak to matter. The successful
+ * receptions are unchanged if the power received beyond MaxRange and
+ * MinRxPower are below the reception sensitivity of the PHYs, if these
+ * weak signals, even added together, are negligible compared to the
+ * noise and the CCA threshold, and if the propagation loss model is
+ * deterministic.
  */
 class YansWifiChannel : public Channel
 {
@@ -80,7 +96,8 @@ public:
    * This method should not be invoked by normal users. It is
    * currently invoked only from YansWifiPhy::StartTx.  The channel
    * attempts to deliver the packet to all other YansWifiPhy objects
-   * on the channel (except for the sender).
+   * on the channel (except for the sender). All the receivers share
+   * the packet, which must not be modified after this call.
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
 
@@ -97,11 +114,68 @@ public:
 
 
 private:
+  virtual void DoDispose (void);
+
   /**
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
 
+  /**
+   * The position of a PHY in the grid of receivers.
+   */
+  struct IndexedPhy
+  {
+    Ptr<MobilityModel> mobility;  //!< the mobility model of the PHY
+    Vector position;              //!< the position, for a PHY which does not move
+    bool moving;                  //!< whether the PHY was moving at its last course change
+    uint64_t cell;                //!< the cell of the PHY, if it does not move
+    Callback<void, Ptr<const MobilityModel> > courseChange; //!< the CourseChange trace sink
+  };
+
+  /**
+   * Get the PHYs which are within MaxRange of a position.
+   *
+   * \param position the position of the sender
+   * \param receivers the indexes of the PHYs in the PHY list, in order
+   */
+  void GetReceivers (const Vector &position, std::vector<uint32_t> &receivers) const;
+  /**
+   * Add the PHYs added since the last call to the grid, and rebuild the
+   * grid if MaxRange changed.
+   */
+  void UpdateIndex (void) const;
+  /**
+   * Add a PHY to the grid, at its current position.
+   *
+   * \param index the index of the PHY in the PHY list
+   */
+  void Insert (uint32_t index) const;
+  /**
+   * Remove a PHY from the grid.
+   *
+   * \param index the index of the PHY in the PHY list
+   */
+  void Remove (uint32_t index) const;
+  /**
+   * Move a PHY in the grid when its mobility model changes course.
+   *
+   * \param index the index of the PHY in the PHY list
+   * \param mobility the mobility model of the PHY
+   */
+  void NotifyCourseChange (uint32_t index, Ptr<const MobilityModel> mobility) const;
+  /**
+   * \param x the grid abscissa of a cell
+   * \param y the grid ordinate of a cell
+   * \return the key of the cell in the grid
+   */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+  /**
+   * \param coordinate a coordinate of a position
+   * \return the grid coordinate of the cell of the position
+   */
+  int64_t GetCellCoordinate (double coordinate) const;
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
@@ -112,11 +186,21 @@ private:
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< Range of the transmissions (m), or zero if unlimited
+  double m_minRxPower;                 //!< Minimum power of a reception (dBm)
+
+  /// The grid cells, holding the indexes of the PHYs which do not move
+  typedef std::unordered_map<uint64_t, std::vector<uint32_t> > CellMap;
+
+  mutable std::vector<IndexedPhy> m_indexedPhys; //!< The PHYs tracked by the grid, in PHY list order
+  mutable CellMap m_cells;             //!< The grid of the PHYs which do not move
+  mutable std::vector<uint32_t> m_movingPhys; //!< The PHYs which move, outside of the grid
+  mutable double m_cellSize;           //!< The size of the grid cells (m), or zero if no grid
 };
 
 } //namespace ns3
@@ -42,6 +42,9 @@
 #include "ns3/multi-model-spectrum-channel.h"
 #include "ns3/wifi-spectrum-signal-parameters.h"
 #include "ns3/wifi-phy-tag.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include <limits>
 #include <tuple>
 #include <vector>
 
@@ -1514,6 +1517,371 @@ Bug2831TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countOperationalChannelWidth40, 20, "Incorrect operational channel width after channel change");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Propagation loss model which counts its computations
+ *
+ * The loss is computed by the next model in the chain.
+ */
+class CountingPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  CountingPropagationLossModel ();
+
+  /**
+   * \return the number of losses computed
+   */
+  uint32_t GetCount (void) const;
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  mutable uint32_t m_count; ///< number of losses computed
+};
+
+TypeId
+CountingPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<CountingPropagationLossModel> ()
+  ;
+  return tid;
+}
+
+CountingPropagationLossModel::CountingPropagationLossModel ()
+  : m_count (0)
+{
+}
+
+uint32_t
+CountingPropagationLossModel::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+CountingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                             Ptr<MobilityModel> a,
+                                             Ptr<MobilityModel> b) const
+{
+  m_count++;
+  return txPowerDbm;
+}
+
+int64_t
+CountingPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+/**
+ * Make sure that limiting the range of a YansWifiChannel does not change
+ * the successful receptions when the cutoffs are below the sensitivity.
+ *
+ * Nodes on a line, one of them moving along it and one of them jumping
+ * to it, take turns to broadcast frames, with and without a MaxRange and
+ * a MinRxPower on the channel. The frames received, their times and
+ * their powers must be the same, with fewer propagation losses computed.
+ */
+class YansWifiChannelRangeTest : public TestCase
+{
+public:
+  YansWifiChannelRangeTest ();
+  virtual ~YansWifiChannelRangeTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /// A successful reception: receiving node, time (ns) and signal power (dBm)
+  typedef std::tuple<uint32_t, int64_t, double> Reception;
+
+  /**
+   * Run the scenario, recording the receptions.
+   *
+   * \param maxRange the MaxRange of the channel
+   * \param minRxPower the MinRxPower of the channel
+   * \return the number of losses computed
+   */
+  uint32_t RunScenario (double maxRange, double minRxPower);
+  /**
+   * Record a successful reception.
+   *
+   * \param node the receiving node
+   * \param packet the packet
+   * \param channelFreqMhz the frequency of the channel
+   * \param txVector the TXVECTOR of the reception
+   * \param aMpdu the A-MPDU information
+   * \param signalNoise the signal and noise powers
+   */
+  void NotifyRx (uint32_t node, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                 WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise);
+  /**
+   * Broadcast a frame.
+   *
+   * \param device the sending device
+   */
+  void SendBroadcast (Ptr<NetDevice> device) const;
+
+  std::vector<Reception> m_receptions; ///< the receptions of the current run
+};
+
+YansWifiChannelRangeTest::YansWifiChannelRangeTest ()
+  : TestCase ("Check that the MaxRange and MinRxPower of YansWifiChannel preserve the receptions")
+{
+}
+
+YansWifiChannelRangeTest::~YansWifiChannelRangeTest ()
+{
+}
+
+void
+YansWifiChannelRangeTest::NotifyRx (uint32_t node, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                                    WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise)
+{
+  m_receptions.push_back (std::make_tuple (node, Simulator::Now ().GetNanoSeconds (), signalNoise.signal));
+}
+
+void
+YansWifiChannelRangeTest::SendBroadcast (Ptr<NetDevice> device) const
+{
+  device->Send (Create<Packet> (100), Mac48Address::GetBroadcast (), 1);
+}
+
+uint32_t
+YansWifiChannelRangeTest::RunScenario (double maxRange, double minRxPower)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  m_receptions.clear ();
+
+  // 24 nodes on a line, 100m apart, a node moving along it and a node
+  // which jumps to it.
+  const uint32_t nNodes = 26;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  Ptr<CountingPropagationLossModel> counter = CreateObject<CountingPropagationLossModel> ();
+  counter->SetNext (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationLossModel (counter);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetAttribute ("MinRxPower", DoubleValue (minRxPower));
+
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  // Both runs must draw the same reception errors and backoffs
+  wifi.AssignStreams (devices, 1);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < nNodes - 2; i++)
+    {
+      positionAlloc->Add (Vector (100.0 * i, 0.0, 0.0));
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  for (uint32_t i = 0; i < nNodes - 2; i++)
+    {
+      mobility.Install (nodes.Get (i));
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (3000.0, 10.0, 0.0));
+  moving->SetVelocity (Vector (-1000.0, 0.0, 0.0));
+  nodes.Get (nNodes - 2)->AggregateObject (moving);
+  Ptr<ConstantPositionMobilityModel> jumping = CreateObject<ConstantPositionMobilityModel> ();
+  jumping->SetPosition (Vector (10000.0, 0.0, 0.0));
+  nodes.Get (nNodes - 1)->AggregateObject (jumping);
+  Simulator::Schedule (Seconds (1.5), &ConstantPositionMobilityModel::SetPosition, jumping, Vector (1150.0, 50.0, 0.0));
+
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeCallback (&YansWifiChannelRangeTest::NotifyRx, this).Bind (i));
+    }
+  // The nodes take turns: the frames do not overlap
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      Simulator::Schedule (MilliSeconds (10 * (i + 1)), &YansWifiChannelRangeTest::SendBroadcast, this, devices.Get (i % nNodes));
+    }
+
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return counter->GetCount ();
+}
+
+void
+YansWifiChannelRangeTest::DoRun (void)
+{
+  uint32_t allLosses = RunScenario (0, -std::numeric_limits<double>::max ());
+  std::vector<Reception> allReceptions = m_receptions;
+
+  // With the default 16 dBm and log distance loss, the power received
+  // at 400m is -108.7 dBm, below the -101 dBm sensitivity.
+  uint32_t rangeLosses = RunScenario (400, -105);
+
+  NS_TEST_ASSERT_MSG_EQ (allLosses, 300 * 25, "All the losses should be computed without range");
+  NS_TEST_ASSERT_MSG_LT (rangeLosses, allLosses / 2, "Losses computed beyond the range");
+  NS_TEST_ASSERT_MSG_EQ (m_receptions.size (), allReceptions.size (), "The range changed the number of receptions");
+  bool movingReceived = false;
+  bool jumpingReceived = false;
+  for (uint32_t i = 0; i < allReceptions.size () && i < m_receptions.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (std::get<0> (m_receptions[i]), std::get<0> (allReceptions[i]), "Different receiver for reception " << i);
+      NS_TEST_ASSERT_MSG_EQ (std::get<1> (m_receptions[i]), std::get<1> (allReceptions[i]), "Different time for reception " << i);
+      NS_TEST_ASSERT_MSG_EQ (std::get<2> (m_receptions[i]), std::get<2> (allReceptions[i]), "Different power for reception " << i);
+      if (std::get<0> (m_receptions[i]) == 24)
+        {
+          movingReceived = true;
+        }
+      if (std::get<0> (m_receptions[i]) == 25)
+        {
+          jumpingReceived = true;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (movingReceived, true, "The moving node should receive frames");
+  NS_TEST_ASSERT_MSG_EQ (jumpingReceived, true, "The jumping node should receive frames");
+}
+
+/**
+ * Make sure that the receivers of a signal share the packet until the
+ * end of the reception, and then pass up their own copy of it.
+ */
+class SharedRxPacketTest : public TestCase
+{
+public:
+  SharedRxPacketTest ();
+  virtual ~SharedRxPacketTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record the packet at the start of a reception.
+   *
+   * \param packet the packet
+   */
+  void NotifyRxBegin (Ptr<const Packet> packet);
+  /**
+   * Record the packet at the end of a successful reception.
+   *
+   * \param packet the packet
+   */
+  void NotifyRxEnd (Ptr<const Packet> packet);
+  /**
+   * Broadcast a frame.
+   *
+   * \param device the sending device
+   */
+  void SendBroadcast (Ptr<NetDevice> device) const;
+
+  std::vector<Ptr<const Packet> > m_rxBegin; ///< the packets at the start of the receptions
+  std::vector<Ptr<const Packet> > m_rxEnd;   ///< the packets at the end of the receptions
+};
+
+SharedRxPacketTest::SharedRxPacketTest ()
+  : TestCase ("Check that the receivers of a signal share its packet until they decode it")
+{
+}
+
+SharedRxPacketTest::~SharedRxPacketTest ()
+{
+}
+
+void
+SharedRxPacketTest::NotifyRxBegin (Ptr<const Packet> packet)
+{
+  m_rxBegin.push_back (packet);
+}
+
+void
+SharedRxPacketTest::NotifyRxEnd (Ptr<const Packet> packet)
+{
+  m_rxEnd.push_back (packet);
+}
+
+void
+SharedRxPacketTest::SendBroadcast (Ptr<NetDevice> device) const
+{
+  device->Send (Create<Packet> (100), Mac48Address::GetBroadcast (), 1);
+}
+
+void
+SharedRxPacketTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (5.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (0.0, 5.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&SharedRxPacketTest::NotifyRxBegin, this));
+      wifiPhy->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&SharedRxPacketTest::NotifyRxEnd, this));
+    }
+  Simulator::Schedule (Seconds (1.0), &SharedRxPacketTest::SendBroadcast, this, devices.Get (0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.size (), 2, "Both nodes should start receiving the frame");
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd.size (), 2, "Both nodes should receive the frame");
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin[0], m_rxBegin[1], "The receivers should share the packet of the signal");
+  NS_TEST_ASSERT_MSG_NE (m_rxEnd[0], m_rxEnd[1], "The receivers should pass up their own copy");
+  NS_TEST_ASSERT_MSG_NE (m_rxEnd[0], m_rxBegin[0], "The packet passed up should be a copy");
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd[0]->GetUid (), m_rxBegin[0]->GetUid (), "The copy should be the same packet");
+  WifiPhyTag tag;
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin[0]->PeekPacketTag (tag), true, "The shared packet should keep its WifiPhyTag");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxEnd[i]->PeekPacketTag (tag), false, "The copy passed up should have no WifiPhyTag");
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1538,6 +1906,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
+  AddTestCase (new YansWifiChannelRangeTest, TestCase::QUICK);
+  AddTestCase (new SharedRxPacketTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite